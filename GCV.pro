@@ -2,11 +2,13 @@ TEMPLATE = app
 TARGET = GrblController
 
 DEFINES = QT_NO_DEBUG
+# no per status report logging in release builds (see 'TRACE' in definitions.h)
+CONFIG(release, debug|release): DEFINES += GC_NO_TRACE_LOG
 
 QT   += core gui printsupport widgets serialport
 
 # QGlViewer
-QT += xml opengl
+QT += xml opengl network concurrent
 INCLUDEPATH += QGLViewer QGLWidget
 # srichy  November 17, 2014
 unix {
@@ -23,6 +25,13 @@ else {
     LIBS += -lQGlViewer2
 }
 
+# compressed G-code : '.gz' with zlib, '.zst' with libzstd unless CONFIG+=no_zstd
+LIBS += -lz
+!CONFIG(no_zstd) {
+    DEFINES += GC_WITH_ZSTD
+    LIBS += -lzstd
+}
+
 
 
 # Translations
@@ -48,6 +57,33 @@ SOURCES += main.cpp\
     arcitem.cpp \
     pointitem.cpp \
     controlparams.cpp \
+    telemetry.cpp \
+    statuslog.cpp \
+    linelistview.cpp \
+    lineindex.cpp \
+    gcodelisting.cpp \
+    modaltimeline.cpp \
+    jobjournal.cpp \
+    machinemanager.cpp \
+    machinedashboard.cpp \
+    headless.cpp \
+    automationserver.cpp \
+    programanalyzer.cpp \
+    jobqueue.cpp \
+    pathoptimizer.cpp \
+    blockcompactor.cpp \
+    traveloptimizer.cpp \
+    asyncfileappender.cpp \
+    stocksimulator.cpp \
+    motiontimeline.cpp \
+    segmentindex.cpp \
+    toolpathstore.cpp \
+    parsecache.cpp \
+    compressedfile.cpp \
+    streamsource.cpp \
+    framescheduler.cpp \
+    joblibrary.cpp \
+    joblibrarydialog.cpp \
     visu3D/viewer3D.cpp \
     visu3D/Point3D.cpp \
     visu3D/Line3D.cpp \
@@ -75,6 +111,33 @@ HEADERS  += mainwindow.h \
     pointitem.h \
     termiosext.h \
     controlparams.h \
+    telemetry.h \
+    statuslog.h \
+    linelistview.h \
+    lineindex.h \
+    gcodelisting.h \
+    modaltimeline.h \
+    jobjournal.h \
+    machinemanager.h \
+    machinedashboard.h \
+    headless.h \
+    automationserver.h \
+    programanalyzer.h \
+    jobqueue.h \
+    pathoptimizer.h \
+    blockcompactor.h \
+    traveloptimizer.h \
+    asyncfileappender.h \
+    stocksimulator.h \
+    motiontimeline.h \
+    segmentindex.h \
+    toolpathstore.h \
+    parsecache.h \
+    compressedfile.h \
+    streamsource.h \
+    framescheduler.h \
+    joblibrary.h \
+    joblibrarydialog.h \
     version.h \
     visu3D/viewer3D.h \
     visu3D/Point3D.h \
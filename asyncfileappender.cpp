@@ -0,0 +1,254 @@
+/****************************************************************
+ * asyncfileappender.cpp
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#include "asyncfileappender.h"
+
+#include <csignal>
+#ifdef Q_OS_WIN
+#include <io.h>
+#define crashWrite _write
+#else
+#include <unistd.h>
+#define crashWrite ::write
+#endif
+
+#include "log4qt/layout.h"
+#include "log4qt/loggingevent.h"
+#include "definitions.h"
+
+// batches written by the writer thread
+#define ASYNC_LOG_BATCH     (256 << 10)
+
+QAtomicPointer<AsyncFileAppender> AsyncFileAppender::crashTarget;
+
+AsyncLogWriter::AsyncLogWriter(AsyncFileAppender *appender)
+    : owner(appender), stopping(0)
+{
+}
+
+// calls : 'AsyncFileAppender::close()':1
+void AsyncLogWriter::stop()
+{
+    stopping.storeRelease(1);
+    wait();
+    stopping.storeRelease(0);
+}
+
+// polled, the producers never wake the thread up
+void AsyncLogWriter::run()
+{
+    while (!stopping.loadAcquire())
+    {
+        owner->drain();
+        msleep(ASYNC_LOG_FLUSH_MSEC);
+    }
+    owner->drain();
+}
+
+///-----------------------------------------------------------------------------
+AsyncFileAppender::AsyncFileAppender(QObject *parent)
+    : Log4Qt::AppenderSkeleton(false, parent),
+      appendToFile(false), writer(this), maxPending(ASYNC_LOG_MAX_PENDING)
+{
+    Node *stub = new Node;
+    head.storeRelease(stub);
+    tail = stub;
+}
+
+AsyncFileAppender::~AsyncFileAppender()
+{
+    close();
+    delete tail;
+}
+
+QString AsyncFileAppender::file() const
+{
+    QMutexLocker locker(&mObjectGuard);
+    return fileName;
+}
+
+void AsyncFileAppender::setFile(const QString& name)
+{
+    QMutexLocker locker(&mObjectGuard);
+    fileName = name;
+}
+
+bool AsyncFileAppender::appendFile() const
+{
+    QMutexLocker locker(&mObjectGuard);
+    return appendToFile;
+}
+
+void AsyncFileAppender::setAppendFile(bool value)
+{
+    QMutexLocker locker(&mObjectGuard);
+    appendToFile = value;
+}
+
+void AsyncFileAppender::setMaxPending(int bytes)
+{
+    maxPending = bytes;
+}
+
+int AsyncFileAppender::droppedCount() const
+{
+    return dropped.loadAcquire();
+}
+
+bool AsyncFileAppender::requiresLayout() const
+{
+    return true;
+}
+
+// calls : 'MainWindow::readSettings()':1, 'runHeadless()':1, 'StatusLogModel::spill()':1
+void AsyncFileAppender::activateOptions()
+{
+    QMutexLocker locker(&mObjectGuard);
+
+    if (writer.isRunning())
+        return;
+    if (fileName.isEmpty())
+    {
+        err("No file set for the appender '%s'", qPrintable(name()));
+        return;
+    }
+
+    // unbuffered : what 'write()' returned from is in the file, text : CRLF
+    // on Windows as the Log4Qt appender wrote it
+    out.setFileName(fileName);
+    QIODevice::OpenMode mode = QIODevice::WriteOnly | QIODevice::Text | QIODevice::Unbuffered;
+    mode |= appendToFile ? QIODevice::Append : QIODevice::Truncate;
+    if (!out.open(mode))
+    {
+        err("Can't open log file '%s' : %s", qPrintable(fileName), qPrintable(out.errorString()));
+        return;
+    }
+
+    writer.start(QThread::LowPriority);
+    AppenderSkeleton::activateOptions();
+
+    // the first appender opened keeps the crash flush : the debug log,
+    // opened at the start
+    if (crashTarget.testAndSetOrdered(0, this))
+    {
+        signal(SIGSEGV, crashHandler);
+        signal(SIGABRT, crashHandler);
+        signal(SIGFPE, crashHandler);
+        signal(SIGILL, crashHandler);
+    }
+}
+
+// calls : 'main()':2
+void AsyncFileAppender::close()
+{
+    QMutexLocker locker(&mObjectGuard);
+
+    if (isClosed())
+        return;
+    AppenderSkeleton::close();
+
+    crashTarget.testAndSetOrdered(this, 0);
+    if (writer.isRunning())
+        writer.stop();
+    if (out.isOpen())
+        out.close();
+}
+
+// Runs under the appender mutex of 'doAppend()', which nothing else
+// holds for long : no file access here.
+void AsyncFileAppender::append(const Log4Qt::LoggingEvent& event)
+{
+    appendText(layout()->format(event).toUtf8());
+}
+
+// calls : 'AsyncFileAppender::append()':1, 'StatusLogModel::spill()':1
+void AsyncFileAppender::appendText(const QByteArray& text)
+{
+    if (pending.loadAcquire() + text.size() > maxPending)
+    {
+        dropped.ref();
+        return;
+    }
+    pending.fetchAndAddOrdered(text.size());
+
+    Node *node = new Node;
+    node->text = text;
+    push(node);
+}
+
+// any thread, wait free
+void AsyncFileAppender::push(Node *node)
+{
+    Node *previous = head.fetchAndStoreOrdered(node);
+    // until this store the writer sees the queue end at 'previous'
+    previous->next.storeRelease(node);
+}
+
+// calls : 'AsyncLogWriter::run()'
+void AsyncFileAppender::drain()
+{
+    if (!consuming.testAndSetAcquire(0, 1))
+        return;
+
+    QByteArray batch;
+    int lost = dropped.fetchAndStoreOrdered(0);
+    if (lost > 0)
+        batch = QString("*** %1 log events dropped ***\n").arg(lost).toUtf8();
+
+    Node *next;
+    while ((next = tail->next.loadAcquire()) != 0)
+    {
+        batch.append(next->text);
+        pending.fetchAndAddOrdered(-next->text.size());
+        next->text.clear();
+        delete tail;
+        tail = next;
+
+        if (batch.size() >= ASYNC_LOG_BATCH)
+        {
+            out.write(batch);
+            batch.clear();
+        }
+    }
+    if (!batch.isEmpty())
+        out.write(batch);
+
+    consuming.storeRelease(0);
+}
+
+// Walks the queue with the write system call only. The writer thread
+// may be in the middle of a batch : it is given a moment to finish.
+// calls : 'AsyncFileAppender::crashHandler()':1
+void AsyncFileAppender::flushOnCrash()
+{
+    AsyncFileAppender *target = crashTarget.loadAcquire();
+    if (target == 0)
+        return;
+
+    for (int spin = 0; !target->consuming.testAndSetAcquire(0, 1); spin++)
+    {
+        if (spin > 10000000)
+            return;
+    }
+
+    int fd = target->out.handle();
+    if (fd >= 0)
+    {
+        for (Node *node = target->tail->next.loadAcquire(); node != 0; node = node->next.loadAcquire())
+            crashWrite(fd, node->text.constData(), node->text.size());
+    }
+    // the writer stays locked out, the process is going down
+}
+
+void AsyncFileAppender::crashHandler(int sig)
+{
+    flushOnCrash();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
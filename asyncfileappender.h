@@ -0,0 +1,114 @@
+/****************************************************************
+ * asyncfileappender.h
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#ifndef ASYNCFILEAPPENDER_H
+#define ASYNCFILEAPPENDER_H
+
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QByteArray>
+#include <QFile>
+#include <QThread>
+
+#include "log4qt/appenderskeleton.h"
+
+// period of the writer thread
+#define ASYNC_LOG_FLUSH_MSEC        50
+// rendered text waiting for the disk, events beyond are dropped
+#define ASYNC_LOG_MAX_PENDING       (8 << 20)
+
+class AsyncFileAppender;
+
+class AsyncLogWriter : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit AsyncLogWriter(AsyncFileAppender *appender);
+    void stop();
+
+protected:
+    void run();
+
+private:
+    AsyncFileAppender *owner;
+    QAtomicInt stopping;
+};
+
+// File appender for the serial hot path : the calling thread only
+// formats the event and links it to a lock-free queue, a writer thread
+// drains the queue to the file in large batches. When the queue holds
+// more than 'maxPending' bytes new events are counted and dropped so
+// that a slow disk never blocks the caller. On SIGSEGV, SIGABRT, SIGFPE
+// and SIGILL what is still queued is written before the process dies.
+class AsyncFileAppender : public Log4Qt::AppenderSkeleton
+{
+    Q_OBJECT
+
+public:
+    explicit AsyncFileAppender(QObject *parent = 0);
+    ~AsyncFileAppender();
+
+    QString file() const;
+    void setFile(const QString& fileName);
+    // false, as 'Log4Qt::FileAppender' : the file is emptied when opened
+    bool appendFile() const;
+    void setAppendFile(bool append);
+    void setMaxPending(int bytes);
+    int droppedCount() const;
+    // text already formatted, for a file that no logger writes : any
+    // thread, queued as the events of 'append()'
+    void appendText(const QByteArray& text);
+
+    bool requiresLayout() const;
+    void activateOptions();
+    void close();
+
+    // signal handler side, writes the queue without allocating
+    static void flushOnCrash();
+
+protected:
+    void append(const Log4Qt::LoggingEvent& event);
+
+private:
+    friend class AsyncLogWriter;
+
+    // a queued event, the last one consumed serves as the queue stub
+    class Node
+    {
+    public:
+        Node() : next(0) {}
+    public:
+        QAtomicPointer<Node> next;
+        QByteArray text;
+    };
+
+    void push(Node *node);
+    // writer thread
+    void drain();
+    static void crashHandler(int sig);
+
+private:
+    QString fileName;
+    bool appendToFile;
+    QFile out;
+    AsyncLogWriter writer;
+    // producers swap the head, the writer owns the tail
+    QAtomicPointer<Node> head;
+    Node *tail;
+    QAtomicInt pending;
+    QAtomicInt dropped;
+    int maxPending;
+    // held by whoever reads the queue : the writer or a crash
+    QAtomicInt consuming;
+
+    static QAtomicPointer<AsyncFileAppender> crashTarget;
+};
+
+#endif // ASYNCFILEAPPENDER_H
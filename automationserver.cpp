@@ -0,0 +1,273 @@
+/****************************************************************
+ * automationserver.cpp
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#include "automationserver.h"
+
+#include <QDataStream>
+#include <QSettings>
+
+#include "definitions.h"
+
+AutomationServer::AutomationServer(const Telemetry& t, AutomationTarget *tg, QObject *parent)
+    : QObject(parent), telemetry(t), target(tg)
+{
+    connect(&server, SIGNAL(newConnection()), this, SLOT(newConnection()));
+    connect(&pushTimer, SIGNAL(timeout()), this, SLOT(pushTelemetry()));
+}
+
+AutomationServer::~AutomationServer()
+{
+    server.close();
+}
+
+bool AutomationServer::listen(const QString& name)
+{
+    // only the current user may connect
+    server.setSocketOptions(QLocalServer::UserAccessOption);
+    // another instance serves the clients, its socket is left alone
+    QLocalSocket probe;
+    probe.connectToServer(name);
+    if (probe.waitForConnected(AUTOMATION_PROBE_MSEC))
+    {
+        probe.disconnectFromServer();
+        warn(qPrintable(tr("Automation server '%s' is already used by another instance, not listening")),
+             qPrintable(name));
+        return false;
+    }
+    // no one answers : a socket left by a crash would make 'listen()' fail
+    QLocalServer::removeServer(name);
+    if (!server.listen(name))
+    {
+        warn(qPrintable(tr("Automation server can't listen on '%s' : %s")),
+             qPrintable(name), qPrintable(server.errorString()));
+        return false;
+    }
+    info(qPrintable(tr("Automation server listening on '%s'")), qPrintable(server.fullServerName()));
+    return true;
+}
+
+void AutomationServer::newConnection()
+{
+    while (server.hasPendingConnections())
+    {
+        QLocalSocket *socket = server.nextPendingConnection();
+        clients.insert(socket, Client());
+        connect(socket, SIGNAL(readyRead()), this, SLOT(readClient()));
+        connect(socket, SIGNAL(disconnected()), this, SLOT(removeClient()));
+    }
+}
+
+void AutomationServer::removeClient()
+{
+    QLocalSocket *socket = qobject_cast<QLocalSocket *>(sender());
+    if (socket == NULL)
+        return;
+
+    clients.remove(socket);
+    socket->deleteLater();
+    updatePushTimer();
+}
+
+void AutomationServer::readClient()
+{
+    QLocalSocket *socket = qobject_cast<QLocalSocket *>(sender());
+    if (socket == NULL || !clients.contains(socket))
+        return;
+
+    QByteArray& buffer = clients[socket].buffer;
+    buffer.append(socket->readAll());
+
+    while (buffer.size() >= 4)
+    {
+        quint32 size;
+        {
+            QDataStream head(buffer);
+            head >> size;
+        }
+        if (size > AUTOMATION_MAX_FRAME)
+        {
+            warn(qPrintable(tr("Automation client sent a frame of %u bytes, disconnected")), size);
+            buffer.clear();
+            socket->abort();
+            return;
+        }
+        if ((quint32)buffer.size() < 4 + size)
+            break;
+
+        QByteArray frame = buffer.mid(4, size);
+        buffer.remove(0, 4 + size);
+
+        QDataStream in(frame);
+        in.setVersion(QDataStream::Qt_5_0);
+        quint16 type;
+        quint32 id;
+        QVariantMap data;
+        in >> type >> id >> data;
+        if (in.status() != QDataStream::Ok)
+        {
+            reply(socket, id, false, tr("Malformed frame"));
+            continue;
+        }
+        handle(socket, type, id, data);
+    }
+}
+
+void AutomationServer::handle(QLocalSocket *socket, quint16 type, quint32 id, const QVariantMap& data)
+{
+    QString error;
+    switch (type)
+    {
+    case AUTO_SUBMIT:
+        reply(socket, id, target->automationSubmit(data.value("file").toString(), error), error);
+        break;
+    case AUTO_START:
+        reply(socket, id, target->automationStart(data.value("line", 1).toInt(), error), error);
+        break;
+    case AUTO_PAUSE:
+        reply(socket, id, target->automationPause(data.value("pause", true).toBool(), error), error);
+        break;
+    case AUTO_ABORT:
+        reply(socket, id, target->automationAbort(error), error);
+        break;
+    case AUTO_STATUS:
+    {
+        TelemetrySnapshot snap;
+        telemetry.read(snap);
+        reply(socket, id, true, QString(), telemetryValues(snap));
+        break;
+    }
+    case AUTO_SUBSCRIBE:
+    {
+        Client& client = clients[socket];
+        client.interval = qMax(0, data.value("interval", TELEMETRY_REFRESH_MSEC).toInt());
+        client.lastSequence = -1;
+        client.lastPush.start();
+        updatePushTimer();
+        reply(socket, id, true, QString());
+        break;
+    }
+    case AUTO_GET_SETTING:
+    {
+        QSettings settings;
+        QString key = data.value("key").toString();
+        QVariantMap result;
+        result.insert("key", key);
+        result.insert("value", settings.value(key));
+        reply(socket, id, settings.contains(key), settings.contains(key) ? QString() : tr("Unknown key"), result);
+        break;
+    }
+    case AUTO_SET_SETTING:
+    {
+        QString key = data.value("key").toString();
+        if (key.isEmpty())
+        {
+            reply(socket, id, false, tr("No key"));
+            break;
+        }
+        {
+            QSettings settings;
+            settings.setValue(key, data.value("value"));
+        }
+        // same path as the 'Options' dialog
+        target->automationSettingsChanged();
+        reply(socket, id, true, QString());
+        break;
+    }
+    default:
+        reply(socket, id, false, tr("Unknown request %1").arg(type));
+        break;
+    }
+}
+
+void AutomationServer::send(QLocalSocket *socket, quint16 type, quint32 id, const QVariantMap& data)
+{
+    QByteArray frame;
+    QDataStream out(&frame, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << (quint32)0 << type << id << data;
+    out.device()->seek(0);
+    out << (quint32)(frame.size() - 4);
+
+    socket->write(frame);
+}
+
+void AutomationServer::reply(QLocalSocket *socket, quint32 id, bool ok, const QString& error,
+                             QVariantMap result)
+{
+    result.insert("ok", ok);
+    if (!ok)
+        result.insert("error", error);
+    send(socket, AUTO_REPLY, id, result);
+}
+
+QVariantMap AutomationServer::telemetryValues(const TelemetrySnapshot& snap)
+{
+    QVariantMap values = target->automationState();
+    values.insert("sequence", snap.sequence);
+    values.insert("running", snap.running);
+    values.insert("line", snap.currLine);
+    values.insert("totalLines", snap.totalLines);
+    values.insert("progress", snap.progress);
+    values.insert("queued", snap.queuedCommands);
+    values.insert("mm", snap.useMm);
+    values.insert("positionValid", snap.positionValid);
+
+    QVariantList machine, work;
+    machine << snap.machineCoord.x << snap.machineCoord.y << snap.machineCoord.z << snap.machineCoord.fourth;
+    work << snap.workCoord.x << snap.workCoord.y << snap.workCoord.z << snap.workCoord.fourth;
+    values.insert("machine", machine);
+    values.insert("work", work);
+    return values;
+}
+
+// the timer only runs while someone is subscribed
+void AutomationServer::updatePushTimer()
+{
+    bool any = false;
+    foreach (const Client& client, clients)
+    {
+        if (client.interval > 0)
+        {
+            any = true;
+            break;
+        }
+    }
+
+    if (any && !pushTimer.isActive())
+        pushTimer.start(TELEMETRY_REFRESH_MSEC);
+    else if (!any)
+        pushTimer.stop();
+}
+
+// calls : 'pushTimer::timeout()'
+void AutomationServer::pushTelemetry()
+{
+    int sequence = telemetry.sequence();
+
+    TelemetrySnapshot snap;
+    bool read = false;
+    QHash<QLocalSocket *, Client>::iterator it;
+    for (it = clients.begin(); it != clients.end(); ++it)
+    {
+        Client& client = it.value();
+        if (client.interval <= 0 || client.lastSequence == sequence
+                || client.lastPush.elapsed() < client.interval)
+            continue;
+
+        // one snapshot for all subscribers
+        if (!read)
+        {
+            telemetry.read(snap);
+            read = true;
+        }
+        client.lastSequence = snap.sequence;
+        client.lastPush.restart();
+        send(it.key(), AUTO_TELEMETRY, 0, telemetryValues(snap));
+    }
+}
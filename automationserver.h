@@ -0,0 +1,107 @@
+/****************************************************************
+ * automationserver.h
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#ifndef AUTOMATIONSERVER_H
+#define AUTOMATIONSERVER_H
+
+#include <QObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QVariantMap>
+#include <QTimer>
+#include <QHash>
+#include <QTime>
+
+#include "telemetry.h"
+
+// name of the local socket (a Unix domain socket or a Windows named pipe)
+#define AUTOMATION_SERVER_NAME      "GrblController"
+#define AUTOMATION_MAX_FRAME        (1 << 20)
+// wait for a running instance to answer on the socket
+#define AUTOMATION_PROBE_MSEC       500
+
+// Frame : quint32 size (big endian) then 'size' bytes written by QDataStream
+// (Qt_5_0) : quint16 type, quint32 id, QVariantMap data.
+// A request is answered by one AUTO_REPLY with the same id,
+// AUTO_TELEMETRY frames are pushed with id 0.
+enum AutomationMessage
+{
+    AUTO_REPLY = 0,         // "ok" bool, "error" string, results
+    AUTO_SUBMIT,            // "file" : load a job
+    AUTO_START,             // "line" : optional first line
+    AUTO_PAUSE,             // "pause" bool
+    AUTO_ABORT,
+    AUTO_STATUS,            // reply : same values as AUTO_TELEMETRY
+    AUTO_SUBSCRIBE,         // "interval" msec between pushes, 0 : stop
+    AUTO_TELEMETRY,         // pushed when the telemetry changes
+    AUTO_GET_SETTING,       // "key"
+    AUTO_SET_SETTING        // "key", "value"
+};
+
+// What the server asks of the application, implemented by 'MainWindow'
+class AutomationTarget
+{
+public:
+    virtual ~AutomationTarget() {}
+
+    virtual bool automationSubmit(const QString& file, QString& error) = 0;
+    virtual bool automationStart(int line, QString& error) = 0;
+    virtual bool automationPause(bool pause, QString& error) = 0;
+    virtual bool automationAbort(QString& error) = 0;
+    virtual void automationSettingsChanged() = 0;
+    // port, file ... added to the telemetry values
+    virtual QVariantMap automationState() = 0;
+};
+
+// Local control channel for job scheduling systems. Telemetry is pushed
+// to subscribers when its sequence changes, checked once per frame.
+class AutomationServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    AutomationServer(const Telemetry& telemetry, AutomationTarget *target, QObject *parent = 0);
+    ~AutomationServer();
+
+    bool listen(const QString& name = AUTOMATION_SERVER_NAME);
+
+private slots:
+    void newConnection();
+    void readClient();
+    void removeClient();
+    void pushTelemetry();
+
+private:
+    class Client
+    {
+    public:
+        Client() : interval(0), lastSequence(-1) {}
+    public:
+        QByteArray buffer;
+        int interval;
+        int lastSequence;
+        QTime lastPush;
+    };
+
+    void handle(QLocalSocket *socket, quint16 type, quint32 id, const QVariantMap& data);
+    void send(QLocalSocket *socket, quint16 type, quint32 id, const QVariantMap& data);
+    void reply(QLocalSocket *socket, quint32 id, bool ok, const QString& error,
+               QVariantMap result = QVariantMap());
+    QVariantMap telemetryValues(const TelemetrySnapshot& snap);
+    void updatePushTimer();
+
+private:
+    const Telemetry& telemetry;
+    AutomationTarget *target;
+    QLocalServer server;
+    QHash<QLocalSocket *, Client> clients;
+    QTimer pushTimer;
+};
+
+#endif // AUTOMATIONSERVER_H
@@ -0,0 +1,242 @@
+/****************************************************************
+ * blockcompactor.cpp
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#include "blockcompactor.h"
+
+#include <qmath.h>
+
+// G codes times 10, so that G38.2 is 382
+#define GC(v)           qRound((v) * 10)
+
+BlockCompactor::BlockCompactor()
+    : decimals(DEFAULT_COMPACT_DECIMALS), inCount(0), outCount(0)
+{
+    reset();
+}
+
+void BlockCompactor::setDecimals(int d)
+{
+    decimals = qBound(1, d, 6);
+}
+
+// calls : 'GCode::sendFileFrom()':2
+void BlockCompactor::reset()
+{
+    motion = plane = units = distance = feedMode = -1;
+    feed = speed = -1;
+    forgetAxes();
+}
+
+void BlockCompactor::clearCounts()
+{
+    inCount = outCount = 0;
+}
+
+void BlockCompactor::forgetAxes()
+{
+    axes.clear();
+}
+
+qint64 BlockCompactor::bytesIn() const
+{
+    return inCount;
+}
+
+qint64 BlockCompactor::bytesOut() const
+{
+    return outCount;
+}
+
+QStringList BlockCompactor::compact(const QStringList& lines)
+{
+    QStringList result;
+    foreach (const QString& line, lines)
+    {
+        QString block = compact(line);
+        if (!block.isEmpty())
+            result.append(block);
+    }
+    return result;
+}
+
+QString BlockCompactor::compact(const QString& line)
+{
+    inCount += line.trimmed().size() + 1;
+
+    QList<Word> words;
+    if (!split(line, words))
+    {
+        // '$' commands and anything else : sent as is, state unknown after
+        QString block = line.trimmed();
+        reset();
+        outCount += block.size() + 1;
+        return block;
+    }
+
+    // 1 - modal groups set by the block
+    int newMotion = motion, newPlane = plane, newUnits = units;
+    int newDistance = distance, newFeedMode = feedMode;
+    // moves to places not written in the block, or offsets changed
+    bool special = false;
+    bool programEnd = false;
+    foreach (const Word& w, words)
+    {
+        if (w.letter == 'G')
+        {
+            int code = GC(w.value);
+            if (code == 0 || code == 10 || code == 20 || code == 30 || code == 800)
+                newMotion = code;
+            else if (code >= 382 && code <= 385)
+            {
+                newMotion = code;
+                special = true;
+            }
+            else if (code == 170 || code == 180 || code == 190)
+                newPlane = code;
+            else if (code == 200 || code == 210)
+                newUnits = code;
+            else if (code == 900 || code == 910)
+                newDistance = code;
+            else if (code == 930 || code == 940)
+                newFeedMode = code;
+            else if (code != 40 && code != 400 && code != 610 && code != 640)
+                special = true;
+        }
+        else if (w.letter == 'M' && (GC(w.value) == 20 || GC(w.value) == 300))
+            programEnd = true;
+    }
+
+    if (newUnits != units || newDistance != 900)
+        forgetAxes();
+    int places = newUnits == 210 ? decimals : decimals + 1;
+
+    // 2 - words written, in the order of the block
+    QString block;
+    foreach (const Word& w, words)
+    {
+        QString text = w.letter == 'G' || w.letter == 'M' || w.letter == 'T' || w.letter == 'L'
+                ? number(w.value, 1) : number(w.value, places);
+        bool drop = false;
+
+        switch (w.letter)
+        {
+        case 'N':
+            drop = true;
+            break;
+        case 'G':
+        {
+            int code = GC(w.value);
+            drop = (code == newMotion && code == motion && code <= 30)
+                    || (code == newPlane && code == plane)
+                    || (code == newUnits && code == units)
+                    || (code == newDistance && code == distance)
+                    || (code == newFeedMode && code == feedMode);
+            break;
+        }
+        case 'F':
+            // inverse time needs F on every block
+            drop = newFeedMode == 940 && feed >= 0 && number(feed, places) == text;
+            feed = text.toDouble();
+            break;
+        case 'S':
+            drop = speed >= 0 && number(speed, places) == text;
+            speed = text.toDouble();
+            break;
+        case 'X': case 'Y': case 'Z':
+        case 'A': case 'B': case 'C':
+        case 'U': case 'V': case 'W':
+            if (newDistance == 900 && !special)
+            {
+                // an arc must keep its end point
+                drop = (newMotion == 0 || newMotion == 10) && axes.value(w.letter) == text;
+                axes.insert(w.letter, text);
+            }
+            break;
+        default:
+            break;
+        }
+
+        if (!drop)
+            block.append(QChar(w.letter)).append(text);
+    }
+
+    motion = newMotion;
+    plane = newPlane;
+    units = newUnits;
+    distance = newDistance;
+    feedMode = newFeedMode;
+    if (special)
+        forgetAxes();
+    if (programEnd)
+        reset();
+
+    outCount += block.isEmpty() ? 0 : block.size() + 1;
+    return block;
+}
+
+// letters and numbers only, once comments and blanks are gone
+bool BlockCompactor::split(const QString& line, QList<Word>& words) const
+{
+    QString text = line.toUpper();
+    int pos = text.indexOf(';');
+    if (pos >= 0)
+        text = text.left(pos);
+    int open;
+    while ((open = text.indexOf('(')) >= 0)
+    {
+        int close = text.indexOf(')', open);
+        text.remove(open, close < 0 ? text.size() - open : close - open + 1);
+    }
+    text.remove(' ');
+    text.remove('\t');
+    text.remove('%');
+
+    int i = 0;
+    while (i < text.size())
+    {
+        Word w;
+        QChar c = text.at(i);
+        if (c < 'A' || c > 'Z')
+            return false;
+        w.letter = c.toLatin1();
+
+        int start = ++i;
+        if (i < text.size() && (text.at(i) == '+' || text.at(i) == '-'))
+            i++;
+        while (i < text.size() && (text.at(i).isDigit() || text.at(i) == '.'))
+            i++;
+
+        bool ok;
+        w.value = text.mid(start, i - start).toDouble(&ok);
+        if (!ok)
+            return false;
+        words.append(w);
+    }
+    return true;
+}
+
+// '0.500' -> '.5', '-0.5' -> '-.5', '10.0' -> '10'
+QString BlockCompactor::number(double value, int places) const
+{
+    QString s = QString::number(value, 'f', places);
+    if (s.contains('.'))
+    {
+        while (s.endsWith('0'))
+            s.chop(1);
+        if (s.endsWith('.'))
+            s.chop(1);
+    }
+    if (s.startsWith("0."))
+        s.remove(0, 1);
+    else if (s.startsWith("-0."))
+        s.remove(1, 1);
+    if (s == "-0")
+        s = "0";
+    return s;
+}
@@ -0,0 +1,74 @@
+/****************************************************************
+ * blockcompactor.h
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#ifndef BLOCKCOMPACTOR_H
+#define BLOCKCOMPACTOR_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+
+#include "definitions.h"
+
+// Shortest text of each block streamed to Grbl : no spaces, comments
+// or line numbers, numbers without useless zeros, and no word that
+// repeats the modal state left by the blocks already sent (motion,
+// plane, units, distance and feed modes, F, S, unchanged coordinates).
+// Every block sent must go through 'compact()' so that the tracked
+// state is the one of the controller; 'reset()' when it is unknown.
+class BlockCompactor
+{
+public:
+    BlockCompactor();
+
+    // decimals kept in mm, one more in inches
+    void setDecimals(int decimals);
+    void reset();
+
+    // empty when the block has no effect
+    QString compact(const QString& line);
+    QStringList compact(const QStringList& lines);
+
+    // bytes with line feeds, before and after
+    qint64 bytesIn() const;
+    qint64 bytesOut() const;
+    void clearCounts();
+
+private:
+    class Word
+    {
+    public:
+        Word() : letter(0), value(0) {}
+    public:
+        char letter;
+        double value;
+    };
+
+    bool split(const QString& line, QList<Word>& words) const;
+    QString number(double value, int decimals) const;
+    void forgetAxes();
+
+private:
+    int decimals;
+    qint64 inCount;
+    qint64 outCount;
+
+    // modal state, -1 : unknown
+    int motion;
+    int plane;
+    int units;
+    int distance;
+    int feedMode;
+    double feed;
+    double speed;
+    // last value written for each axis in absolute mode
+    QHash<char, QString> axes;
+};
+
+#endif // BLOCKCOMPACTOR_H
@@ -0,0 +1,332 @@
+/****************************************************************
+ * compressedfile.cpp
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#include "compressedfile.h"
+
+#include <cstring>
+#include <QFile>
+#include <QMutexLocker>
+
+#include <zlib.h>
+#ifdef GC_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+CompressedFile::Format CompressedFile::format(const QString& path)
+{
+    QString suffix = path.section('.', -1).toLower();
+    if (suffix == "gz" || suffix == "gzip")
+        return Gzip;
+    if (suffix == "zst" || suffix == "zstd")
+        return Zstd;
+    return Plain;
+}
+
+bool CompressedFile::isCompressed(const QString& path)
+{
+    return format(path) != Plain;
+}
+
+QString CompressedFile::plainPath(const QString& path)
+{
+    if (!isCompressed(path))
+        return path;
+    return path.left(path.lastIndexOf('.'));
+}
+
+// calls : 'GCode::sendFileFrom()', 'PathOptimizer::optimize()', 'TravelOptimizer::optimize()'
+QIODevice *CompressedFile::openRead(const QString& path, QString *error)
+{
+    Format kind = format(path);
+    QIODevice *device;
+    if (kind == Plain)
+        device = new QFile(path);
+    else
+        device = new CompressedFile(path, kind);
+
+    if (!device->open(QIODevice::ReadOnly))
+    {
+        if (error != NULL)
+            *error = device->errorString();
+        delete device;
+        return NULL;
+    }
+    return device;
+}
+
+bool CompressedFile::skip(QIODevice *device, qint64 bytes)
+{
+    if (!device->isSequential())
+        return device->seek(bytes);
+
+    char buffer[64*1024];
+    while (bytes > 0)
+    {
+        qint64 n = device->read(buffer, qMin(bytes, (qint64)sizeof(buffer)));
+        if (n <= 0)
+            return false;
+        bytes -= n;
+    }
+    return true;
+}
+
+CompressedFile::CompressedFile(const QString& fileName, Format format, QObject *parent)
+    : QIODevice(parent), path(fileName), kind(format), worker(NULL),
+      currentPos(0), finished(false), stopping(false)
+{
+}
+
+CompressedFile::~CompressedFile()
+{
+    close();
+}
+
+bool CompressedFile::open(OpenMode mode)
+{
+    if (isOpen() || (mode & WriteOnly))
+        return false;
+#ifndef GC_WITH_ZSTD
+    if (kind == Zstd)
+    {
+        setErrorString(tr("'%1' : built without zstd support").arg(path));
+        return false;
+    }
+#endif
+    if (!QFile::exists(path))
+    {
+        setErrorString(tr("'%1' : no such file").arg(path));
+        return false;
+    }
+
+    chunks.clear();
+    current.clear();
+    currentPos = 0;
+    finished = false;
+    stopping = false;
+    failure.clear();
+
+    // no second buffer in QIODevice, the chunks are one
+    QIODevice::open(mode | Unbuffered);
+    worker = new Worker(this);
+    worker->start();
+    return true;
+}
+
+void CompressedFile::close()
+{
+    if (worker != NULL)
+    {
+        {
+            QMutexLocker lock(&mutex);
+            stopping = true;
+            changed.wakeAll();
+        }
+        worker->wait();
+        delete worker;
+        worker = NULL;
+    }
+    chunks.clear();
+    current.clear();
+    QIODevice::close();
+}
+
+bool CompressedFile::isSequential() const
+{
+    return true;
+}
+
+qint64 CompressedFile::bytesAvailable() const
+{
+    QMutexLocker lock(&mutex);
+    qint64 bytes = current.size() - currentPos;
+    foreach (const QByteArray& chunk, chunks)
+        bytes += chunk.size();
+    return bytes + QIODevice::bytesAvailable();
+}
+
+bool CompressedFile::atEnd() const
+{
+    if (!isOpen())
+        return true;
+    QMutexLocker lock(&mutex);
+    return !waitForChunk();
+}
+
+bool CompressedFile::failed() const
+{
+    QMutexLocker lock(&mutex);
+    return !failure.isEmpty();
+}
+
+bool CompressedFile::waitForChunk() const
+{
+    while (currentPos >= current.size())
+    {
+        if (!chunks.isEmpty())
+        {
+            current = chunks.dequeue();
+            currentPos = 0;
+            // room for the worker
+            changed.wakeAll();
+        }
+        else if (finished)
+            return false;
+        else
+            changed.wait(&mutex);
+    }
+    return true;
+}
+
+qint64 CompressedFile::readData(char *data, qint64 maxSize)
+{
+    QMutexLocker lock(&mutex);
+    qint64 done = 0;
+    while (done < maxSize && waitForChunk())
+    {
+        qint64 n = qMin(maxSize - done, (qint64)(current.size() - currentPos));
+        memcpy(data + done, current.constData() + currentPos, n);
+        currentPos += n;
+        done += n;
+        // what is ready, without waiting for the next chunk
+        if (chunks.isEmpty() && !finished)
+            break;
+    }
+    if (done == 0 && !failure.isEmpty())
+    {
+        setErrorString(failure);
+        return -1;
+    }
+    // end of a sequential device
+    return done > 0 ? done : -1;
+}
+
+qint64 CompressedFile::writeData(const char *, qint64)
+{
+    return -1;
+}
+
+// worker thread
+void CompressedFile::produce()
+{
+    QFile in(path);
+    bool ok = in.open(QIODevice::ReadOnly);
+    if (!ok)
+        failure = in.errorString();
+    else if (kind == Gzip)
+        ok = inflateGzip(in);
+    else
+        ok = inflateZstd(in);
+
+    QMutexLocker lock(&mutex);
+    if (!ok && failure.isEmpty() && !stopping)
+        failure = tr("'%1' : corrupt or truncated").arg(path);
+    finished = true;
+    changed.wakeAll();
+}
+
+bool CompressedFile::push(const QByteArray& chunk)
+{
+    QMutexLocker lock(&mutex);
+    while (chunks.size() >= COMPRESSED_QUEUE_CHUNKS && !stopping)
+        changed.wait(&mutex);
+    if (stopping)
+        return false;
+    chunks.enqueue(chunk);
+    changed.wakeAll();
+    return true;
+}
+
+// gzip or zlib stream, members of a concatenated file one after the other
+bool CompressedFile::inflateGzip(QIODevice& in)
+{
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    // 32 : automatic gzip or zlib header detection
+    if (inflateInit2(&zs, 15 + 32) != Z_OK)
+        return false;
+
+    QByteArray input;
+    QByteArray output(COMPRESSED_READ_CHUNK, 0);
+    int status = Z_OK;
+    bool full = false;
+    bool ok = true;
+    while (ok)
+    {
+        if (zs.avail_in == 0 && !full)
+        {
+            input = in.read(COMPRESSED_READ_CHUNK);
+            if (input.isEmpty())
+                break;
+            zs.next_in = (Bytef *)input.data();
+            zs.avail_in = input.size();
+        }
+        zs.next_out = (Bytef *)output.data();
+        zs.avail_out = output.size();
+        status = inflate(&zs, Z_NO_FLUSH);
+        if (status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR)
+        {
+            ok = false;
+            break;
+        }
+        int produced = output.size() - zs.avail_out;
+        full = zs.avail_out == 0;
+        if (produced > 0)
+            ok = push(output.left(produced));
+        if (status == Z_STREAM_END)
+        {
+            if (zs.avail_in == 0 && in.atEnd())
+                break;
+            inflateReset(&zs);
+            full = false;
+        }
+    }
+    inflateEnd(&zs);
+    return ok && status == Z_STREAM_END;
+}
+
+bool CompressedFile::inflateZstd(QIODevice& in)
+{
+#ifdef GC_WITH_ZSTD
+    ZSTD_DStream *stream = ZSTD_createDStream();
+    if (stream == NULL)
+        return false;
+    ZSTD_initDStream(stream);
+
+    QByteArray input;
+    QByteArray output(COMPRESSED_READ_CHUNK, 0);
+    // 0 at the end of a frame
+    size_t left = 1;
+    bool ok = true;
+    while (ok && !(input = in.read(COMPRESSED_READ_CHUNK)).isEmpty())
+    {
+        ZSTD_inBuffer ib = { input.constData(), (size_t)input.size(), 0 };
+        bool full = false;
+        while (ok && (ib.pos < ib.size || full))
+        {
+            ZSTD_outBuffer ob = { output.data(), (size_t)output.size(), 0 };
+            left = ZSTD_decompressStream(stream, &ob, &ib);
+            if (ZSTD_isError(left))
+            {
+                QMutexLocker lock(&mutex);
+                failure = tr("'%1' : %2").arg(path).arg(ZSTD_getErrorName(left));
+                ok = false;
+                break;
+            }
+            full = ob.pos == ob.size;
+            if (ob.pos > 0)
+                ok = push(output.left((int)ob.pos));
+        }
+    }
+    ZSTD_freeDStream(stream);
+    return ok && left == 0;
+#else
+    Q_UNUSED(in);
+    return false;
+#endif
+}
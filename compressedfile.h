@@ -0,0 +1,96 @@
+/****************************************************************
+ * compressedfile.h
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#ifndef COMPRESSEDFILE_H
+#define COMPRESSEDFILE_H
+
+#include <QIODevice>
+#include <QMutex>
+#include <QQueue>
+#include <QThread>
+#include <QWaitCondition>
+
+// compressed bytes read at once, and size of a decompressed chunk
+#define COMPRESSED_READ_CHUNK       (1 << 20)
+// decompressed chunks the worker keeps ahead of the reader
+#define COMPRESSED_QUEUE_CHUNKS     8
+
+// Read only stream of the text of a '.gz' or '.zst' G-code file.
+// A worker thread reads and decompresses the file ahead of the reader,
+// at most 'COMPRESSED_QUEUE_CHUNKS' chunks, so the text is never
+// written to the disk and the read of a slow share overlaps the use of
+// the text. '.zst' needs a build with GC_WITH_ZSTD.
+class CompressedFile : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    enum Format { Plain, Gzip, Zstd };
+
+    // from the suffix of 'path'
+    static Format format(const QString& path);
+    static bool isCompressed(const QString& path);
+    // 'path' without its compression suffix, 'job.nc.gz' -> 'job.nc'
+    static QString plainPath(const QString& path);
+    // a QFile for a plain file, opened read only, 0 on error
+    static QIODevice *openRead(const QString& path, QString *error = 0);
+    // skips the first 'bytes' of the text, a seek for a plain file
+    static bool skip(QIODevice *device, qint64 bytes);
+
+    CompressedFile(const QString& fileName, Format format, QObject *parent = 0);
+    ~CompressedFile();
+
+    bool open(OpenMode mode);
+    void close();
+    bool isSequential() const;
+    qint64 bytesAvailable() const;
+    // waits for the worker when no text is decompressed yet
+    bool atEnd() const;
+    // the file could not be read or decompressed to its end
+    bool failed() const;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize);
+    qint64 writeData(const char *data, qint64 maxSize);
+
+private:
+    class Worker : public QThread
+    {
+    public:
+        Worker(CompressedFile *file) : owner(file) {}
+    protected:
+        void run() { owner->produce(); }
+    private:
+        CompressedFile *owner;
+    };
+
+    // worker side
+    void produce();
+    bool inflateGzip(QIODevice& in);
+    bool inflateZstd(QIODevice& in);
+    // false when the reader closed the file
+    bool push(const QByteArray& chunk);
+    // reader side, with 'mutex' locked : false at the end of the text
+    bool waitForChunk() const;
+
+private:
+    QString path;
+    Format kind;
+    Worker *worker;
+    mutable QMutex mutex;
+    mutable QWaitCondition changed;
+    mutable QQueue<QByteArray> chunks;
+    mutable QByteArray current;
+    mutable int currentPos;
+    bool finished;
+    bool stopping;
+    QString failure;
+};
+
+#endif // COMPRESSEDFILE_H
@@ -1,4 +1,5 @@
 #include "controlparams.h"
+#include "options.h"
 
 ControlParams::ControlParams()
     :    waitTime(LONG_WAIT_SEC), zJogRate(DEFAULT_Z_JOG_RATE),
@@ -6,6 +7,8 @@ ControlParams::ControlParams()
             xyRateAmount(DEFAULT_XY_RATE),
             useAggressivePreload(false), filterFileCommands(false),
             reducePrecision(false), grblLineBufferLen(DEFAULT_GRBL_LINE_BUFFER_LEN),
+            compactLines(false), compactDecimals(DEFAULT_COMPACT_DECIMALS),
+            streamPrebufferLines(DEFAULT_STREAM_PREBUFFER_LINES),
             useFourAxis(false), charSendDelayMs(DEFAULT_CHAR_SEND_DELAY_MS),
             fourthAxisName(FOURTH_AXIS_A), fourthAxisRotate(true),
 /// T4
@@ -17,3 +20,67 @@ ControlParams::ControlParams()
             waitForJogToComplete(true)
 {
 }
+
+// values saved by the 'Options' dialog
+// calls : 'MainWindow::updateSettingsFromOptionDlg()':1, 'HeadlessRunner::HeadlessRunner()':1
+void ControlParams::load(QSettings& settings)
+{
+    waitTime = settings.value(SETTINGS_RESPONSE_WAIT_TIME, DEFAULT_WAIT_TIME_SEC).value<int>();
+    zJogRate = settings.value(SETTINGS_Z_JOG_RATE, DEFAULT_Z_JOG_RATE).value<double>();
+    QString useMmManualCmds = settings.value(SETTINGS_USE_MM_FOR_MANUAL_CMDS, "true").value<QString>();
+    useMm = useMmManualCmds == "true";
+    QString useAggrPreload = settings.value(SETTINGS_USE_AGGRESSIVE_PRELOAD, "true").value<QString>();
+    useAggressivePreload = useAggrPreload == "true";
+    QString waitJog = settings.value(SETTINGS_WAIT_FOR_JOG_TO_COMPLETE, "true").value<QString>();
+    waitForJogToComplete = waitJog == "true";
+
+    QString fourAxis = settings.value(SETTINGS_FOUR_AXIS_USE, "false").value<QString>();
+    useFourAxis = fourAxis == "true";
+
+    char name = settings.value(SETTINGS_FOUR_AXIS_NAME, FOURTH_AXIS_A).value<char>();
+    fourthAxisName = name;
+    bool rot = settings.value(SETTINGS_FOUR_AXIS_ROTATE, true).value<bool>();
+    fourthAxisRotate = rot;
+
+    QString zLimit = settings.value(SETTINGS_Z_RATE_LIMIT, "false").value<QString>();
+    zRateLimit = zLimit == "true";
+
+    QString ffCommands = settings.value(SETTINGS_FILTER_FILE_COMMANDS, "false").value<QString>();
+    filterFileCommands = ffCommands == "true";
+    QString rPrecision = settings.value(SETTINGS_REDUCE_PREC_FOR_LONG_LINES, "false").value<QString>();
+    reducePrecision = rPrecision == "true";
+    grblLineBufferLen = settings.value(SETTINGS_GRBL_LINE_BUFFER_LEN, DEFAULT_GRBL_LINE_BUFFER_LEN).value<int>();
+    QString compact = settings.value(SETTINGS_COMPACT_LINES, "false").value<QString>();
+    compactLines = compact == "true";
+    compactDecimals = settings.value(SETTINGS_COMPACT_DECIMALS, DEFAULT_COMPACT_DECIMALS).value<int>();
+    streamPrebufferLines = settings.value(SETTINGS_STREAM_PREBUFFER_LINES, DEFAULT_STREAM_PREBUFFER_LINES).value<int>();
+    charSendDelayMs = settings.value(SETTINGS_CHAR_SEND_DELAY_MS, DEFAULT_CHAR_SEND_DELAY_MS).value<int>();
+
+    zRateLimitAmount = settings.value(SETTINGS_Z_RATE_LIMIT_AMOUNT, DEFAULT_Z_LIMIT_RATE).value<double>();
+    xyRateAmount = settings.value(SETTINGS_XY_RATE_AMOUNT, DEFAULT_XY_RATE).value<double>();
+
+    positionRequestType = settings.value(SETTINGS_TYPE_POS_REQ, PREQ_ALWAYS_NO_IDLE_CHK).value<QString>();
+    double posReqFreq = settings.value(SETTINGS_POS_REQ_FREQ_SEC, DEFAULT_POS_REQ_FREQ_SEC).value<double>();
+    postionRequestTimeMilliSec = static_cast<int>(posReqFreq) * 1000;
+
+    posReqKind =  settings.value(SETTINGS_POS_REQ_KIND, POS_REQ).value<int>();
+
+/// T4
+    switch (posReqKind) {
+        case POS_REQ:
+            usePositionRequest = true;
+            positionSyncSimu = false;
+            positionNoDisplay = false;
+            break;
+        case POS_SYNC:
+            usePositionRequest = false;
+            positionSyncSimu = true;
+            positionNoDisplay = false;
+            break;
+        case POS_NO:
+            usePositionRequest = false;
+            positionSyncSimu = false;
+            positionNoDisplay = true;
+            break;
+    }
+}
@@ -1,6 +1,8 @@
 #ifndef CONTROLPARAMS_H
 #define CONTROLPARAMS_H
 
+#include <QSettings>
+
 #include "definitions.h"
 
 #define SHORT_WAIT_SEC 2
@@ -10,6 +12,7 @@ class ControlParams
 {
 public:
     ControlParams();
+    void load(QSettings& settings);
 
 public:
     int waitTime;
@@ -22,6 +25,10 @@ public:
     bool filterFileCommands;
     bool reducePrecision;
     int grblLineBufferLen;
+    bool compactLines;
+    int compactDecimals;
+    // lines of a stream read before the first one is sent
+    int streamPrebufferLines;
     bool useFourAxis;
     int charSendDelayMs;
     char fourthAxisName;
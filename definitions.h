@@ -23,6 +23,8 @@
 
 #define DEFAULT_GRBL_LINE_BUFFER_LEN    50
 #define DEFAULT_CHAR_SEND_DELAY_MS      0
+#define DEFAULT_COMPACT_DECIMALS        4
+#define DEFAULT_STREAM_PREBUFFER_LINES  200
 
 #define MM_IN_AN_INCH           25.4
 #define PRE_HOME_Z_ADJ_MM       5.0
@@ -110,4 +112,32 @@ void err(const char *str, ...);
 void warn(const char *str, ...);
 void info(const char *str, ...);
 
+// Level checked before the arguments are evaluated. The '_TR' forms
+// take 'tr("...")' and translate it once per call site. TRACE is for
+// what is logged on every status report, GC_NO_TRACE_LOG compiles it
+// out (release builds, see GCV.pro).
+#ifdef QT_DEBUG
+#define DIAG_ENABLED()      true
+#else
+#define DIAG_ENABLED()      (g_enableDebugLog.get() != 0)
+#endif
+
+#define DIAG(...) \
+    do { if (DIAG_ENABLED()) diag(__VA_ARGS__); } while (0)
+#define DIAG_TR(format, ...) \
+    do { if (DIAG_ENABLED()) { \
+            static const QByteArray trFormat = QString(format).toLocal8Bit(); \
+            diag(trFormat.constData(), __VA_ARGS__); } } while (0)
+
+#ifdef GC_NO_TRACE_LOG
+// still compiled for type checking, never called
+#define TRACE(...) \
+    do { if (false) diag(__VA_ARGS__); } while (0)
+#define TRACE_TR(format, ...) \
+    do { if (false) diag("", __VA_ARGS__); } while (0)
+#else
+#define TRACE(...)              DIAG(__VA_ARGS__)
+#define TRACE_TR(format, ...)   DIAG_TR(format, __VA_ARGS__)
+#endif
+
 #endif // DEFINITIONS_H
@@ -0,0 +1,78 @@
+/****************************************************************
+ * framescheduler.cpp
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#include "framescheduler.h"
+
+#include <QGuiApplication>
+#include <QScreen>
+
+FrameScheduler::FrameScheduler(QObject *parent)
+    : QObject(parent), frameMsec(FRAME_INTERVAL_MSEC)
+{
+    QScreen *screen = QGuiApplication::primaryScreen();
+    if (screen != NULL && screen->refreshRate() > 1)
+        frameMsec = qMax(1, qRound(1000.0 / screen->refreshRate()));
+
+    timer.setSingleShot(true);
+    connect(&timer, SIGNAL(timeout()), this, SLOT(render()));
+}
+
+int FrameScheduler::interval() const
+{
+    return frameMsec;
+}
+
+void FrameScheduler::invalidate(QWidget *widget, const QRect& rect)
+{
+    Dirty& d = dirty[widget];
+    d.widget = widget;
+    if (rect.isNull())
+        d.whole = true;
+    else if (!d.whole)
+        d.region += rect;
+    schedule();
+}
+
+void FrameScheduler::requestFrame()
+{
+    schedule();
+}
+
+// the first change after a pause is shown at once, the next ones wait
+// for the end of the frame
+void FrameScheduler::schedule()
+{
+    if (timer.isActive())
+        return;
+
+    int wait = 0;
+    if (lastFrame.isValid())
+        wait = qMax(0, frameMsec - (int)lastFrame.elapsed());
+    timer.start(wait);
+}
+
+void FrameScheduler::render()
+{
+    lastFrame.start();
+    // the slots may mark more widgets dirty, repainted in this frame
+    emit frame();
+
+    QHash<QWidget *, Dirty> painted;
+    painted.swap(dirty);
+    foreach (const Dirty& d, painted)
+    {
+        // deleted since it was marked
+        if (d.widget.isNull())
+            continue;
+        if (d.whole)
+            d.widget->update();
+        else
+            d.widget->update(d.region);
+    }
+}
@@ -0,0 +1,68 @@
+/****************************************************************
+ * framescheduler.h
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QRegion>
+#include <QTimer>
+#include <QWidget>
+
+// frame interval when the refresh rate of the screen is unknown
+#define FRAME_INTERVAL_MSEC     16
+
+// The views ask for a repaint here instead of calling 'update()' : the
+// widgets and regions marked dirty are repainted together, at most once
+// per refresh of the screen, however many positions or lines arrived in
+// between. Nothing runs while nothing changes.
+class FrameScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FrameScheduler(QObject *parent = 0);
+
+    // 'rect' of 'widget' is repainted at the next frame, all of it when null
+    void invalidate(QWidget *widget, const QRect& rect = QRect());
+    // 'frame()' is emitted at the next frame, for state that is not a widget
+    void requestFrame();
+    int interval() const;
+
+signals:
+    // once per frame, before the repaints
+    void frame();
+
+private slots:
+    void render();
+
+private:
+    void schedule();
+
+private:
+    class Dirty
+    {
+    public:
+        Dirty() : whole(false) {}
+    public:
+        QPointer<QWidget> widget;
+        QRegion region;
+        bool whole;
+    };
+
+    QTimer timer;
+    QElapsedTimer lastFrame;
+    int frameMsec;
+    QHash<QWidget *, Dirty> dirty;
+};
+
+#endif // FRAMESCHEDULER_H
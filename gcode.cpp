@@ -8,9 +8,11 @@
  ****************************************************************/
 
 #include "gcode.h"
+#include "compressedfile.h"
 
 #include <QObject>
 #include <QDebug>
+#include <QScopedPointer>
 
 GCode::GCode()
     : errorCount(0), doubleDollarFormat(false),
@@ -20,13 +22,13 @@ GCode::GCode()
       positionValid(false),
       numaxis(DEFAULT_AXIS_COUNT),
 /// T3
-      checkState(false)
+      checkState(false),
+      followFile(false)
 {
     // use base class's timer - use it to capture random text from the controller
   //  startTimer(1000);
     // for position polling
     pollPosTimer.start();
-
 }
 
 void GCode::openPort(QString commPortStr, QString baudRate)
@@ -64,16 +66,16 @@ void GCode::openPort(QString commPortStr, QString baudRate)
         emit portIsClosed();
         QString msg = tr("Can't open COM port ") + commPortStr;
         sendMsgSatusBar(msg);
-        addList(msg);
+        postList(msg);
         warn("%s", qPrintable(msg));
 
-        addList(tr("Error :") + port->errorString());
-        addList(tr("-Is hardware connected to USB?") );
-        addList(tr("-Is another process using this port?") );
-        addList(tr("-Is correct port chosen?") );
-        addList(tr("-Does current user have sufficient permissions?") );
+        postList(tr("Error :") + port->errorString());
+        postList(tr("-Is hardware connected to USB?") );
+        postList(tr("-Is another process using this port?") );
+        postList(tr("-Is correct port chosen?") );
+        postList(tr("-Does current user have sufficient permissions?") );
 #if defined(Q_OS_LINUX)
-        addList("-Is current user in sudoers group?");
+        postList("-Is current user in sudoers group?");
 #endif
 
     }
@@ -304,7 +306,7 @@ void GCode::goToHomeAxis(char axis)
         qDebug() << "gotoHomeAxis";
         QString msg(QString(tr("Bad command: %1")).arg(cmd));
         warn("%s", qPrintable(msg));
-        emit addList(msg);
+        postList(msg);
     }
 
     emit endHomeAxis();
@@ -438,7 +440,7 @@ bool GCode::checkGrbl(const QString& result)
                     doubleDollarFormat = true;
                 }
 /// T2
-                diag(qPrintable(tr("Got Grbl Version (Parsed:) %d.%d%c%c ($$=%d)\n")),
+                DIAG_TR(tr("Got Grbl Version (Parsed:) %d.%d%c%c ($$=%d)\n"),
                             majorVer, minorVer, letter, postVer, doubleDollarFormat);
                 QString resu = list.at(0);
 				emit setVersionGrbl(resu);
@@ -505,6 +507,9 @@ bool GCode::sendGcodeLocal(QString line, bool recordResponseOnFail /* = false */
         }
     }
     resetState.set(false);
+    // file lines are flushed by time, single commands right away
+    if (!currLine)
+        flushList(true);
     return ret;
 }
 
@@ -516,7 +521,7 @@ bool GCode::sendGcodeInternal(QString line, QString& result, bool recordResponse
     {
         QString msg = tr("Port not available yet")  ;
         err("%s", qPrintable(msg));
-        emit addList(msg);
+        postList(msg);
         emit sendMsgSatusBar(msg);
         return false;
     }
@@ -554,23 +559,21 @@ bool GCode::sendGcodeInternal(QString line, QString& result, bool recordResponse
     // adds to UI list, but prepends a > indicating a sent command
     if (ctrlX)
     {
-        emit addListOut("(CTRL-X)");
+        queueList("(CTRL-X)", false);
     }
     else if (!sentReqForLocation)// if requesting location, don't add that "noise" to the output view
     {
 /// T3  + fix bug
         QString nLine(line);
         if (currLine) {
-            nLine = QString().setNum(currLine);
-            emit setLinesFile(nLine, true);
             if (line.at(0).toLatin1() != 'N')
-                nLine = "L" +  nLine + "  " + line;
+                nLine = "L" + QString::number(currLine) + "  " + line;
             else
                 nLine = line ;
         }
 /// T4   - '$$',
         if (!checkState && !sentReqForSettings)
-            emit addListOut(nLine);
+            queueList(nLine, false);
 /// <--
     }
 
@@ -584,7 +587,7 @@ bool GCode::sendGcodeInternal(QString line, QString& result, bool recordResponse
     {
         QString msg = tr("No Command");
         err("%s", qPrintable(msg));
-        emit addList(msg);
+        postList(msg);
         emit sendMsgSatusBar(msg);
         return false;
     }
@@ -594,9 +597,9 @@ bool GCode::sendGcodeInternal(QString line, QString& result, bool recordResponse
     buffer.append(line.toLatin1());
 
     if (ctrlX)
-        diag(qPrintable(tr("SENDING[%d]: 0x%02X (CTRL-X)\n")), currLine, buffer.data());
+        DIAG_TR(tr("SENDING[%d]: 0x%02X (CTRL-X)\n"), currLine, buffer.data());
     else
-        diag(qPrintable(tr("SENDING[%d]: %s\n")), currLine, buffer.data());
+        DIAG_TR(tr("SENDING[%d]: %s\n"), currLine, buffer.data());
 
     int waitSecActual = waitSec == -1 ? controlParams.waitTime : waitSec;
 
@@ -609,7 +612,7 @@ bool GCode::sendGcodeInternal(QString line, QString& result, bool recordResponse
 
 //diag("DG Buffer Add %d", sendCount.size());
 
-        emit setQueuedCommands(sendCount.size(), true);
+        telemetry.publishQueue(sendCount.size(), true);
 /// T4
       ///?  waitForOk(result, waitSecActual, false, false, false, aggressive, false);
 
@@ -643,31 +646,35 @@ bool GCode::sendGcodeInternal(QString line, QString& result, bool recordResponse
      {
          QString msg = tr("Sending data to port failed") + port->errorString() ;
          err("%s", qPrintable(msg));
-         emit addList(msg);
+         postList(msg);
          emit sendMsgSatusBar(msg);
          return false;
      }else if(bytesWritten != buffer.size())
      {
          QString msg = tr("Could not send all data to port: ") + port->errorString()  ;
          err("%s", qPrintable(msg));
-         emit addList(msg);
+         postList(msg);
          emit sendMsgSatusBar(msg);
          return false;
 
      }else if(data.contains(RESPONSE_ERROR)){
          QString msg = QString(data) +" "+ port->errorString();
          err("%s", qPrintable(msg));
-         emit addList(msg);
+         postList(msg);
          emit sendMsgSatusBar(msg);
          return false;
      }else{
          emit sendMsgSatusBar("");
          sentI++;
+         journal.ack(currLine);
 
         if (sentReqForSettings)
         {
 qDebug() << "sentReqFor ";
             QStringList list = result.split("$");
+            // 0.8 has one seek rate, 0.9 a max rate per axis
+            bool seekRate = versionGrbl.startsWith("0.8");
+            double rapidX = 0, rapidY = 0;
             for (int i = 0; i < list.size(); i++)
             {
                 QString item = list.at(i);
@@ -685,12 +692,18 @@ qDebug() << "sentReqFor ";
                         bool Grblg20 = capList.at(2).compare("0"),
                                 g21 = controlParams.useMm ;
                         incorrectLcdDisplayUnits = Grblg20 == g21;
-
-                        break;
                     }
+                    else if (seekRate && capList.at(1) == "4")
+                        rapidX = rapidY = capList.at(2).toDouble();
+                    else if (!seekRate && capList.at(1) == "110")
+                        rapidX = capList.at(2).toDouble();
+                    else if (!seekRate && capList.at(1) == "111")
+                        rapidY = capList.at(2).toDouble();
                 }
                 settingsItemCount.set(list.size());
             }
+            if (rapidX > 0 && rapidY > 0)
+                emit setRapidRates(rapidX, rapidY);
         }
          sendStatusList(dataList);
      }
@@ -789,6 +802,8 @@ bool GCode::waitForOk(QString& result, int waitSec, bool sentReqForLocation,
             if (aggressive && sendCount.size() == 0)
                 return false;
 
+            // nothing to read, give the GUI what is pending
+            flushList(false);
             count++;
              //SLEEP(100);
         }
@@ -823,10 +838,11 @@ bool GCode::waitForOk(QString& result, int waitSec, bool sentReqForLocation,
                     else
                     {
                         CmdResponse cmdResp = sendCount.takeFirst();
-                        diag(qPrintable(tr("GOT[%d]: '%s' for '%s' (aggressive)\n")), cmdResp.line,
+                        DIAG_TR(tr("GOT[%d]: '%s' for '%s' (aggressive)\n"), cmdResp.line,
                             qPrintable(tmpTrim), qPrintable(cmdResp.cmd.trimmed()));
 //diag("DG Buffer %d", sendCount.size());
-						emit setQueuedCommands(sendCount.size(), true);
+						telemetry.publishQueue(sendCount.size(), true);
+                        journal.ack(cmdResp.line);
                     }
                     rcvdI++;
                     okcount++;
@@ -841,21 +857,21 @@ bool GCode::waitForOk(QString& result, int waitSec, bool sentReqForLocation,
                     {
                         CmdResponse cmdResp = sendCount.takeFirst();
                         orig = cmdResp.cmd;
-                        diag(qPrintable(tr("GOT[%d]: '%s' for '%s' (aggressive)\n")), cmdResp.line,
+                        DIAG_TR(tr("GOT[%d]: '%s' for '%s' (aggressive)\n"), cmdResp.line,
                              qPrintable(tmpTrim), qPrintable(cmdResp.cmd.trimmed()));
 //diag("DG Buffer %d", sendCount.size());
-                        emit setQueuedCommands(sendCount.size(), true);
+                        telemetry.publishQueue(sendCount.size(), true);
                     }
                     errorCount++;
                     QString result;
                     QTextStream(&result) << received << " [for " << orig << "]";
-                    emit addList(result);
+                    queueList(result, true);
                     grblCmdErrors.append(result);
                     rcvdI++;
                 }
                 else
                 {
-                    diag(qPrintable(tr("GOT: '%s' (aggressive)\n")), qPrintable(tmpTrim.trimmed()) );
+                    DIAG_TR(tr("GOT: '%s' (aggressive)\n"), qPrintable(tmpTrim.trimmed()) );
                     parseCoordinates(received, aggressive);
                 }
 
@@ -892,7 +908,7 @@ bool GCode::waitForOk(QString& result, int waitSec, bool sentReqForLocation,
             }
             else
             {
-                diag(qPrintable(tr("GOT:%s\n")), qPrintable(tmpTrim));
+                DIAG_TR(tr("GOT:%s\n"), qPrintable(tmpTrim));
             }
 
             if (!received.contains(RESPONSE_OK) && !received.contains(RESPONSE_ERROR))
@@ -950,7 +966,7 @@ bool GCode::waitForOk(QString& result, int waitSec, bool sentReqForLocation,
         {
             QString msg(tr("Wait interrupted by user"));
             err("%s", qPrintable(msg));
-            emit addList(msg);
+            postList(msg);
         }
     }
 
@@ -1000,10 +1016,10 @@ bool GCode::waitForStartupBanner()
     if (result.isEmpty())
     {
         QString msg(tr("No data from COM port after connect."));
-        emit addList(msg);
-        addList("Expecting Grbl version string.");
-        addList("Note: since Gbrl-version >0.9");
-        addList("you have to use this baudrate: 115200");
+        postList(msg);
+        postList("Expecting Grbl version string.");
+        postList("Note: since Gbrl-version >0.9");
+        postList("you have to use this baudrate: 115200");
         emit sendMsgSatusBar(msg);
 
     }else{
@@ -1011,7 +1027,7 @@ bool GCode::waitForStartupBanner()
         {
 
             QString msg(tr("Expecting Grbl version string. Unable to parse response."));
-            emit addList(msg);
+            postList(msg);
             emit sendMsgSatusBar(msg);
 
             closePort();
@@ -1031,13 +1047,13 @@ bool GCode::waitForStartupBanner()
 
         /*if (versionGrbl != "0.845")
         {
-            emit addListOut("(CTRL-X)");
+            postListOut("(CTRL-X)");
 
             char buf[2] = {0};
 
             buf[0] = CTRL_X;
 
-            diag(qPrintable(tr("SENDING: 0x%02X (CTRL-X) to check presence of Grbl\n")), buf[0])  ;
+            DIAG_TR(tr("SENDING: 0x%02X (CTRL-X) to check presence of Grbl\n"), buf[0])  ;
             qDebug() << "sendgcode: " << buf[0];
             if (sendToPort(buf))
                 emit sendMsgSatusBar("");
@@ -1051,6 +1067,7 @@ bool GCode::waitForStartupBanner()
     qDebug() << result;
     QStringList list(result);
     sendStatusList(list);
+    flushList(true);
 
     return status;
 }
@@ -1136,7 +1153,7 @@ void GCode::parseCoordinates(const QString& received, bool aggressive)
             if (naxis > DEFAULT_AXIS_COUNT)
             {
                 QString msg = tr("Incorrect - extra axis present in hardware but options set for only 3 axes. Please fix options.");
-                emit addList(msg);
+                postList(msg);
                 emit sendMsgSatusBar(msg);
             }
         }
@@ -1145,7 +1162,7 @@ void GCode::parseCoordinates(const QString& received, bool aggressive)
             if (naxis <= DEFAULT_AXIS_COUNT)
             {
                 QString msg = tr("Incorrect - extra axis not present in hardware but options set for > 3 axes. Please fix options.");
-                emit addList(msg);
+                postList(msg);
                 emit sendMsgSatusBar(msg);
             }
         }
@@ -1185,14 +1202,14 @@ void GCode::parseCoordinates(const QString& received, bool aggressive)
 		workCoord.sliderZIndex = sliderZCount;
 
         if (doubleDollarFormat)
-			diag(qPrintable(tr("Decoded: State:%s")),  qPrintable(state) );
+			TRACE_TR(tr("Decoded: State:%s"),  qPrintable(state) );
         if (numaxis == DEFAULT_AXIS_COUNT)
-            diag(qPrintable(tr("Decoded: MPos: %f,%f,%f WPos: %f,%f,%f\n")),
+            TRACE_TR(tr("Decoded: MPos: %f,%f,%f WPos: %f,%f,%f\n"),
                  machineCoord.x, machineCoord.y, machineCoord.z,
                  workCoord.x, workCoord.y, workCoord.z
 				 );
         else if (numaxis == MAX_AXIS_COUNT)
-            diag(qPrintable(tr("Decoded: MPos: %f,%f,%f,%f WPos: %f,%f,%f,%f\n")),
+            TRACE_TR(tr("Decoded: MPos: %f,%f,%f,%f WPos: %f,%f,%f,%f\n"),
                  machineCoord.x, machineCoord.y, machineCoord.z, machineCoord.fourth,
                  workCoord.x, workCoord.y, workCoord.z, workCoord.fourth
 				 );
@@ -1201,13 +1218,9 @@ void GCode::parseCoordinates(const QString& received, bool aggressive)
 			maxZ = workCoord.z;
 
 /// T4  3D
-	//	if (posReqKind == POS_REQ)
-        emit updateCoordinates(machineCoord, workCoord);
-    //    else  {
-      //  emit setLivePoint(QVector3D(workCoord.x, workCoord.y, workCoord.z)) ;
-    //    }
-        // 2D
-        emit setLivePoint(workCoord.x, workCoord.y, controlParams.useMm, positionValid);
+        // LCD and 2D live point are sampled by the GUI
+        telemetry.publishPosition(machineCoord, workCoord, controlParams.useMm, positionValid);
+        journal.position(machineCoord, workCoord, controlParams.useMm);
 
 	//	emit setLastState(state);
 
@@ -1223,14 +1236,63 @@ void GCode::parseCoordinates(const QString& received, bool aggressive)
 
 void GCode::sendStatusList(QStringList& listToSend)
 {
-    if (listToSend.size() > 1)
-    {
-        emit addListFull(listToSend);
-    }
-    else if (listToSend.size() == 1)
-    {
-        emit addList(listToSend.at(0));
-    }
+    foreach (QString line, listToSend)
+        queueList(line, true);
+}
+
+// Status lines are not sent one signal per line: while streaming that
+// means a queued event and a text layout per 'ok'. They are collected
+// here and delivered as one chunk at most every LIST_CHUNK_FLUSH_MSEC.
+// calls : 'sendGcodeInternal()':2, 'waitForOk()':1, 'sendStatusList()':1
+void GCode::queueList(QString line, bool in)
+{
+    line = line.trimmed();
+    line.remove('\r');
+    line.remove('\n');
+    if (line.isEmpty())
+        return;
+
+    if (!in)
+        line.prepend("> ");
+
+    if (pendingList.isEmpty())
+        pendingListTimer.start();
+    pendingList.append(line);
+
+    flushList(false);
+}
+
+void GCode::flushList(bool force)
+{
+    if (pendingList.isEmpty())
+        return;
+
+    if (!force && pendingList.size() < LIST_CHUNK_MAX_LINES
+            && pendingListTimer.elapsed() < LIST_CHUNK_FLUSH_MSEC)
+        return;
+
+    emit addListChunk(pendingList);
+    pendingList.clear();
+}
+
+// Messages that are not status lines go out at once, but after the chunk
+// still pending : the GUI gets them in the order they were written.
+void GCode::postList(QString line)
+{
+    flushList(true);
+    emit addList(line);
+}
+
+void GCode::postListOut(QString line)
+{
+    flushList(true);
+    emit addListOut(line);
+}
+
+void GCode::postListFull(QStringList list)
+{
+    flushList(true);
+    emit addListFull(list);
 }
 
 // called once a second to capture any random strings that come from the controller
@@ -1252,7 +1314,7 @@ void GCode::timerEvent(QTimerEvent *event)
 
             tmp[n] = 0;
             result.append(tmp);
-            diag(qPrintable(tr("GOT-TE:%s\n")), tmp);
+            TRACE_TR(tr("GOT-TE:%s\n"), tmp);
         }
 
         if (shutdownState.get())
@@ -1274,13 +1336,34 @@ void GCode::timerEvent(QTimerEvent *event)
 /// T3
 void GCode::sendFile(QString path, bool checkfile)
 {
-    addList(QString(tr("Sending file '%1'")).arg(path));
+    sendFileFrom(path, checkfile, 1, 0, 0, QStringList());
+}
+
+// calls : 'HeadlessRunner::portOpened()':1
+void GCode::setFollowFile(bool follow)
+{
+    followFile = follow;
+}
+
+// 'firstLine' starts at the byte 'offset' of the file, with 'preamble' sent
+// first to restore the modal state; 'totalLines' avoids counting the lines.
+// calls : 'MainWindow::begin()':1, 'GCode::sendFile()':1
+void GCode::sendFileFrom(QString path, bool checkfile, int firstLine, qint64 offset,
+                         int totalLines, QStringList preamble)
+{
+    if (firstLine > 1)
+        postList(QString(tr("Sending file '%1' from line %2")).arg(path).arg(firstLine));
+    else
+        postList(QString(tr("Sending file '%1'")).arg(path));
+
+    // a lost port keeps the job in the journal for a resume
+    bool interrupted = false;
 
     // send something to be sure the controller is ready
     //sendGcodeLocal("", true, SHORT_WAIT_SEC);
 
-    setProgress(0);
-    emit setQueuedCommands(0, false);
+    telemetry.publishProgress(0);
+    telemetry.publishQueue(0, false);
     grblCmdErrors.clear();
     grblFilteredCmds.clear();
     errorCount = 0;
@@ -1288,22 +1371,70 @@ void GCode::sendFile(QString path, bool checkfile)
 /// T4
     pauseState.set(false);
 
-    QFile file(path);
-    if (file.open(QFile::ReadOnly))
+    // a pipe or a followed file is sent while its producer writes it
+    bool follow = followFile;
+    followFile = false;
+    QScopedPointer<StreamSource> stream;
+    QScopedPointer<QIODevice> file;
+    if (follow || StreamSource::isStream(path))
+    {
+        stream.reset(new StreamSource(path, follow));
+        if (!stream->open())
+        {
+            emit sendMsgSatusBar(stream->errorString());
+            stream.reset();
+        }
+    }
+    else
+        // a compressed file is decompressed while it is sent
+        file.reset(CompressedFile::openRead(path));
+    if (!file.isNull() || !stream.isNull())
     {
 ///  T1  float -> int
-        int totalLineCount = 0;
+        int totalLineCount = totalLines;
 
-        QTextStream code(&file);
-        while ((code.atEnd() == false))
+        // unknown until the producer is done
+        if (!stream.isNull())
+            totalLineCount = 0;
+        else
         {
-            totalLineCount++;
-            code.readLine();
-        }
-        if (totalLineCount == 0)
-            totalLineCount = 1;
+            if (totalLineCount <= 0)
+            {
+                // on a reader of its own, a compressed stream can't go back
+                totalLineCount = 0;
+                QScopedPointer<QIODevice> counted(CompressedFile::openRead(path));
+                QTextStream count(counted.data());
+                while (!counted.isNull() && count.atEnd() == false)
+                {
+                    totalLineCount++;
+                    count.readLine();
+                }
+            }
+            if (totalLineCount == 0)
+                totalLineCount = 1;
 
-        code.seek(0);
+            CompressedFile::skip(file.data(), offset);
+        }
+        QTextStream code;
+        if (!file.isNull())
+            code.setDevice(file.data());
+        telemetry.publishStart(totalLineCount, !checkfile);
+        // a stream can't be read again for a resume
+        if (!checkfile && stream.isNull())
+            journal.begin(path, firstLine, totalLineCount);
+
+        // the machine starts once the producer is enough lines ahead
+        if (!stream.isNull())
+        {
+            postList(QString(tr("Waiting for %1 lines of the stream"))
+                         .arg(controlParams.streamPrebufferLines));
+            while (!stream->waitForLines(controlParams.streamPrebufferLines, STREAM_POLL_MSEC)
+                   && !abortState.get())
+            {
+                if (!checkfile)
+                    positionUpdate();
+            }
+        }
 
         // set here once so that it doesn't change in the middle of a file send
         bool aggressive = controlParams.useAggressivePreload;
@@ -1314,7 +1445,7 @@ void GCode::sendFile(QString path, bool checkfile)
             //{
             //    diag("DG Buffer 0 at start\n"));
             //}
-            emit setQueuedCommands(sendCount.size(), true);
+            telemetry.publishQueue(sendCount.size(), true);
         }
 
         sentI = 0;
@@ -1324,17 +1455,34 @@ void GCode::sendFile(QString path, bool checkfile)
        // parseCoordTimer.restart();
        parseCoordTimer.start();
 
-        int currLine = 0;
+        int currLine = firstLine - 1;
         bool xyRateSet = false;
+
+        // nothing is known of the controller state before the file
+        compactor.reset();
+        compactor.clearCounts();
+        compactor.setDecimals(controlParams.compactDecimals);
+
+        // units, plane, distance mode, spindle and the approach to the first line
+        foreach (QString line, preamble)
+        {
+            if (controlParams.compactLines)
+                line = compactor.compact(line);
+            if (line.isEmpty())
+                continue;
+            if (!sendGcodeLocal(line, false, -1, aggressive))
+            {
+                abortState.set(true);
+                interrupted = true;
+                break;
+            }
+        }
 /// T1
         QString strline ;
-        do
+        while (!abortState.get() && readProgramLine(code, stream.data(), strline, checkfile))
         {
-            strline = code.readLine();
 /// T3
-            if (!checkfile)  {
-                emit setVisCurrLine(currLine + 1);
-            }
+            telemetry.publishLine(currLine + 1);
 
             if (controlParams.filterFileCommands)
             {
@@ -1373,11 +1521,10 @@ void GCode::sendFile(QString path, bool checkfile)
                     {
                         outputList.append(strline);
                     }
-/// T4
-                    if (!checkfile)
-                        emit setNumLine(QString::number(currLine + 1));
-
-                    bool ret = false;
+                    // blocks repeating the modal state may vanish
+                    if (controlParams.compactLines)
+                        outputList = compactor.compact(outputList);
+                    bool ret = outputList.isEmpty();
                     if (outputList.size() == 1)
                     {
                         ret = sendGcodeLocal(outputList.at(0), false, -1, aggressive, currLine + 1);
@@ -1394,18 +1541,24 @@ void GCode::sendFile(QString path, bool checkfile)
                     }
 
                     if (rateLimitMsg.size() > 0)
-                        addList(rateLimitMsg);
+                        queueList(rateLimitMsg, true);
 
                     if (!ret)
                     {
                         abortState.set(true);
+                        interrupted = true;
                         break;
                     }
                 }
             }
 
-            float percentComplete = (currLine * 100.0) / totalLineCount;
-            setProgress((int)percentComplete);
+            if (stream.isNull())
+            {
+                float percentComplete = (currLine * 100.0) / totalLineCount;
+                telemetry.publishProgress((int)percentComplete);
+            }
+            else
+                telemetry.publishBytes(stream->bytesTaken());
 /// T3
             if (!checkfile)
                 positionUpdate();
@@ -1413,16 +1566,28 @@ void GCode::sendFile(QString path, bool checkfile)
             if (pauseState.get() )
             {
                 gotoPause();
+                // commands may have been sent by hand meanwhile
+                compactor.reset();
             }
 /// end pause
             if (!checkfile)
                 positionUpdate();
 /// <--
            currLine++;
+        }
 
-        } while ((code.atEnd() == false) && (!abortState.get()));
-
-        file.close();
+        if (!stream.isNull())
+        {
+            // lines missing at the end of the program
+            if (stream->failed())
+            {
+                postList(stream->errorString());
+                abortState.set(true);
+            }
+            stream->close();
+        }
+        else
+            file->close();
 
         if (aggressive)
         {
@@ -1459,65 +1624,112 @@ void GCode::sendFile(QString path, bool checkfile)
             return;
         }
 
+        flushList(true);
         QString msg;
+        if (controlParams.compactLines && compactor.bytesIn() > 0)
+        {
+            postList(QString(tr("Compacted %1 bytes to %2 (%3%)"))
+                         .arg(compactor.bytesIn()).arg(compactor.bytesOut())
+                         .arg(compactor.bytesOut() * 100 / compactor.bytesIn()));
+        }
         if (!abortState.get())
         {
-            setProgress(100);
+            telemetry.publishProgress(100);
             if (errorCount > 0)
             {
                 msg = QString(tr("Code sent successfully with %1 error(s):")).arg(QString::number(errorCount));
                 emit sendMsgSatusBar(msg);
-                emit addList(msg);
+                postList(msg);
 
                 foreach(QString errItem, grblCmdErrors)
                 {
                     emit sendMsgSatusBar(errItem);
                 }
-                emit addListFull(grblCmdErrors);
+                postListFull(grblCmdErrors);
             }
             else
             {
                 msg = tr("Code sent successfully with no errors.");
                 emit sendMsgSatusBar(msg);
-                emit addList(msg);
+                postList(msg);
             }
 
             if (grblFilteredCmds.size() > 0)
             {
                 msg = QString(tr("Filtered %1 commands:")).arg(QString::number(grblFilteredCmds.size()));
                 emit sendMsgSatusBar(msg);
-                emit addList(msg);
+                postList(msg);
 
                 foreach(QString errItem, grblFilteredCmds)
                 {
                     emit sendMsgSatusBar(errItem);
                 }
-                emit addListFull(grblFilteredCmds);
+                postListFull(grblFilteredCmds);
             }
         }
         else
         {
             msg = tr("Process interrupted.");
             emit sendMsgSatusBar(msg);
-            emit addList(msg);
+            postList(msg);
         }
     }
 /// Ta : TODO ...
    ///  pollPosWaitForIdle(true);
    pollPosWaitForIdle(false);
 
+    flushList(true);
+    telemetry.publishQueue(0, false);
+    telemetry.publishStop();
+    if (!interrupted)
+        journal.finish();
+
     if (!resetState.get())
     {
         emit stopSending();
     }
+}
 
-    emit setQueuedCommands(0, false);
+// The next line of the file, or of the stream once its producer wrote it.
+// The machine keeps reporting its position while the producer is late.
+// calls : 'GCode::sendFileFrom()':1
+bool GCode::readProgramLine(QTextStream& code, StreamSource *stream, QString& line, bool checkfile)
+{
+    if (stream == NULL)
+    {
+        if (code.atEnd())
+            return false;
+        line = code.readLine();
+        return true;
+    }
+
+    bool starved = false;
+    for (;;)
+    {
+        StreamSource::Wait wait = stream->nextLine(line, STREAM_POLL_MSEC);
+        if (wait != StreamSource::Timeout)
+        {
+            if (starved)
+                emit sendMsgSatusBar(tr("Stream resumed"));
+            return wait == StreamSource::Line;
+        }
+        if (abortState.get())
+            return false;
+        if (!starved)
+        {
+            starved = true;
+            emit sendMsgSatusBar(tr("Waiting for the next lines of the stream..."));
+        }
+        if (!checkfile)
+            positionUpdate();
+    }
 }
 
 /// T4
 // calls : 'GCode::sendFile(..)':1,
 void GCode::gotoPause()
 {
+    flushList(true);
    // QString oldstate = lastState;
     // virtual state !
   //  emit setLastState("Hold");
@@ -1526,7 +1738,7 @@ void GCode::gotoPause()
     msg = tr("Pause for sending 'Gcode' lines to 'Grbl'");
     msg += " ... '!'";
     emit sendMsgSatusBar(msg);
-    addList(msg);
+    postList(msg);
 
     sendGcodeLocal(REQUEST_CURRENT_POS) ;
 /// pause ...
@@ -1545,7 +1757,7 @@ void GCode::gotoPause()
     msg = tr("Resume sending 'Gcode' lines to 'Grbl'");
     msg += "'~'";
     emit sendMsgSatusBar(msg);
-    addList(msg);
+    postList(msg);
 }
 
 void GCode::trimToEnd(QString& strline, QChar ch)
@@ -1569,7 +1781,7 @@ QString GCode::removeUnsupportedCommands(QString line)
             QString msg(QString(tr("Removed unsupported command '%1' part of '%2'")).arg(s).arg(following));
             warn("%s", qPrintable(msg));
             grblFilteredCmds.append(msg);
-            emit addList(msg);
+            postList(msg);
             continue;
         }
 
@@ -1585,7 +1797,7 @@ QString GCode::removeUnsupportedCommands(QString line)
                 QString msg(QString(tr("Removed unsupported G command '%1'")).arg(s));
                 warn("%s", qPrintable(msg));
                 grblFilteredCmds.append(msg);
-                emit addList(msg);
+                postList(msg);
             }
         }
         else if (s.at(0) == 'M')
@@ -1598,7 +1810,7 @@ QString GCode::removeUnsupportedCommands(QString line)
                 QString msg(QString(tr("Removed unsupported M command '%1'")).arg(s));
                 warn("%s", qPrintable(msg));
                 grblFilteredCmds.append(msg);
-                emit addList(msg);
+                postList(msg);
             }
         }
         else if (s.at(0) == 'N')
@@ -1618,7 +1830,7 @@ QString GCode::removeUnsupportedCommands(QString line)
             QString msg(QString(tr("Removed unsupported command '%1'")).arg(s));
             warn("%s", qPrintable(msg));
             grblFilteredCmds.append(msg);
-            emit addList(msg);
+            postList(msg);
             tmp.append(s).append(" ");
         }
     }
@@ -1756,7 +1968,7 @@ QString GCode::reducePrecision(QString line)
             else
                 msg = QString(tr("Precision reduced '%1'")).arg(result);
 
-            emit addList(msg);
+            postList(msg);
             emit sendMsgSatusBar(msg);
         }
     }
@@ -2066,7 +2278,7 @@ void GCode::gotoXYZFourth(QString line)
         qDebug() << "gotoXYZFourth";
         QString msg(QString(tr("Bad command: %1")).arg(line));
         warn("%s", qPrintable(msg));
-        emit addList(msg);
+        postList(msg);
     }
     // clear 'ui->comboCommand'
     emit setCommandText("");
@@ -2224,7 +2436,7 @@ void GCode::setConfigureMmMode(bool setGrblUnits)
 {
     QString msg ("=> " + tr("GCV use 'mm' but Grbl parser set for 'inches'") + "...");
     QString lastmsg ("<= " + tr("Correction Grbl ended."));
-    emit addList(msg);
+    postList(msg);
    // emit sendMsgSatusBar(msg);
 /// T4   //  sendGcodeLocal("$13=0");
     QString val = getNumGrblUnit();
@@ -2233,7 +2445,7 @@ void GCode::setConfigureMmMode(bool setGrblUnits)
         sendGcodeLocal("G21");
     positionUpdate(true);
 
-    emit addList(lastmsg);
+    postList(lastmsg);
 }
 
 // calls :  'GCode::setResponseWait()';1,
@@ -2242,7 +2454,7 @@ void GCode::setConfigureInchesMode(bool setGrblUnits)
 {
     QString msg ("=> " + tr("GCV use 'inches' but Grbl parser set for 'mm'") + "...");
     QString lastmsg ("<= " + tr("Correction Grbl ended."));
-    emit addList(msg);
+    postList(msg);
   //  emit sendMsgSatusBar(msg);
 /// T4  //  sendGcodeLocal("$13=1");
     QString val = getNumGrblUnit();
@@ -2251,7 +2463,7 @@ void GCode::setConfigureInchesMode(bool setGrblUnits)
         sendGcodeLocal("G20");
     positionUpdate(true);
 
-    emit addList(lastmsg);
+    postList(lastmsg);
 }
 
 void GCode::clearToHome()
@@ -2260,6 +2472,26 @@ void GCode::clearToHome()
     motionOccurred = false;
 }
 
+JobJournal *GCode::getJournal()
+{
+    return &journal;
+}
+
+int GCode::getErrorCount() const
+{
+    return errorCount;
+}
+
+bool GCode::isAborted()
+{
+    return abortState.get();
+}
+
+const Telemetry& GCode::getTelemetry() const
+{
+    return telemetry;
+}
+
 int GCode:: getNumaxis()
 {
 	return numaxis;
@@ -2320,12 +2552,12 @@ bool GCode::sendToPort(const char *buf, QString txt)
     {
         QString msg = tr("Sending to port failed");
         err("%s", qPrintable(msg));
-        emit addList(msg);
+        postList(msg);
         emit sendMsgSatusBar(msg);
         return false;
     }
     else
-        diag("SENDING: '%c'  %s", buf[0], qPrintable(txt));
+        DIAG("SENDING: '%c'  %s", buf[0], qPrintable(txt));
 
     return true;
 }
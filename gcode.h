@@ -22,6 +22,10 @@
 #include "definitions.h"
 #include "coord3d.h"
 #include "controlparams.h"
+#include "telemetry.h"
+#include "jobjournal.h"
+#include "blockcompactor.h"
+#include "streamsource.h"
 
 #define BUF_SIZE 300
 
@@ -80,6 +84,11 @@ public:
     void setShutdown();
     int getSettingsItemCount();
 	int getNumaxis();
+    const Telemetry& getTelemetry() const;
+    JobJournal *getJournal();
+    // result of the last file sent
+    int getErrorCount() const;
+    bool isAborted();
 
     static void trimToEnd(QString& strline, QChar);
 
@@ -87,6 +96,7 @@ signals:
     void addList(QString line);
     void addListFull(QStringList list);
     void addListOut(QString line);
+    void addListChunk(QStringList list);
     void sendMsgSatusBar(QString msg);
     void stopSending();
     void portIsClosed();
@@ -94,26 +104,20 @@ signals:
     void setCommandText(QString value);
     void adjustedAxis();
     void gcodeResult(int id, QString result);
-    void setProgress(int);
-    void setQueuedCommands(int, bool);
     void resetTimer(bool timeIt);
     void enableGrblDialogButton();
-    void updateCoordinates(Coord3D maposReqKindchineCoord, Coord3D workCoord);
     void setLastState(QString state);
-    void setLivePoint(double x, double y, bool isMM, bool isLiveCP);
 /// T4
     void setLivePoint(QVector3D);
-    void setNumLine(QString);
 
-    void setVisCurrLine(int currLine);
     void setLcdState(bool valid);
     void setVisualLivenessCurrPos(bool isLiveCP);
 /// T2
 	void setVersionGrbl(QString versionGrbl );
-/// T3
-    void setLinesFile(QString  nbline, bool check);
 /// T4
     void setUnitMmAll(bool usemm);
+    // X and Y rapid rates from '$$', mm/min
+    void setRapidRates(double x, double y);
 
     void endHomeAxis();
 
@@ -124,6 +128,10 @@ public slots:
     void sendGcodeAndGetResult(int id, QString line);
 ///  T3
     void sendFile(QString path, bool checkfile) ;
+    void sendFileFrom(QString path, bool checkfile, int firstLine, qint64 offset,
+                      int totalLines, QStringList preamble) ;
+    // the next file sent is read while it grows, see 'StreamSource'
+    void setFollowFile(bool follow);
     void gotoXYZFourth(QString line);
     void axisAdj(char axis, float coord, bool inv, bool absoluteAfterAxisAdj, int sliderZCount);
     void setResponseWait(ControlParams controlParams);
@@ -196,6 +204,12 @@ private:
     QByteArray getResult();
 
     void gotoPause();
+    bool readProgramLine(QTextStream& code, StreamSource *stream, QString& line, bool checkfile);
+    void queueList(QString line, bool in);
+    void flushList(bool force);
+    void postList(QString line);
+    void postListOut(QString line);
+    void postListFull(QStringList list);
 
 private:
     QSerialPort *port;
@@ -234,7 +248,17 @@ private:
 /// T4
     int posReqKind;
     QString versionGrbl;
-
+    // progress, position and queue state sampled by the GUI
+    Telemetry telemetry;
+    // status lines waiting to be delivered as one chunk
+    QStringList pendingList;
+    QTime pendingListTimer;
+    // acknowledged lines of the file being sent, survives a crash
+    JobJournal journal;
+    // minimal text of the blocks of the file being sent
+    BlockCompactor compactor;
+    // from 'setFollowFile()', for the next file only
+    bool followFile;
 
 
 };
@@ -0,0 +1,172 @@
+/****************************************************************
+ * gcodelisting.cpp
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#include "gcodelisting.h"
+
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QScrollBar>
+
+GcodeListView::GcodeListView(QWidget *parent)
+    : LineListView(parent),
+      source(NULL), active(0), scheduler(NULL)
+{
+}
+
+void GcodeListView::setFrameScheduler(FrameScheduler *frames)
+{
+    scheduler = frames;
+}
+
+void GcodeListView::setSource(const LineIndex *index)
+{
+    source = index;
+    active = 0;
+    clearSelection();
+
+    int longest = source != NULL ? source->maxLineLength() : 0;
+    setTextWidth(longest * fontMetrics().averageCharWidth());
+
+    verticalScrollBar()->setValue(0);
+    horizontalScrollBar()->setValue(0);
+    updateScrollBars();
+    viewport()->update();
+}
+
+void GcodeListView::clear()
+{
+    setSource(NULL);
+}
+
+// A program larger than the heap limit is read through its mapping : a
+// file changed on the disk since is not read any more, the listing stays
+// empty until the program is loaded again.
+void GcodeListView::paintEvent(QPaintEvent *event)
+{
+    if (source != NULL && !source->isCurrent())
+        setSource(NULL);
+    LineListView::paintEvent(event);
+}
+
+int GcodeListView::rowCount() const
+{
+    return source != NULL ? source->lineCount() : 0;
+}
+
+QString GcodeListView::rowText(int row) const
+{
+    return source->lineText(row);
+}
+
+int GcodeListView::gutterWidth() const
+{
+    int count = rowCount();
+    if (count == 0)
+        return 0;
+
+    return fontMetrics().width(QString::number(count)) + 3*LINE_LIST_MARGIN;
+}
+
+void GcodeListView::paintGutter(QPainter& painter, int row, const QRect& rect)
+{
+    const QPalette& pal = palette();
+    painter.fillRect(rect, pal.window());
+    painter.setPen(row + 1 == active ? pal.color(QPalette::Text) : pal.color(QPalette::Mid));
+    painter.drawText(rect.adjusted(0, 0, -2*LINE_LIST_MARGIN, 0),
+                     Qt::AlignRight | Qt::AlignVCenter, QString::number(row + 1));
+}
+
+void GcodeListView::paintRowBackground(QPainter& painter, int row, const QRect& rect)
+{
+    if (row + 1 == active)
+        painter.fillRect(rect, Qt::lightGray);
+}
+
+int GcodeListView::activeLine() const
+{
+    return active;
+}
+
+// Only the rows of the old and new active line are repainted,
+// whatever the size of the program.
+// calls : 'MainWindow::setActiveLineVisuGcode()':1
+void GcodeListView::setActiveLine(int line)
+{
+    if (line == active || line < 0 || line > rowCount())
+        return;
+
+    int old = active;
+    active = line;
+    if (old > 0)
+        updateRow(old - 1);
+    if (active > 0)
+    {
+        ensureRowVisible(active - 1);
+        updateRow(active - 1);
+    }
+}
+
+void GcodeListView::updateRow(int row)
+{
+    int y = (row - firstVisibleRow()) * rowHeight();
+    if (y + rowHeight() < 0 || y > viewport()->height())
+        return;
+    QRect rect(0, y, viewport()->width(), rowHeight());
+    if (scheduler != NULL)
+        scheduler->invalidate(viewport(), rect);
+    else
+        viewport()->update(rect);
+}
+
+void GcodeListView::activate(int line)
+{
+    line = qBound(1, line, rowCount());
+    if (line == active)
+        return;
+
+    setActiveLine(line);
+    emit lineActivated(line);
+}
+
+void GcodeListView::mousePressEvent(QMouseEvent *event)
+{
+    LineListView::mousePressEvent(event);
+
+    if (event->button() == Qt::LeftButton && !(event->modifiers() & Qt::ShiftModifier))
+    {
+        int row = rowAt(event->pos().y());
+        if (row >= 0)
+            activate(row + 1);
+    }
+}
+
+void GcodeListView::keyPressEvent(QKeyEvent *event)
+{
+    if (rowCount() == 0)
+    {
+        LineListView::keyPressEvent(event);
+        return;
+    }
+
+    if (event->matches(QKeySequence::MoveToPreviousLine))
+        activate(active - 1);
+    else if (event->matches(QKeySequence::MoveToNextLine))
+        activate(active + 1);
+    else if (event->matches(QKeySequence::MoveToPreviousPage))
+        activate(active - visibleRows());
+    else if (event->matches(QKeySequence::MoveToNextPage))
+        activate(active + visibleRows());
+    else if (event->matches(QKeySequence::MoveToStartOfDocument))
+        activate(1);
+    else if (event->matches(QKeySequence::MoveToEndOfDocument))
+        activate(rowCount());
+    else
+        LineListView::keyPressEvent(event);
+}
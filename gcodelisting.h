@@ -0,0 +1,61 @@
+/****************************************************************
+ * gcodelisting.h
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#ifndef GCODELISTING_H
+#define GCODELISTING_H
+
+#include "linelistview.h"
+#include "lineindex.h"
+#include "framescheduler.h"
+
+// Listing of the loaded program read from its line index, with line
+// numbers in a gutter and the active line painted over the text.
+class GcodeListView : public LineListView
+{
+    Q_OBJECT
+
+public:
+    explicit GcodeListView(QWidget *parent = 0);
+
+    // the index must stay valid until the next call, 0 to detach
+    void setSource(const LineIndex *index);
+    // rows of the active line are repainted at its frames, 0 for at once
+    void setFrameScheduler(FrameScheduler *frames);
+    // 1 based, 0 : none
+    int activeLine() const;
+
+signals:
+    // the user moved the active line with the mouse or the keyboard
+    void lineActivated(int line);
+
+public slots:
+    void setActiveLine(int line);
+    void clear();
+
+protected:
+    int rowCount() const;
+    QString rowText(int row) const;
+    int gutterWidth() const;
+    void paintGutter(QPainter& painter, int row, const QRect& rect);
+    void paintRowBackground(QPainter& painter, int row, const QRect& rect);
+    void paintEvent(QPaintEvent *event);
+    void mousePressEvent(QMouseEvent *event);
+    void keyPressEvent(QKeyEvent *event);
+
+private:
+    void activate(int line);
+    void updateRow(int row);
+
+private:
+    const LineIndex *source;
+    int active;
+    FrameScheduler *scheduler;
+};
+
+#endif // GCODELISTING_H
@@ -0,0 +1,165 @@
+/****************************************************************
+ * headless.cpp
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#include "headless.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QSettings>
+#include <cstdio>
+
+#include "machinemanager.h"
+
+HeadlessRunner::HeadlessRunner(const QString& p, const QString& baud,
+                               const QString& f, bool c, bool fl,
+                               int prebufferLines, QObject *parent)
+    : QObject(parent),
+      port(p), baudRate(baud), file(f), check(c), follow(fl),
+      portOpen(false), finished(false), lastProgress(-1), lastBytes(-1),
+      out(stdout), errout(stderr)
+{
+    // same options as the GUI
+    QSettings settings;
+    ControlParams controlParams;
+    controlParams.load(settings);
+    if (prebufferLines > 0)
+        controlParams.streamPrebufferLines = prebufferLines;
+
+    QString name = port;
+    name.replace(QRegExp("[^A-Za-z0-9]"), "_");
+    gcode.getJournal()->open(QDir::homePath() + QString(MACHINE_JOURNAL_FILE).arg(name));
+    journalSync.addJournal(gcode.getJournal());
+
+    gcode.moveToThread(&gcodeThread);
+    journalSync.moveToThread(&journalSyncThread);
+
+    connect(this, SIGNAL(openPort(QString,QString)), &gcode, SLOT(openPort(QString,QString)));
+    connect(this, SIGNAL(sendFile(QString,bool)), &gcode, SLOT(sendFile(QString,bool)));
+    connect(&gcode, SIGNAL(portIsOpen(bool)), this, SLOT(portOpened(bool)));
+    connect(&gcode, SIGNAL(portIsClosed()), this, SLOT(portClosed()));
+    connect(&gcode, SIGNAL(stopSending()), this, SLOT(sendingStopped()));
+    connect(&gcode, SIGNAL(addList(QString)), this, SLOT(printMessage(QString)));
+    connect(&gcode, SIGNAL(addListFull(QStringList)), this, SLOT(printMessages(QStringList)));
+    // Grbl responses and errors come in the chunks of 'GCode::flushList()'
+    connect(&gcode, SIGNAL(addListChunk(QStringList)), this, SLOT(printMessages(QStringList)));
+    connect(&progressTimer, SIGNAL(timeout()), this, SLOT(printProgress()));
+
+    journalSyncThread.start();
+    gcodeThread.start();
+
+    QMetaObject::invokeMethod(&gcode, "setResponseWait", Qt::QueuedConnection,
+                              Q_ARG(ControlParams, controlParams));
+}
+
+HeadlessRunner::~HeadlessRunner()
+{
+    gcode.setShutdown();
+    gcode.setAbort();
+    gcodeThread.quit();
+    gcodeThread.wait();
+    journalSyncThread.quit();
+    journalSyncThread.wait();
+}
+
+// calls : 'main()':1
+void HeadlessRunner::start()
+{
+    // a followed file may be created after the start
+    if (!follow && !StreamSource::isStream(file) && !QFile::exists(file))
+    {
+        errout << tr("Can't open file %1").arg(file) << endl;
+        finish(HEADLESS_EXIT_BAD_ARGS);
+        return;
+    }
+    emit openPort(port, baudRate);
+}
+
+void HeadlessRunner::portOpened(bool)
+{
+    portOpen = true;
+    elapsed.start();
+    progressTimer.start(HEADLESS_PROGRESS_MSEC);
+    // '$C' toggles the check mode of Grbl, queued before the file
+    if (check)
+        QMetaObject::invokeMethod(&gcode, "sendGrblCheck", Qt::QueuedConnection, Q_ARG(bool, true));
+    if (follow)
+        QMetaObject::invokeMethod(&gcode, "setFollowFile", Qt::QueuedConnection, Q_ARG(bool, true));
+    emit sendFile(file, check);
+}
+
+// only reached without 'portOpened()' when the port can't be opened
+void HeadlessRunner::portClosed()
+{
+    if (!portOpen)
+        finish(HEADLESS_EXIT_PORT_FAILED);
+}
+
+void HeadlessRunner::sendingStopped()
+{
+    printProgress();
+
+    if (gcode.isAborted())
+        finish(HEADLESS_EXIT_INTERRUPTED);
+    else if (gcode.getErrorCount() > 0)
+        finish(HEADLESS_EXIT_GRBL_ERRORS);
+    else
+        finish(HEADLESS_EXIT_OK);
+}
+
+void HeadlessRunner::printMessage(QString line)
+{
+    errout << line << endl;
+}
+
+void HeadlessRunner::printMessages(QStringList list)
+{
+    foreach (const QString& line, list)
+        errout << line << endl;
+}
+
+// one line each time the percentage changes, easy to parse by a scheduler,
+// bytes and seconds for a stream whose size is unknown
+void HeadlessRunner::printProgress()
+{
+    TelemetrySnapshot snap;
+    gcode.getTelemetry().read(snap);
+    if (snap.totalLines == 0 && snap.running)
+    {
+        if (snap.bytesSent == lastBytes)
+            return;
+
+        lastBytes = snap.bytesSent;
+        out << QString("streamed %1 bytes line %2 time %3s").arg(snap.bytesSent).arg(snap.currLine)
+               .arg(elapsed.elapsed() / 1000) << endl;
+        return;
+    }
+    if (snap.progress == lastProgress)
+        return;
+
+    lastProgress = snap.progress;
+    out << QString("progress %1% line %2/%3").arg(snap.progress).arg(snap.currLine).arg(snap.totalLines)
+        << endl;
+}
+
+void HeadlessRunner::finish(int code)
+{
+    if (finished)
+        return;
+    finished = true;
+
+    progressTimer.stop();
+    if (portOpen)
+    {
+        if (check)
+            QMetaObject::invokeMethod(&gcode, "sendGrblCheck", Qt::BlockingQueuedConnection, Q_ARG(bool, false));
+        QMetaObject::invokeMethod(&gcode, "closePort", Qt::BlockingQueuedConnection);
+    }
+
+    QCoreApplication::exit(code);
+}
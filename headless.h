@@ -0,0 +1,89 @@
+/****************************************************************
+ * headless.h
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QTextStream>
+
+#include "gcode.h"
+
+// how often progress is printed on stdout
+#define HEADLESS_PROGRESS_MSEC      1000
+
+// exit codes of 'GrblController --stream'
+enum
+{
+    HEADLESS_EXIT_OK = 0,
+    HEADLESS_EXIT_BAD_ARGS,
+    HEADLESS_EXIT_PORT_FAILED,
+    HEADLESS_EXIT_INTERRUPTED,
+    HEADLESS_EXIT_GRBL_ERRORS
+};
+
+// Streams one file with the 'GCode' engine, without any widget:
+// progress on stdout, messages on stderr, the result as the exit code.
+class HeadlessRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 'prebufferLines' 0 keeps the value of the options dialog
+    HeadlessRunner(const QString& port, const QString& baudRate,
+                   const QString& file, bool check, bool follow,
+                   int prebufferLines, QObject *parent = 0);
+    ~HeadlessRunner();
+
+signals:
+    void openPort(QString commPortStr, QString baudRate);
+    void sendFile(QString path, bool checkfile);
+
+public slots:
+    void start();
+
+private slots:
+    void portOpened(bool);
+    void portClosed();
+    void sendingStopped();
+    void printMessage(QString line);
+    void printMessages(QStringList list);
+    void printProgress();
+
+private:
+    void finish(int code);
+
+private:
+    GCode gcode;
+    QThread gcodeThread;
+    JournalSync journalSync;
+    QThread journalSyncThread;
+    QTimer progressTimer;
+
+    QString port;
+    QString baudRate;
+    QString file;
+    bool check;
+    // the file is still written by its producer
+    bool follow;
+    bool portOpen;
+    bool finished;
+    int lastProgress;
+    // of a stream, without a number of lines
+    qint64 lastBytes;
+    QElapsedTimer elapsed;
+
+    QTextStream out;
+    QTextStream errout;
+};
+
+#endif // HEADLESS_H
@@ -0,0 +1,208 @@
+/****************************************************************
+ * jobjournal.cpp
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#include "jobjournal.h"
+
+#include <cstring>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#include "definitions.h"
+
+JobJournal::JobJournal()
+    : rec(NULL), dirty(0)
+{
+}
+
+JobJournal::~JobJournal()
+{
+    if (rec != NULL)
+    {
+        sync();
+        file.unmap((uchar *)rec);
+    }
+}
+
+bool JobJournal::open(const QString& path)
+{
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadWrite))
+    {
+        warn(qPrintable(QObject::tr("Can't open the job journal '%s'")), qPrintable(path));
+        return false;
+    }
+
+    bool fresh = file.size() != (qint64)sizeof(JournalRecord);
+    if (fresh && !file.resize(sizeof(JournalRecord)))
+        return false;
+
+    rec = (JournalRecord *)file.map(0, sizeof(JournalRecord));
+    if (rec == NULL)
+    {
+        warn(qPrintable(QObject::tr("Can't map the job journal '%s'")), qPrintable(path));
+        return false;
+    }
+
+    if (fresh || rec->magic != JOURNAL_MAGIC || rec->version != JOURNAL_VERSION)
+    {
+        memset(rec, 0, sizeof(JournalRecord));
+        rec->magic = JOURNAL_MAGIC;
+        rec->version = JOURNAL_VERSION;
+        dirty.fetchAndStoreOrdered(1);
+    }
+    return true;
+}
+
+bool JobJournal::isOpen() const
+{
+    return rec != NULL;
+}
+
+bool JobJournal::interrupted() const
+{
+    return rec != NULL && rec->running && rec->pathSize > 0;
+}
+
+QString JobJournal::jobFile() const
+{
+    if (rec == NULL)
+        return QString();
+    return QString::fromUtf8(rec->path, qBound(0, (int)rec->pathSize, JOURNAL_PATH_SIZE));
+}
+
+int JobJournal::ackedLine() const
+{
+    return rec != NULL ? rec->ackedLine : 0;
+}
+
+// Grbl answers 'ok' once a block is planned, not executed : the blocks
+// still in its buffer when the host stopped were lost with it.
+// calls : 'MainWindow::recoverInterruptedJob()':1, 'MachineDashboard::recoverInterruptedJob()':1
+int JobJournal::resumeLine() const
+{
+    return qMax(1, ackedLine() - JOURNAL_PLANNER_BLOCKS + 1);
+}
+
+int JobJournal::totalLines() const
+{
+    return rec != NULL ? rec->totalLines : 0;
+}
+
+Coord3D JobJournal::workPosition() const
+{
+    Coord3D work;
+    if (rec != NULL)
+    {
+        work.x = rec->work[0];
+        work.y = rec->work[1];
+        work.z = rec->work[2];
+        work.fourth = rec->work[3];
+    }
+    return work;
+}
+
+// calls : 'GCode::sendFileFrom()':1
+void JobJournal::begin(const QString& name, int firstLine, int totalLines)
+{
+    if (rec == NULL)
+        return;
+
+    QByteArray path = name.toUtf8().left(JOURNAL_PATH_SIZE);
+    memcpy(rec->path, path.constData(), path.size());
+    rec->pathSize = path.size();
+    rec->totalLines = totalLines;
+    rec->ackedLine = firstLine - 1;
+    rec->running = 1;
+    dirty.fetchAndStoreOrdered(1);
+}
+
+// line of the file acknowledged by Grbl, it may still be in the planner
+void JobJournal::ack(int line)
+{
+    if (rec == NULL || line <= rec->ackedLine)
+        return;
+
+    rec->ackedLine = line;
+    dirty.fetchAndStoreOrdered(1);
+}
+
+void JobJournal::position(const Coord3D& machine, const Coord3D& work, bool mm)
+{
+    if (rec == NULL || !rec->running)
+        return;
+
+    rec->machine[0] = machine.x;
+    rec->machine[1] = machine.y;
+    rec->machine[2] = machine.z;
+    rec->machine[3] = machine.fourth;
+    rec->work[0] = work.x;
+    rec->work[1] = work.y;
+    rec->work[2] = work.z;
+    rec->work[3] = work.fourth;
+    rec->useMm = mm;
+    dirty.fetchAndStoreOrdered(1);
+}
+
+void JobJournal::finish()
+{
+    if (rec == NULL)
+        return;
+
+    rec->running = 0;
+    dirty.fetchAndStoreOrdered(1);
+    // the end of a job is written at once
+    sync();
+}
+
+// only the changes since the last call reach the disk
+// calls : 'JournalSync::timerEvent()':1, 'JobJournal::finish()':1
+void JobJournal::sync()
+{
+    if (rec == NULL || !dirty.testAndSetOrdered(1, 0))
+        return;
+
+#ifdef Q_OS_WIN
+    FlushViewOfFile(rec, sizeof(JournalRecord));
+#else
+    msync(rec, sizeof(JournalRecord), MS_SYNC);
+#endif
+}
+
+///-----------------------------------------------------------------------------
+JournalSync::JournalSync(QObject *parent)
+    : QObject(parent)
+{
+    startTimer(JOURNAL_SYNC_MSEC);
+}
+
+void JournalSync::addJournal(JobJournal *j)
+{
+    QMutexLocker locker(&mutex);
+    if (!journals.contains(j))
+        journals.append(j);
+}
+
+void JournalSync::removeJournal(JobJournal *j)
+{
+    QMutexLocker locker(&mutex);
+    journals.removeAll(j);
+}
+
+void JournalSync::timerEvent(QTimerEvent *event)
+{
+    Q_UNUSED(event);
+
+    QMutexLocker locker(&mutex);
+    foreach (JobJournal *journal, journals)
+        journal->sync();
+}
@@ -0,0 +1,109 @@
+/****************************************************************
+ * jobjournal.h
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#ifndef JOBJOURNAL_H
+#define JOBJOURNAL_H
+
+#include <QObject>
+#include <QFile>
+#include <QAtomicInt>
+#include <QList>
+#include <QMutex>
+
+#include "coord3d.h"
+
+// journal of the file being sent, in the home directory
+#define JOURNAL_FILE            "/GrblController-job.journal"
+#define JOURNAL_MAGIC           0x4A424347  // "GCBJ"
+#define JOURNAL_VERSION         1
+#define JOURNAL_PATH_SIZE       1024
+// how often the mapped record is written back to the disk
+#define JOURNAL_SYNC_MSEC       250
+// blocks acknowledged by Grbl that may not have run yet : its planner
+// buffer holds 18 blocks in 0.8, 16 in 0.9 on an ATmega328p
+#define JOURNAL_PLANNER_BLOCKS  18
+
+// Layout of the mapped file, only plain values
+struct JournalRecord
+{
+    quint32 magic;
+    quint32 version;
+    qint32 running;
+    qint32 totalLines;
+    qint32 ackedLine;
+    qint32 useMm;
+    double machine[4];
+    double work[4];
+    qint32 pathSize;
+    char path[JOURNAL_PATH_SIZE];
+};
+
+// Progress of a file send kept in a small memory mapped file. The sender
+// only stores values in memory; 'JournalSync' writes them back to the disk
+// from its own thread, so the serial path never waits on the disk.
+// A record still 'running' when the application starts is a job that
+// was interrupted by a crash, a sleep or a lost port.
+class JobJournal
+{
+public:
+    JobJournal();
+    ~JobJournal();
+
+    // the content of an existing journal is kept
+    bool open(const QString& path);
+    bool isOpen() const;
+
+    bool interrupted() const;
+    QString jobFile() const;
+    int ackedLine() const;
+    // first line that may not have run, 'JOURNAL_PLANNER_BLOCKS' before
+    // the last one acknowledged
+    int resumeLine() const;
+    int totalLines() const;
+    Coord3D workPosition() const;
+
+    // writer side, called by 'GCode'
+    void begin(const QString& file, int firstLine, int totalLines);
+    void ack(int line);
+    void position(const Coord3D& machine, const Coord3D& work, bool mm);
+    void finish();
+
+    // any thread
+    void sync();
+
+private:
+    Q_DISABLE_COPY(JobJournal)
+
+private:
+    QFile file;
+    JournalRecord *rec;
+    QAtomicInt dirty;
+};
+
+// Writes journals back to the disk every 'JOURNAL_SYNC_MSEC',
+// lives in its own thread like 'Timer'
+class JournalSync : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit JournalSync(QObject *parent = 0);
+    // any thread
+    void addJournal(JobJournal *j);
+    void removeJournal(JobJournal *j);
+
+protected:
+    void timerEvent(QTimerEvent *event);
+
+private:
+    QMutex mutex;
+    QList<JobJournal *> journals;
+};
+
+#endif // JOBJOURNAL_H
@@ -0,0 +1,449 @@
+/****************************************************************
+ * joblibrary.cpp
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#include "joblibrary.h"
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QHash>
+#include <QImage>
+#include <QLineF>
+#include <QPainter>
+#include <QRegExp>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include "gcode.h"
+#include "motiontimeline.h"
+#include "programanalyzer.h"
+#include "visu3D/Arc3D.h"
+
+#define LIBRARY_INDEX_MAGIC     0x4743564cu     // "GCVL"
+// lines given to the painter at once
+#define LIBRARY_DRAW_BATCH      4096
+
+namespace
+{
+    // receives the moves of a program as straight segments
+    class MoveVisitor
+    {
+    public:
+        virtual ~MoveVisitor() {}
+        virtual void segment(const QVector3D& a, const QVector3D& b, int line, bool rapid) = 0;
+    };
+
+    // extents and machining time
+    class Survey : public MoveVisitor
+    {
+    public:
+        Survey(const ModalTimeline& m) : modal(m), count(0), duration(0) {}
+
+        void segment(const QVector3D& a, const QVector3D& b, int line, bool rapid)
+        {
+            if (count == 0)
+                lo = hi = b;
+            lo = QVector3D(qMin(lo.x(), b.x()), qMin(lo.y(), b.y()), qMin(lo.z(), b.z()));
+            hi = QVector3D(qMax(hi.x(), b.x()), qMax(hi.y(), b.y()), qMax(hi.z(), b.z()));
+            count++;
+
+            // as 'Viewer::Scene()' fills its 'MotionTimeline'
+            ModalState state = modal.at(line);
+            double rate = state.feedrate;
+            if (rapid || rate <= 0)
+                rate = state.mm ? MOTION_RAPID_DEFAULT : MOTION_RAPID_DEFAULT / MM_IN_AN_INCH;
+            duration += (b - a).length() / (rate / 60.0);
+        }
+
+    public:
+        const ModalTimeline& modal;
+        qint64 count;
+        QVector3D lo, hi;
+        double duration;
+    };
+
+    // top view in the colors of 'Viewer', drawn in batches of lines
+    class Raster : public MoveVisitor
+    {
+    public:
+        Raster(QImage& image, const QVector3D& lo, const QVector3D& hi)
+            : painter(&image)
+        {
+            double w = image.width() - 2 * LIBRARY_THUMB_MARGIN;
+            double h = image.height() - 2 * LIBRARY_THUMB_MARGIN;
+            double dx = qMax((double)(hi.x() - lo.x()), 1e-6);
+            double dy = qMax((double)(hi.y() - lo.y()), 1e-6);
+            scale = qMin(w / dx, h / dy);
+            // centered, Y up
+            x0 = LIBRARY_THUMB_MARGIN + (w - dx * scale) / 2 - lo.x() * scale;
+            y0 = LIBRARY_THUMB_MARGIN + (h + dy * scale) / 2 + lo.y() * scale;
+
+            painter.setRenderHint(QPainter::Antialiasing);
+        }
+
+        ~Raster()
+        {
+            flush(rapids, Qt::magenta);
+            flush(feeds, Qt::darkBlue);
+        }
+
+        void segment(const QVector3D& a, const QVector3D& b, int line, bool rapid)
+        {
+            Q_UNUSED(line);
+            QVector<QLineF>& lines = rapid ? rapids : feeds;
+            lines.append(QLineF(x0 + a.x() * scale, y0 - a.y() * scale,
+                                x0 + b.x() * scale, y0 - b.y() * scale));
+            if (lines.size() >= LIBRARY_DRAW_BATCH)
+                flush(lines, rapid ? Qt::magenta : Qt::darkBlue);
+        }
+
+    private:
+        void flush(QVector<QLineF>& lines, const QColor& color)
+        {
+            painter.setPen(QPen(color, 0));
+            painter.drawLines(lines);
+            lines.clear();
+        }
+
+    private:
+        QPainter painter;
+        double scale, x0, y0;
+        QVector<QLineF> rapids, feeds;
+    };
+
+    // moves of 'analysis', arcs interpolated as 'ToolpathStore' keeps them
+    void walkMoves(ProgramAnalysis& analysis, MoveVisitor& visitor)
+    {
+        if (!analysis.store.isNull())
+        {
+            // segments of each tile, in any order of the tiles
+            ToolpathStore& store = *analysis.store;
+            for (int n = 0; n < store.pageCount(); n++)
+            {
+                const QVector<ToolpathSegment> *segments = store.segments(n);
+                if (segments == NULL)
+                    continue;
+                foreach (const ToolpathSegment& s, *segments)
+                    visitor.segment(QVector3D(s.a[0], s.a[1], s.a[2]),
+                                    QVector3D(s.b[0], s.b[1], s.b[2]), s.line, s.g == 0);
+            }
+            return;
+        }
+
+        if (analysis.posList.isEmpty())
+            return;
+        // from the first position, as 'Viewer::Scene()'
+        const PosItem& first = analysis.posList.first();
+        QVector3D plast(first.x, first.y, first.z);
+        QList<QVector3D> points;
+        foreach (const PosItem& item, analysis.posList)
+        {
+            if (item.g < 0 || item.g > 3)
+                continue;
+            QVector3D xyz(item.x, item.y, item.z);
+            points.clear();
+            if (item.g == 2 || item.g == 3)
+            {
+                Arc3D curve(item.plane, item.cw, plast, xyz, QVector3D(item.i, item.j, item.k), 2, item.helix);
+                curve.interpolateAng(item.mm ? TOOLPATH_ARC_TOL_MM : TOOLPATH_ARC_TOL_MM / MM_IN_AN_INCH, points);
+            }
+            if (points.isEmpty() || points.last() != xyz)
+                points.append(xyz);
+            QVector3D a = plast;
+            foreach (const QVector3D& b, points)
+            {
+                visitor.segment(a, b, item.index, item.g == 0);
+                a = b;
+            }
+            plast = xyz;
+        }
+    }
+
+    // numbers of the T words outside of the comments
+    QList<int> toolsOf(const LineIndex& index)
+    {
+        QList<int> tools;
+        QRegExp word("T\\s*(\\d+)");
+        for (int row = 0; row < index.lineCount(); row++)
+        {
+            QByteArray bytes = index.lineBytes(row);
+            if (bytes.indexOf('T') < 0 && bytes.indexOf('t') < 0)
+                continue;
+
+            QString line = QString::fromLatin1(bytes);
+            GCode::trimToEnd(line, '(');
+            GCode::trimToEnd(line, ';');
+            line = line.toUpper();
+            int pos = 0;
+            while ((pos = word.indexIn(line, pos)) != -1)
+            {
+                int tool = word.cap(1).toInt();
+                if (!tools.contains(tool))
+                    tools.append(tool);
+                pos += word.matchedLength();
+            }
+        }
+        return tools;
+    }
+}
+
+LibraryEntry::LibraryEntry()
+    : fileSize(0), valid(false), mm(true), lineCount(0), duration(0)
+{
+}
+
+bool LibraryEntry::isCurrent(const QFileInfo& info) const
+{
+    return info.size() == fileSize && info.lastModified() == fileModified;
+}
+
+JobLibrary::JobLibrary(QObject *parent)
+    : QObject(parent), inMemoryLimit((qint64)TOOLPATH_DEFAULT_LIMIT_MB << 20)
+{
+    connect(&watcher, SIGNAL(resultReadyAt(int)), this, SLOT(entryReady(int)));
+    connect(&watcher, SIGNAL(finished()), this, SLOT(scanDone()));
+}
+
+JobLibrary::~JobLibrary()
+{
+    stopScan();
+}
+
+QString JobLibrary::directory() const
+{
+    return dir;
+}
+
+// calls : 'JobLibraryDialog::chooseDirectory()':1, 'JobLibraryDialog::JobLibraryDialog()':1
+void JobLibrary::setDirectory(const QString& path)
+{
+    stopScan();
+    dir = path;
+    entries.clear();
+    loadIndex();
+    rescan();
+}
+
+// The entries of the files with the same size and date are kept, the
+// others are given to the worker pool and shown as they are read.
+void JobLibrary::rescan()
+{
+    stopScan();
+
+    QHash<QString, LibraryEntry> known;
+    foreach (const LibraryEntry& e, entries)
+        known.insert(e.fileName, e);
+
+    entries.clear();
+    scanning.clear();
+    pending.clear();
+    QFileInfoList files = QDir(dir).entryInfoList(QString(LIBRARY_NAME_FILTERS).split(' '),
+                                                  QDir::Files, QDir::Name);
+    foreach (const QFileInfo& info, files)
+    {
+        LibraryEntry e = known.value(info.fileName());
+        if (e.fileName.isEmpty() || !e.isCurrent(info))
+        {
+            e = LibraryEntry();
+            e.fileName = info.fileName();
+            e.fileSize = info.size();
+            e.fileModified = info.lastModified();
+            scanning.append(e.fileName);
+            pending.insert(e.fileName);
+        }
+        entries.append(e);
+    }
+    emit reset();
+
+    if (scanning.isEmpty())
+    {
+        // files removed since the index was written
+        if (known.size() != entries.size())
+            saveIndex();
+        emit scanFinished();
+        return;
+    }
+
+    emit progress(0, scanning.size());
+    watcher.setFuture(QtConcurrent::mapped(scanning, Cataloger(dir, inMemoryLimit)));
+}
+
+bool JobLibrary::isScanning() const
+{
+    return watcher.isRunning();
+}
+
+// the programs already read are kept in the index
+void JobLibrary::stopScan()
+{
+    if (!watcher.isRunning())
+        return;
+    watcher.cancel();
+    watcher.waitForFinished();
+    saveIndex();
+}
+
+int JobLibrary::count() const
+{
+    return entries.size();
+}
+
+const LibraryEntry& JobLibrary::entry(int n) const
+{
+    return entries.at(n);
+}
+
+QString JobLibrary::filePath(int n) const
+{
+    return QDir(dir).filePath(entries.at(n).fileName);
+}
+
+void JobLibrary::setInMemoryLimit(qint64 bytes)
+{
+    inMemoryLimit = bytes;
+}
+
+void JobLibrary::entryReady(int n)
+{
+    LibraryEntry e = watcher.resultAt(n);
+    pending.remove(e.fileName);
+    for (int row = 0; row < entries.size(); row++)
+    {
+        if (entries.at(row).fileName == e.fileName)
+        {
+            entries[row] = e;
+            emit entryChanged(row);
+            break;
+        }
+    }
+    emit progress(scanning.size() - pending.size(), scanning.size());
+}
+
+void JobLibrary::scanDone()
+{
+    if (watcher.isCanceled())
+        return;
+    saveIndex();
+    emit scanFinished();
+}
+
+LibraryEntry JobLibrary::Cataloger::operator()(const QString& fileName) const
+{
+    return catalog(QDir(dir).filePath(fileName), limit);
+}
+
+// The moves come from 'ProgramAnalyzer::analyze()', from its parse cache
+// when the program was opened before, and are walked twice : once for
+// the extents and the time, once more to draw them at the scale of the
+// extents.
+LibraryEntry JobLibrary::catalog(const QString& path, qint64 memoryLimit)
+{
+    QFileInfo info(path);
+    LibraryEntry e;
+    e.fileName = info.fileName();
+    e.fileSize = info.size();
+    e.fileModified = info.lastModified();
+
+    ProgramAnalysis analysis = ProgramAnalyzer::analyze(path, memoryLimit);
+    if (!analysis.valid || analysis.index.isNull() || !analysis.index->isOpen())
+        return e;
+
+    e.mm = analysis.mm;
+    e.lineCount = analysis.lineCount;
+    e.tools = toolsOf(*analysis.index);
+
+    Survey survey(analysis.modalTimeline);
+    walkMoves(analysis, survey);
+    e.lo = survey.lo;
+    e.hi = survey.hi;
+    e.duration = survey.duration;
+
+    QImage image(LIBRARY_THUMB_WIDTH, LIBRARY_THUMB_HEIGHT, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::white);
+    if (survey.count > 0)
+    {
+        Raster raster(image, survey.lo, survey.hi);
+        walkMoves(analysis, raster);
+    }
+    QBuffer png(&e.thumbnail);
+    png.open(QIODevice::WriteOnly);
+    image.save(&png, "PNG");
+
+    e.valid = true;
+    return e;
+}
+
+// one file per directory, named after the hash of its path
+QString JobLibrary::indexFile() const
+{
+    QByteArray key = QCryptographicHash::hash(QDir(dir).absolutePath().toUtf8(),
+                                              QCryptographicHash::Sha1);
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/library/"
+           + QString::fromLatin1(key.toHex()) + LIBRARY_INDEX_SUFFIX;
+}
+
+void JobLibrary::loadIndex()
+{
+    QFile file(indexFile());
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+    quint32 magic, version;
+    QString path;
+    qint32 size;
+    in >> magic >> version >> path >> size;
+    if (magic != LIBRARY_INDEX_MAGIC || version != LIBRARY_INDEX_VERSION
+        || path != QDir(dir).absolutePath() || size < 0)
+        return;
+
+    QList<LibraryEntry> read;
+    for (int n = 0; n < size && in.status() == QDataStream::Ok; n++)
+    {
+        LibraryEntry e;
+        qint32 lines;
+        in >> e.fileName >> e.fileSize >> e.fileModified >> e.valid >> e.mm >> lines
+           >> e.lo >> e.hi >> e.duration >> e.tools >> e.thumbnail;
+        e.lineCount = lines;
+        read.append(e);
+    }
+    // a truncated index is read again from the programs
+    if (in.status() == QDataStream::Ok)
+        entries = read;
+}
+
+// written atomically, without the entries still to be read
+void JobLibrary::saveIndex()
+{
+    if (dir.isEmpty())
+        return;
+    QString path = indexFile();
+    if (!QDir().mkpath(QFileInfo(path).absolutePath()))
+        return;
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << (quint32)LIBRARY_INDEX_MAGIC << (quint32)LIBRARY_INDEX_VERSION
+        << QDir(dir).absolutePath() << (qint32)(entries.size() - pending.size());
+    foreach (const LibraryEntry& e, entries)
+    {
+        if (pending.contains(e.fileName))
+            continue;
+        out << e.fileName << e.fileSize << e.fileModified << e.valid << e.mm << (qint32)e.lineCount
+            << e.lo << e.hi << e.duration << e.tools << e.thumbnail;
+    }
+    file.commit();
+}
@@ -0,0 +1,132 @@
+/****************************************************************
+ * joblibrary.h
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#ifndef JOBLIBRARY_H
+#define JOBLIBRARY_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector3D>
+
+// bumped each time the layout of an index file changes
+#define LIBRARY_INDEX_VERSION   1
+#define LIBRARY_INDEX_SUFFIX    ".index"
+// size of the top view of a program, pixels
+#define LIBRARY_THUMB_WIDTH     160
+#define LIBRARY_THUMB_HEIGHT    120
+#define LIBRARY_THUMB_MARGIN    6
+// programs shown by the library
+#define LIBRARY_NAME_FILTERS    "*.nc *.ngc *.gcode *.tap *.nc.gz *.nc.zst"
+
+// What the library shows of one program of its directory
+class LibraryEntry
+{
+public:
+    LibraryEntry();
+
+    // false when the file changed on the disk since the entry was made
+    bool isCurrent(const QFileInfo& info) const;
+
+public:
+    QString fileName;
+    qint64 fileSize;
+    QDateTime fileModified;
+    // false until a worker read the program, or when it can't be read
+    bool valid;
+    bool mm;
+    int lineCount;
+    // positions reached by the moves, in the units of the program
+    QVector3D lo, hi;
+    // seconds, G0 and moves without feed rate at the default rapid rate
+    double duration;
+    // T words, in the order of the program
+    QList<int> tools;
+    // top view, PNG
+    QByteArray thumbnail;
+};
+
+// The programs of a directory with their extents, estimated time, tools
+// and a top view rasterized without any GL context. Entries are kept in
+// an index file per directory in the user cache directory : a program
+// is read again by the worker pool only when its size or date changed,
+// so a directory scanned once opens at once.
+class JobLibrary : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit JobLibrary(QObject *parent = 0);
+    ~JobLibrary();
+
+    QString directory() const;
+    // shows the index of 'path' then reads the new and changed programs
+    void setDirectory(const QString& path);
+    bool isScanning() const;
+
+    int count() const;
+    const LibraryEntry& entry(int n) const;
+    QString filePath(int n) const;
+    // see 'ProgramAnalyzer::analyze()', for the next scans
+    void setInMemoryLimit(qint64 bytes);
+
+    // reads one program, on a worker thread
+    static LibraryEntry catalog(const QString& path, qint64 memoryLimit);
+
+public slots:
+    // reads the programs added or changed since the last scan
+    void rescan();
+
+signals:
+    // the list of entries was replaced
+    void reset();
+    void entryChanged(int n);
+    void progress(int done, int total);
+    void scanFinished();
+
+private slots:
+    void entryReady(int n);
+    void scanDone();
+
+private:
+    void stopScan();
+    void loadIndex();
+    void saveIndex();
+    QString indexFile() const;
+
+private:
+    // 'QtConcurrent::mapped()' functor
+    class Cataloger
+    {
+    public:
+        typedef LibraryEntry result_type;
+        Cataloger(const QString& d, qint64 l) : dir(d), limit(l) {}
+        LibraryEntry operator()(const QString& fileName) const;
+    private:
+        QString dir;
+        qint64 limit;
+    };
+
+    QString dir;
+    QList<LibraryEntry> entries;
+    // file names read by the workers, in the order of the results
+    QStringList scanning;
+    // entries of 'scanning' not read yet, left out of the index
+    QSet<QString> pending;
+    QFutureWatcher<LibraryEntry> watcher;
+    qint64 inMemoryLimit;
+};
+
+#endif // JOBLIBRARY_H
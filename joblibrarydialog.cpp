@@ -0,0 +1,199 @@
+/****************************************************************
+ * joblibrarydialog.cpp
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#include "joblibrarydialog.h"
+
+#include <QBoxLayout>
+#include <QFileDialog>
+#include <QSettings>
+
+#include "options.h"
+
+JobLibraryDialog::JobLibraryDialog(JobLibrary *l, QWidget *parent)
+    : QDialog(parent), library(l),
+      blank(LIBRARY_THUMB_WIDTH, LIBRARY_THUMB_HEIGHT)
+{
+    setWindowTitle(tr("Job Library"));
+    blank.fill(Qt::lightGray);
+
+    editDirectory = new QLineEdit(this);
+    editDirectory->setReadOnly(true);
+    btnBrowse = new QPushButton(tr("Directory..."), this);
+    btnRescan = new QPushButton(tr("Rescan"), this);
+
+    list = new QListWidget(this);
+    list->setViewMode(QListView::IconMode);
+    list->setIconSize(QSize(LIBRARY_THUMB_WIDTH, LIBRARY_THUMB_HEIGHT));
+    list->setGridSize(QSize(LIBRARY_THUMB_WIDTH + 24, LIBRARY_THUMB_HEIGHT + 48));
+    list->setResizeMode(QListView::Adjust);
+    list->setMovement(QListView::Static);
+    list->setUniformItemSizes(true);
+    list->setWordWrap(true);
+    list->setSelectionMode(QAbstractItemView::ExtendedSelection);
+
+    labelStatus = new QLabel(this);
+    btnLoad = new QPushButton(tr("Load"), this);
+    btnQueue = new QPushButton(tr("Add to Job Queue"), this);
+
+    QHBoxLayout *dirLayout = new QHBoxLayout;
+    dirLayout->addWidget(editDirectory, 1);
+    dirLayout->addWidget(btnBrowse);
+    dirLayout->addWidget(btnRescan);
+
+    QHBoxLayout *runLayout = new QHBoxLayout;
+    runLayout->addWidget(labelStatus, 1);
+    runLayout->addWidget(btnLoad);
+    runLayout->addWidget(btnQueue);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addLayout(dirLayout);
+    layout->addWidget(list, 1);
+    layout->addLayout(runLayout);
+
+    connect(btnBrowse, SIGNAL(clicked()), this, SLOT(chooseDirectory()));
+    connect(btnRescan, SIGNAL(clicked()), library, SLOT(rescan()));
+    connect(btnLoad, SIGNAL(clicked()), this, SLOT(loadSelected()));
+    connect(btnQueue, SIGNAL(clicked()), this, SLOT(queueSelected()));
+    connect(list, SIGNAL(itemDoubleClicked(QListWidgetItem*)), this, SLOT(loadSelected()));
+    connect(list, SIGNAL(itemSelectionChanged()), this, SLOT(updateButtons()));
+    connect(library, SIGNAL(reset()), this, SLOT(rebuild()));
+    connect(library, SIGNAL(entryChanged(int)), this, SLOT(updateEntry(int)));
+    connect(library, SIGNAL(progress(int,int)), this, SLOT(showProgress(int,int)));
+    connect(library, SIGNAL(scanFinished()), this, SLOT(showCount()));
+
+    resize(760, 520);
+
+    // the directory of the last session, shown from its index
+    QSettings settings;
+    QString dir = settings.value(SETTINGS_LIBRARY_DIRECTORY).toString();
+    if (library->directory().isEmpty() && !dir.isEmpty())
+        library->setDirectory(dir);
+    else
+        rebuild();
+    updateButtons();
+}
+
+void JobLibraryDialog::chooseDirectory()
+{
+    QString dir = QFileDialog::getExistingDirectory(this, tr("Job Library"), library->directory());
+    if (dir.isEmpty())
+        return;
+
+    QSettings settings;
+    settings.setValue(SETTINGS_LIBRARY_DIRECTORY, dir);
+    library->setDirectory(dir);
+}
+
+// calls : 'JobLibrary::reset()'
+void JobLibraryDialog::rebuild()
+{
+    editDirectory->setText(library->directory());
+    list->clear();
+    for (int n = 0; n < library->count(); n++)
+    {
+        list->addItem(new QListWidgetItem());
+        updateEntry(n);
+    }
+    if (!library->isScanning())
+        showCount();
+}
+
+// calls : 'JobLibrary::entryChanged()', 'JobLibraryDialog::rebuild()':1
+void JobLibraryDialog::updateEntry(int n)
+{
+    QListWidgetItem *item = list->item(n);
+    if (item == NULL)
+        return;
+
+    const LibraryEntry& e = library->entry(n);
+    QPixmap thumbnail;
+    if (e.thumbnail.isEmpty() || !thumbnail.loadFromData(e.thumbnail, "PNG"))
+        thumbnail = blank;
+    item->setIcon(QIcon(thumbnail));
+
+    if (!e.valid)
+    {
+        item->setText(e.fileName);
+        item->setToolTip(e.fileName);
+        return;
+    }
+
+    item->setText(e.fileName + "\n" + timeText(e.duration));
+
+    int decimals = e.mm ? 1 : 3;
+    QString unit = e.mm ? tr("mm") : tr("in");
+    QStringList tools;
+    foreach (int tool, e.tools)
+        tools << QString("T%1").arg(tool);
+    item->setToolTip(e.fileName + "\n"
+                     + tr("X %1 .. %2 %7\n"
+                          "Y %3 .. %4 %7\n"
+                          "Z %5 .. %6 %7\n"
+                          "Time %8\n"
+                          "Tools %9\n"
+                          "%10 lines")
+                     .arg(e.lo.x(), 0, 'f', decimals).arg(e.hi.x(), 0, 'f', decimals)
+                     .arg(e.lo.y(), 0, 'f', decimals).arg(e.hi.y(), 0, 'f', decimals)
+                     .arg(e.lo.z(), 0, 'f', decimals).arg(e.hi.z(), 0, 'f', decimals)
+                     .arg(unit)
+                     .arg(timeText(e.duration))
+                     .arg(tools.isEmpty() ? tr("none") : tools.join(" "))
+                     .arg(e.lineCount));
+}
+
+void JobLibraryDialog::showProgress(int done, int total)
+{
+    labelStatus->setText(tr("Reading %1 / %2 programs").arg(done).arg(total));
+}
+
+void JobLibraryDialog::showCount()
+{
+    labelStatus->setText(tr("%1 programs").arg(library->count()));
+}
+
+QStringList JobLibraryDialog::selectedPaths() const
+{
+    QStringList paths;
+    for (int n = 0; n < list->count(); n++)
+    {
+        if (list->item(n)->isSelected())
+            paths << library->filePath(n);
+    }
+    return paths;
+}
+
+void JobLibraryDialog::loadSelected()
+{
+    QStringList paths = selectedPaths();
+    if (!paths.isEmpty())
+        emit loadRequested(paths.first());
+}
+
+void JobLibraryDialog::queueSelected()
+{
+    QStringList paths = selectedPaths();
+    if (!paths.isEmpty())
+        emit queueRequested(paths);
+}
+
+void JobLibraryDialog::updateButtons()
+{
+    int selected = list->selectedItems().size();
+    btnLoad->setEnabled(selected == 1);
+    btnQueue->setEnabled(selected > 0);
+}
+
+// h:mm:ss
+QString JobLibraryDialog::timeText(double seconds)
+{
+    int s = qRound(seconds);
+    return QString("%1:%2:%3").arg(s / 3600)
+           .arg((s / 60) % 60, 2, 10, QChar('0'))
+           .arg(s % 60, 2, 10, QChar('0'));
+}
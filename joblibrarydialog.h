@@ -0,0 +1,62 @@
+/****************************************************************
+ * joblibrarydialog.h
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#ifndef JOBLIBRARYDIALOG_H
+#define JOBLIBRARYDIALOG_H
+
+#include <QDialog>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QPushButton>
+
+#include "joblibrary.h"
+
+// The programs of a directory of 'JobLibrary' as thumbnails, with their
+// extents, time and tools in the tooltips. A program is loaded or added
+// to the job queue by 'MainWindow'.
+class JobLibraryDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    JobLibraryDialog(JobLibrary *library, QWidget *parent = 0);
+
+signals:
+    void loadRequested(QString path);
+    void queueRequested(QStringList paths);
+
+private slots:
+    void chooseDirectory();
+    void rebuild();
+    void updateEntry(int n);
+    void showProgress(int done, int total);
+    void showCount();
+    void loadSelected();
+    void queueSelected();
+    void updateButtons();
+
+private:
+    QStringList selectedPaths() const;
+    static QString timeText(double seconds);
+
+private:
+    JobLibrary *library;
+    QLineEdit *editDirectory;
+    QPushButton *btnBrowse;
+    QPushButton *btnRescan;
+    QListWidget *list;
+    QLabel *labelStatus;
+    QPushButton *btnLoad;
+    QPushButton *btnQueue;
+    // placeholder of the programs not read yet
+    QPixmap blank;
+};
+
+#endif // JOBLIBRARYDIALOG_H
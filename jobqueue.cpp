@@ -0,0 +1,139 @@
+/****************************************************************
+ * jobqueue.cpp
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#include "jobqueue.h"
+
+#include <QSettings>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include "options.h"
+
+JobQueue::JobQueue(QObject *parent)
+    : QObject(parent), inMemoryLimit((qint64)TOOLPATH_DEFAULT_LIMIT_MB << 20)
+{
+    connect(&watcher, SIGNAL(finished()), this, SLOT(preparationFinished()));
+}
+
+JobQueue::~JobQueue()
+{
+    // the analysis can't be cancelled, it only reads the file
+    watcher.waitForFinished();
+}
+
+void JobQueue::restore()
+{
+    QSettings settings;
+    queue = settings.value(SETTINGS_JOB_QUEUE).toStringList();
+    emit changed();
+    prepareNext();
+}
+
+QStringList JobQueue::jobs() const
+{
+    return queue;
+}
+
+bool JobQueue::isEmpty() const
+{
+    return queue.isEmpty();
+}
+
+void JobQueue::append(const QStringList& paths)
+{
+    queue.append(paths);
+    save();
+    emit changed();
+    prepareNext();
+}
+
+QString JobQueue::takeFirst()
+{
+    if (queue.isEmpty())
+        return QString();
+
+    QString path = queue.takeFirst();
+    save();
+    emit changed();
+    return path;
+}
+
+void JobQueue::clear()
+{
+    queue.clear();
+    ready = ProgramAnalysis();
+    save();
+    emit changed();
+}
+
+// calls : 'MainWindow::preProcessFile()':1
+bool JobQueue::takePrepared(const QString& path, ProgramAnalysis& analysis)
+{
+    if (preparing == path)
+    {
+        // also when 'finished()' is not delivered yet
+        watcher.waitForFinished();
+        ready = watcher.result();
+        preparing.clear();
+    }
+
+    // another file opened by hand keeps the prepared job
+    bool found = ready.path == path && ready.isCurrent();
+    if (found)
+    {
+        analysis = ready;
+        ready = ProgramAnalysis();
+    }
+
+    // the job after this one
+    prepareNext();
+    return found;
+}
+
+void JobQueue::prepareNext()
+{
+    if (queue.isEmpty() || watcher.isRunning())
+        return;
+
+    const QString& next = queue.first();
+    if (preparing == next || (ready.path == next && ready.isCurrent()))
+        return;
+
+    preparing = next;
+    watcher.setFuture(QtConcurrent::run(&ProgramAnalyzer::analyze, next, inMemoryLimit));
+}
+
+// calls : 'MainWindow::updateSettingsFromOptionDlg()':1
+void JobQueue::setInMemoryLimit(qint64 bytes)
+{
+    inMemoryLimit = bytes;
+}
+
+// calls : 'watcher::finished()'
+void JobQueue::preparationFinished()
+{
+    // already taken by 'takePrepared()', or a late signal of an older run
+    if (preparing.isEmpty() || !watcher.isFinished())
+        return;
+
+    ready = watcher.result();
+    preparing.clear();
+
+    if (!ready.valid)
+        warn(qPrintable(tr("Can't read queued job '%s'")), qPrintable(ready.path));
+    emit prepared(ready.path);
+
+    // the first job changed while this one was analyzed
+    prepareNext();
+}
+
+void JobQueue::save()
+{
+    QSettings settings;
+    settings.setValue(SETTINGS_JOB_QUEUE, queue);
+}
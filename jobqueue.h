@@ -0,0 +1,67 @@
+/****************************************************************
+ * jobqueue.h
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#ifndef JOBQUEUE_H
+#define JOBQUEUE_H
+
+#include <QObject>
+#include <QFutureWatcher>
+#include <QStringList>
+
+#include "programanalyzer.h"
+
+// Files waiting to be sent after the loaded one. The first of them is
+// analyzed on a worker thread while the current job streams, so that
+// loading it at the changeover costs no more than a copy.
+// The list is kept in the settings across restarts.
+class JobQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit JobQueue(QObject *parent = 0);
+    ~JobQueue();
+
+    // reads the list of the last session and prepares its first job
+    void restore();
+    QStringList jobs() const;
+    bool isEmpty() const;
+
+    void append(const QStringList& paths);
+    // removes the first job, loaded next by 'MainWindow::loadFile()'
+    QString takeFirst();
+    void clear();
+
+    // the analysis of 'path' if it is the prepared job and the file did
+    // not change since, waits for a preparation still running
+    bool takePrepared(const QString& path, ProgramAnalysis& analysis);
+    // see 'ProgramAnalyzer::analyze()', for the next preparations
+    void setInMemoryLimit(qint64 bytes);
+
+signals:
+    void changed();
+    void prepared(QString path);
+
+private slots:
+    void preparationFinished();
+
+private:
+    void prepareNext();
+    void save();
+
+private:
+    QStringList queue;
+    QFutureWatcher<ProgramAnalysis> watcher;
+    // path being analyzed, empty when idle
+    QString preparing;
+    ProgramAnalysis ready;
+    qint64 inMemoryLimit;
+};
+
+#endif // JOBQUEUE_H
@@ -0,0 +1,296 @@
+/****************************************************************
+ * lineindex.cpp
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#include "lineindex.h"
+#include "compressedfile.h"
+
+#include <climits>
+#include <cstring>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+
+#define LINE_INDEX_READ_CHUNK   (1 << 20)
+
+LineIndex::LineIndex()
+    : spill(NULL), mapped(NULL), data(NULL), fileSize(-1), bytes(0), longest(0)
+{
+}
+
+LineIndex::~LineIndex()
+{
+    close();
+}
+
+bool LineIndex::open(const QString& path, qint64 heapLimit)
+{
+    close();
+    if (heapLimit <= 0 || heapLimit > LINE_INDEX_MAX_HEAP)
+        heapLimit = LINE_INDEX_MAX_HEAP;
+
+    file.setFileName(path);
+    if (CompressedFile::isCompressed(path))
+        return openCompressed(path, heapLimit);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    bytes = file.size();
+    if (bytes <= heapLimit)
+    {
+        text = file.read(bytes);
+        if (text.size() == bytes)
+        {
+            // an empty text is still an open file
+            if (text.isNull())
+                text = QByteArray("");
+            data = (uchar *)text.data();
+            file.close();
+            buildFromMap();
+            return true;
+        }
+        // shorter than its size : being written, read from the disk
+        text.clear();
+        file.seek(0);
+    }
+
+    QFileInfo info(file);
+    fileSize = info.size();
+    fileModified = info.lastModified();
+
+    if (bytes > 0)
+        data = file.map(0, bytes);
+
+    if (data != NULL)
+    {
+        mapped = &file;
+        buildFromMap();
+    }
+    else
+        buildFromFile();
+
+    return true;
+}
+
+void LineIndex::close()
+{
+    if (mapped != NULL)
+        mapped->unmap(data);
+    mapped = NULL;
+    data = NULL;
+    text.clear();
+    if (file.isOpen())
+        file.close();
+    delete spill;
+    spill = NULL;
+
+    offsets.clear();
+    fileSize = -1;
+    fileModified = QDateTime();
+    bytes = 0;
+    longest = 0;
+}
+
+bool LineIndex::isOpen() const
+{
+    return file.isOpen() || data != NULL;
+}
+
+QString LineIndex::fileName() const
+{
+    return file.fileName();
+}
+
+// A truncated file raises SIGBUS on the rows of its mapping past the
+// new end, a rewritten one shows its new bytes at the old offsets.
+// calls : 'GcodeListView::paintEvent()':1
+bool LineIndex::isCurrent() const
+{
+    // private copy, or nothing read from the file
+    if (fileSize < 0)
+        return true;
+
+    QFileInfo info(file.fileName());
+    return info.size() == fileSize && info.lastModified() == fileModified;
+}
+
+// calls : 'MainWindow::programChanged()':1, 'MainWindow::reloadProgram()':1
+bool LineIndex::readsFile() const
+{
+    return fileSize >= 0;
+}
+
+void LineIndex::buildFromMap()
+{
+    // about 40 bytes per line for typical CAM output
+    offsets.reserve((int)qMin(bytes / 32 + 1, (qint64)INT_MAX / 8));
+
+    const uchar *p = data;
+    const uchar *end = data + bytes;
+    while (p < end)
+    {
+        offsets.append(p - data);
+        const uchar *eol = (const uchar *)memchr(p, '\n', end - p);
+        if (eol == NULL)
+            eol = end;
+        longest = qMax(longest, (int)(eol - p));
+        p = eol + 1;
+    }
+}
+
+// The worker of 'CompressedFile' decompresses the next chunks while
+// the previous ones are copied. Above 'heapLimit' the text goes on to a
+// temporary file which is mapped, only the line offsets stay in memory.
+bool LineIndex::openCompressed(const QString& path, qint64 heapLimit)
+{
+    CompressedFile device(path, CompressedFile::format(path));
+    if (!device.open(QIODevice::ReadOnly))
+        return false;
+
+    bool ok = true;
+    QByteArray chunk;
+    while (ok && !(chunk = device.read(LINE_INDEX_READ_CHUNK)).isEmpty())
+    {
+        if (spill == NULL && text.size() + (qint64)chunk.size() > heapLimit)
+        {
+            spill = new QTemporaryFile(QDir::tempPath() + "/GrblController-XXXXXX.nc");
+            ok = spill->open() && spill->write(text) == text.size();
+            text.clear();
+        }
+        if (spill != NULL)
+            ok = ok && spill->write(chunk) == chunk.size();
+        else
+            text.append(chunk);
+    }
+    ok = ok && !device.failed();
+    device.close();
+
+    if (spill != NULL)
+    {
+        ok = ok && spill->flush();
+        bytes = spill->size();
+        if (ok && bytes > 0)
+            data = spill->map(0, bytes);
+        if (data == NULL)
+        {
+            close();
+            return false;
+        }
+        mapped = spill;
+    }
+    else
+    {
+        bytes = text.size();
+        // an empty text is still an open file
+        if (text.isNull())
+            text = QByteArray("");
+        data = (uchar *)text.data();
+    }
+    buildFromMap();
+    return ok;
+}
+
+// when the file can't be mapped, rows are read back with 'seek()'
+void LineIndex::buildFromFile()
+{
+    QByteArray chunk;
+    qint64 pos = 0;
+    qint64 lineStart = 0;
+    bool atLineStart = true;
+
+    while (!(chunk = file.read(LINE_INDEX_READ_CHUNK)).isEmpty())
+    {
+        const char *base = chunk.constData();
+        for (int i = 0; i < chunk.size(); i++)
+        {
+            if (atLineStart)
+            {
+                offsets.append(pos + i);
+                lineStart = pos + i;
+                atLineStart = false;
+            }
+            if (base[i] == '\n')
+            {
+                longest = qMax(longest, (int)(pos + i - lineStart));
+                atLineStart = true;
+            }
+        }
+        pos += chunk.size();
+    }
+    if (!atLineStart)
+        longest = qMax(longest, (int)(pos - lineStart));
+    bytes = pos;
+}
+
+int LineIndex::lineCount() const
+{
+    return offsets.size();
+}
+
+qint64 LineIndex::lineOffset(int row) const
+{
+    if (row >= offsets.size())
+        return bytes;
+    return offsets.at(row);
+}
+
+QByteArray LineIndex::lineBytes(int row) const
+{
+    if (row < 0 || row >= offsets.size())
+        return QByteArray();
+
+    qint64 start = offsets.at(row);
+    qint64 len = lineOffset(row + 1) - start;
+
+    QByteArray line;
+    if (data != NULL)
+        line = QByteArray((const char *)data + start, (int)len);
+    else
+    {
+        // const reader of a shared file, position is restored by 'seek()'
+        QFile& f = const_cast<QFile&>(file);
+        f.seek(start);
+        line = f.read(len);
+    }
+
+    while (line.endsWith('\n') || line.endsWith('\r'))
+        line.chop(1);
+    return line;
+}
+
+QString LineIndex::lineText(int row) const
+{
+    return QString::fromLocal8Bit(lineBytes(row));
+}
+
+int LineIndex::maxLineLength() const
+{
+    return longest;
+}
+
+// calls : 'ProgramAnalyzer::analyze()':1, 'ProgramAnalyzer::reanalyze()':1
+QVector<uint> LineIndex::lineHashes() const
+{
+    QVector<uint> hashes(offsets.size());
+    for (int row = 0; row < offsets.size(); row++)
+        hashes[row] = qHash(lineBytes(row));
+    return hashes;
+}
+
+qint64 LineIndex::size() const
+{
+    return bytes;
+}
+
+// calls : 'ProgramAnalyzer::analyze()':1
+void LineIndex::moveToThread(QThread *thread)
+{
+    file.moveToThread(thread);
+    if (spill != NULL)
+        spill->moveToThread(thread);
+}
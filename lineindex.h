@@ -0,0 +1,86 @@
+/****************************************************************
+ * lineindex.h
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#ifndef LINEINDEX_H
+#define LINEINDEX_H
+
+#include <QDateTime>
+#include <QFile>
+#include <QTemporaryFile>
+#include <QThread>
+#include <QString>
+#include <QVector>
+
+// largest private copy of a program, below the 2 GB of a 'QByteArray'
+#define LINE_INDEX_MAX_HEAP     (1024 << 20)
+
+// Byte offset of every line of a G-code file. A program up to the heap
+// limit is copied to memory so that another program may rewrite the
+// file while it is shown. A larger one
+// is memory mapped when possible and read back without keeping its
+// text in memory : 'isCurrent()' then tells if the file changed under
+// the mapping. The text of a compressed file is decompressed to memory,
+// or to a temporary file mapped in its place above the heap limit, see
+// 'CompressedFile'.
+class LineIndex
+{
+public:
+    LineIndex();
+    ~LineIndex();
+
+    // files larger than 'heapLimit' bytes are read from the disk, 0 for
+    // 'LINE_INDEX_MAX_HEAP'
+    bool open(const QString& path, qint64 heapLimit = 0);
+    void close();
+    bool isOpen() const;
+    QString fileName() const;
+    // false once the file read from the disk changed since 'open()', its
+    // lines must not be read any more
+    bool isCurrent() const;
+    // true when the lines are read back from the file rather than from a
+    // copy, a writer of the file changes them
+    bool readsFile() const;
+
+    // rows are 0 based, 'lineCount()' is the number of lines
+    int lineCount() const;
+    qint64 lineOffset(int row) const;
+    QByteArray lineBytes(int row) const;
+    QString lineText(int row) const;
+    // longest line in bytes, for horizontal scrolling
+    int maxLineLength() const;
+    // 'qHash()' of the bytes of each row, to compare two versions
+    QVector<uint> lineHashes() const;
+    qint64 size() const;
+    // when built by a worker thread for the GUI
+    void moveToThread(QThread *thread);
+
+private:
+    Q_DISABLE_COPY(LineIndex)
+    void buildFromMap();
+    void buildFromFile();
+    bool openCompressed(const QString& path, qint64 heapLimit);
+
+private:
+    QFile file;
+    // private copy of the text, 'data' points to it
+    QByteArray text;
+    // decompressed text above the heap limit
+    QTemporaryFile *spill;
+    // file mapped at 'data', 0 for the private copy
+    QFile *mapped;
+    uchar *data;
+    // the program when it is read from the disk, see 'isCurrent()'
+    qint64 fileSize;
+    QDateTime fileModified;
+    qint64 bytes;
+    QVector<qint64> offsets;
+    int longest;
+};
+
+#endif // LINEINDEX_H
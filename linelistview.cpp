@@ -0,0 +1,278 @@
+/****************************************************************
+ * linelistview.cpp
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#include "linelistview.h"
+
+#include <QApplication>
+#include <QClipboard>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <QStringList>
+
+LineListView::LineListView(QWidget *parent)
+    : QAbstractScrollArea(parent),
+      selAnchor(-1), selCurrent(-1),
+      maxTextWidth(0)
+{
+    setFocusPolicy(Qt::StrongFocus);
+    viewport()->setCursor(Qt::IBeamCursor);
+    viewport()->setBackgroundRole(QPalette::Base);
+}
+
+qint64 LineListView::rowKey(int row) const
+{
+    return row;
+}
+
+int LineListView::keyRow(qint64 key) const
+{
+    return (int)key;
+}
+
+int LineListView::gutterWidth() const
+{
+    return 0;
+}
+
+void LineListView::paintGutter(QPainter& painter, int row, const QRect& rect)
+{
+    Q_UNUSED(painter);
+    Q_UNUSED(row);
+    Q_UNUSED(rect);
+}
+
+void LineListView::paintRowBackground(QPainter& painter, int row, const QRect& rect)
+{
+    Q_UNUSED(painter);
+    Q_UNUSED(row);
+    Q_UNUSED(rect);
+}
+
+int LineListView::rowHeight() const
+{
+    return fontMetrics().height();
+}
+
+int LineListView::visibleRows() const
+{
+    return qMax(1, viewport()->height() / rowHeight());
+}
+
+int LineListView::firstVisibleRow() const
+{
+    return verticalScrollBar()->value();
+}
+
+int LineListView::rowAt(int y) const
+{
+    if (rowCount() == 0)
+        return -1;
+
+    return qBound(0, firstVisibleRow() + y / rowHeight(), rowCount() - 1);
+}
+
+void LineListView::setTextWidth(int width)
+{
+    maxTextWidth = width;
+}
+
+int LineListView::textWidth() const
+{
+    return maxTextWidth;
+}
+
+void LineListView::updateScrollBars()
+{
+    int rows = visibleRows();
+    verticalScrollBar()->setRange(0, qMax(0, rowCount() - rows));
+    verticalScrollBar()->setPageStep(rows);
+    verticalScrollBar()->setSingleStep(1);
+
+    int width = viewport()->width() - gutterWidth();
+    horizontalScrollBar()->setRange(0, qMax(0, maxTextWidth + 2*LINE_LIST_MARGIN - width));
+    horizontalScrollBar()->setPageStep(width);
+    horizontalScrollBar()->setSingleStep(fontMetrics().averageCharWidth());
+}
+
+void LineListView::ensureRowVisible(int row)
+{
+    int first = firstVisibleRow();
+    int rows = visibleRows();
+    if (row < first || row >= first + rows)
+        verticalScrollBar()->setValue(row - rows/2);
+}
+
+void LineListView::clearSelection()
+{
+    selAnchor = selCurrent = -1;
+}
+
+void LineListView::selectionRows(int& first, int& last) const
+{
+    first = last = -1;
+    if (selAnchor < 0 || selCurrent < 0 || rowCount() == 0)
+        return;
+
+    int lo = keyRow(qMin(selAnchor, selCurrent));
+    int hi = keyRow(qMax(selAnchor, selCurrent));
+    if (hi < 0)
+        return;     // selected rows are gone
+
+    first = qMax(0, lo);
+    last = qMin(rowCount() - 1, hi);
+    if (last < first)
+        first = last = -1;
+}
+
+void LineListView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBars();
+}
+
+void LineListView::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    QPainter painter(viewport());
+    QFontMetrics fm(font());
+    int lineHeight = fm.height();
+    int first = firstVisibleRow();
+    int last = qMin(rowCount() - 1, first + visibleRows() + 1);
+    int gutter = gutterWidth();
+    int width = viewport()->width();
+    int x = gutter + LINE_LIST_MARGIN - horizontalScrollBar()->value();
+
+    int selFirst, selLast;
+    selectionRows(selFirst, selLast);
+
+    const QPalette& pal = palette();
+    for (int row = first; row <= last; row++)
+    {
+        int y = (row - first) * lineHeight;
+        QRect textRect(gutter, y, width - gutter, lineHeight);
+
+        if (row >= selFirst && row <= selLast)
+        {
+            painter.fillRect(textRect, pal.highlight());
+            painter.setPen(pal.color(QPalette::HighlightedText));
+        }
+        else
+        {
+            paintRowBackground(painter, row, textRect);
+            painter.setPen(pal.color(QPalette::Text));
+        }
+
+        painter.setClipRect(textRect);
+        painter.drawText(x, y + fm.ascent(), rowText(row));
+        painter.setClipping(false);
+
+        if (gutter > 0)
+            paintGutter(painter, row, QRect(0, y, gutter, lineHeight));
+    }
+}
+
+void LineListView::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton)
+        return;
+
+    int row = rowAt(event->pos().y());
+    qint64 key = row < 0 ? -1 : rowKey(row);
+    if (!(event->modifiers() & Qt::ShiftModifier) || selAnchor < 0)
+        selAnchor = key;
+    selCurrent = key;
+    viewport()->update();
+}
+
+void LineListView::mouseMoveEvent(QMouseEvent *event)
+{
+    if (!(event->buttons() & Qt::LeftButton) || selAnchor < 0)
+        return;
+
+    int y = event->pos().y();
+    if (y < 0)
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepSub);
+    else if (y > viewport()->height())
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepAdd);
+
+    int row = rowAt(qBound(0, y, viewport()->height() - 1));
+    if (row >= 0)
+        selCurrent = rowKey(row);
+    viewport()->update();
+}
+
+void LineListView::keyPressEvent(QKeyEvent *event)
+{
+    if (event->matches(QKeySequence::Copy))
+        copy();
+    else if (event->matches(QKeySequence::SelectAll))
+        selectAll();
+    else if (event->matches(QKeySequence::MoveToStartOfDocument))
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderToMinimum);
+    else if (event->matches(QKeySequence::MoveToEndOfDocument))
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderToMaximum);
+    else if (event->matches(QKeySequence::MoveToPreviousPage))
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderPageStepSub);
+    else if (event->matches(QKeySequence::MoveToNextPage))
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderPageStepAdd);
+    else if (event->matches(QKeySequence::MoveToPreviousLine))
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepSub);
+    else if (event->matches(QKeySequence::MoveToNextLine))
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepAdd);
+    else
+        QAbstractScrollArea::keyPressEvent(event);
+}
+
+bool LineListView::hasSelection() const
+{
+    int first, last;
+    selectionRows(first, last);
+    return first >= 0;
+}
+
+QString LineListView::selectedText() const
+{
+    int first, last;
+    selectionRows(first, last);
+    if (first < 0)
+        return QString();
+
+    QStringList lines;
+    for (int row = first; row <= last; row++)
+        lines.append(rowText(row));
+    return lines.join("\n");
+}
+
+QString LineListView::toPlainText() const
+{
+    QStringList lines;
+    int count = rowCount();
+    for (int row = 0; row < count; row++)
+        lines.append(rowText(row));
+    return lines.join("\n");
+}
+
+void LineListView::copy()
+{
+    if (hasSelection())
+        QApplication::clipboard()->setText(selectedText());
+}
+
+void LineListView::selectAll()
+{
+    if (rowCount() == 0)
+        return;
+
+    selAnchor = rowKey(0);
+    selCurrent = rowKey(rowCount() - 1);
+    viewport()->update();
+}
@@ -0,0 +1,69 @@
+/****************************************************************
+ * linelistview.h
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#ifndef LINELISTVIEW_H
+#define LINELISTVIEW_H
+
+#include <QAbstractScrollArea>
+
+#define LINE_LIST_MARGIN    4
+
+// Read-only list of text rows painting only what is on screen.
+// Subclasses supply the rows; selection is by whole rows.
+class LineListView : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    explicit LineListView(QWidget *parent = 0);
+
+    bool hasSelection() const;
+    QString selectedText() const;
+    QString toPlainText() const;
+
+public slots:
+    void copy();
+    void selectAll();
+
+protected:
+    virtual int rowCount() const = 0;
+    virtual QString rowText(int row) const = 0;
+    // selection is kept as keys so that it can survive rows moving,
+    // by default the key is the row itself
+    virtual qint64 rowKey(int row) const;
+    virtual int keyRow(qint64 key) const;
+    virtual int gutterWidth() const;
+    virtual void paintGutter(QPainter& painter, int row, const QRect& rect);
+    virtual void paintRowBackground(QPainter& painter, int row, const QRect& rect);
+
+    void paintEvent(QPaintEvent *event);
+    void resizeEvent(QResizeEvent *event);
+    void mousePressEvent(QMouseEvent *event);
+    void mouseMoveEvent(QMouseEvent *event);
+    void keyPressEvent(QKeyEvent *event);
+
+    void updateScrollBars();
+    void setTextWidth(int width);
+    int textWidth() const;
+    int rowHeight() const;
+    int visibleRows() const;
+    int firstVisibleRow() const;
+    int rowAt(int y) const;
+    void ensureRowVisible(int row);
+    void clearSelection();
+    void selectionRows(int& first, int& last) const;
+
+protected:
+    qint64 selAnchor, selCurrent;
+
+private:
+    int maxTextWidth;
+};
+
+#endif // LINELISTVIEW_H
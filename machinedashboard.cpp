@@ -0,0 +1,266 @@
+/****************************************************************
+ * machinedashboard.cpp
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#include "machinedashboard.h"
+
+#include <QBoxLayout>
+#include <QFile>
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QSerialPortInfo>
+
+MachineDashboard::MachineDashboard(MachineManager *m, QWidget *parent)
+    : QDialog(parent), manager(m)
+{
+    setWindowTitle(tr("Machines"));
+
+    cmbPort = new QComboBox(this);
+    cmbPort->setEditable(true);
+    foreach (const QSerialPortInfo& info, QSerialPortInfo::availablePorts())
+        cmbPort->addItem(info.portName());
+
+    cmbBaud = new QComboBox(this);
+    QList<int> baudRates;
+    baudRates << 9600 << 19200 << 38400 << 57600 << 115200;
+    foreach (int baud, baudRates)
+        cmbBaud->addItem(QString::number(baud));
+    cmbBaud->setCurrentIndex(baudRates.size() - 1);
+
+    btnAdd = new QPushButton(tr("Add"), this);
+    btnRemove = new QPushButton(tr("Remove"), this);
+    btnOpen = new QPushButton(tr("Open"), this);
+    btnClose = new QPushButton(tr("Close"), this);
+    btnSend = new QPushButton(tr("Send File..."), this);
+    btnStop = new QPushButton(tr("Stop"), this);
+
+    table = new QTableWidget(0, DASH_COL_COUNT, this);
+    QStringList labels;
+    labels << tr("Port") << tr("State") << tr("Line") << tr("%")
+           << tr("Queue") << tr("Work X / Y / Z") << tr("Last message");
+    table->setHorizontalHeaderLabels(labels);
+    table->horizontalHeader()->setStretchLastSection(true);
+    table->verticalHeader()->hide();
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->setSelectionMode(QAbstractItemView::SingleSelection);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    QHBoxLayout *addLayout = new QHBoxLayout;
+    addLayout->addWidget(cmbPort, 1);
+    addLayout->addWidget(cmbBaud);
+    addLayout->addWidget(btnAdd);
+    addLayout->addWidget(btnRemove);
+
+    QHBoxLayout *runLayout = new QHBoxLayout;
+    runLayout->addWidget(btnOpen);
+    runLayout->addWidget(btnClose);
+    runLayout->addStretch(1);
+    runLayout->addWidget(btnSend);
+    runLayout->addWidget(btnStop);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addLayout(addLayout);
+    layout->addWidget(table, 1);
+    layout->addLayout(runLayout);
+
+    connect(btnAdd, SIGNAL(clicked()), this, SLOT(addMachine()));
+    connect(btnRemove, SIGNAL(clicked()), this, SLOT(removeMachine()));
+    connect(btnOpen, SIGNAL(clicked()), this, SLOT(openPort()));
+    connect(btnClose, SIGNAL(clicked()), this, SLOT(closePort()));
+    connect(btnSend, SIGNAL(clicked()), this, SLOT(sendFile()));
+    connect(btnStop, SIGNAL(clicked()), this, SLOT(stop()));
+    connect(table, SIGNAL(itemSelectionChanged()), this, SLOT(updateButtons()));
+    connect(manager, SIGNAL(machinesChanged()), this, SLOT(rebuild()));
+    connect(&refreshTimer, SIGNAL(timeout()), this, SLOT(refresh()));
+
+    resize(760, 320);
+    rebuild();
+    refreshTimer.start(TELEMETRY_REFRESH_MSEC);
+}
+
+void MachineDashboard::rebuild()
+{
+    table->setRowCount(manager->count());
+    shown.clear();
+    for (int row = 0; row < manager->count(); row++)
+    {
+        for (int col = 0; col < DASH_COL_COUNT; col++)
+        {
+            if (table->item(row, col) == NULL)
+                table->setItem(row, col, new QTableWidgetItem());
+        }
+        setCell(row, DASH_COL_PORT, manager->machine(row).port);
+        TelemetrySnapshot none;
+        none.sequence = -1;
+        shown.append(none);
+    }
+    refresh();
+    updateButtons();
+}
+
+// only rows whose telemetry changed are written
+// calls : 'refreshTimer::timeout()'
+void MachineDashboard::refresh()
+{
+    if (!isVisible())
+        return;
+
+    for (int row = 0; row < manager->count() && row < shown.size(); row++)
+    {
+        const Machine& m = manager->machine(row);
+        setCell(row, DASH_COL_MESSAGE, m.lastMessage);
+        setCell(row, DASH_COL_STATE, !m.portOpen ? tr("Closed")
+                : shown.at(row).running ? tr("Running") : tr("Idle"));
+
+        const Telemetry& telemetry = m.gcode->getTelemetry();
+        if (telemetry.sequence() == shown.at(row).sequence)
+            continue;
+
+        TelemetrySnapshot snap;
+        telemetry.read(snap);
+        shown[row] = snap;
+
+        setCell(row, DASH_COL_LINE, snap.running || snap.totalLines
+                ? QString("%1 / %2").arg(snap.currLine).arg(snap.totalLines) : QString());
+        setCell(row, DASH_COL_PROGRESS, QString::number(snap.progress));
+        setCell(row, DASH_COL_QUEUE, snap.queueRunning ? QString::number(snap.queuedCommands) : QString());
+        if (snap.positionValid)
+        {
+            int n = snap.useMm ? 3 : 4;
+            setCell(row, DASH_COL_POSITION, QString("%1 / %2 / %3")
+                    .arg(snap.workCoord.x, 0, 'f', n)
+                    .arg(snap.workCoord.y, 0, 'f', n)
+                    .arg(snap.workCoord.z, 0, 'f', n));
+        }
+    }
+    updateButtons();
+}
+
+void MachineDashboard::setCell(int row, int col, const QString& text)
+{
+    QTableWidgetItem *item = table->item(row, col);
+    if (item != NULL && item->text() != text)
+        item->setText(text);
+}
+
+int MachineDashboard::currentMachine() const
+{
+    QList<QTableWidgetItem *> items = table->selectedItems();
+    return items.isEmpty() ? -1 : items.first()->row();
+}
+
+void MachineDashboard::updateButtons()
+{
+    int index = currentMachine();
+    bool open = index >= 0 && manager->machine(index).portOpen;
+    bool running = open && index < shown.size() && shown.at(index).running;
+
+    btnRemove->setEnabled(index >= 0 && !running);
+    btnOpen->setEnabled(index >= 0 && !open);
+    btnClose->setEnabled(open && !running);
+    btnSend->setEnabled(open && !running);
+    btnStop->setEnabled(running);
+}
+
+void MachineDashboard::addMachine()
+{
+    int index = manager->addMachine(cmbPort->currentText().trimmed(), cmbBaud->currentText());
+    if (index < 0)
+    {
+        QMessageBox::warning(this, windowTitle(),
+                             tr("The port '%1' is empty or already used by the main window "
+                                "or another machine.").arg(cmbPort->currentText()));
+        return;
+    }
+    table->selectRow(index);
+    recoverInterruptedJob(index);
+}
+
+// The journal of the port still shows a job running, as for the main
+// window in 'MainWindow::recoverInterruptedJob()' : the job is resumed by
+// the next 'Send' once the port is open.
+void MachineDashboard::recoverInterruptedJob(int index)
+{
+    const Machine& m = manager->machine(index);
+    JobJournal *journal = m.gcode->getJournal();
+    if (!journal->interrupted())
+        return;
+
+    QString path = journal->jobFile();
+    int line = journal->resumeLine();
+    if (!QFile::exists(path))
+    {
+        warn(qPrintable(tr("Interrupted job '%s' no longer exists")), qPrintable(path));
+        journal->finish();
+        return;
+    }
+
+    Coord3D work = journal->workPosition();
+    QMessageBox msgBox(this);
+    msgBox.setWindowTitle(windowTitle());
+    msgBox.setText(tr("The job '%1' on port %2 was interrupted after line %3 of %4 "
+                      "was acknowledged by Grbl (work position %5, %6, %7).\n\n"
+                      "Grbl acknowledges a line when it is planned, not when it has run : "
+                      "line %8 is a conservative resume point, the lines %8 to %3 may "
+                      "run a second time.\n\n"
+                      "Resume it at line %8 with the next 'Send' once the port is open?")
+                   .arg(path).arg(m.port).arg(journal->ackedLine()).arg(journal->totalLines())
+                   .arg(work.x).arg(work.y).arg(work.z).arg(line));
+    msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
+    msgBox.setDefaultButton(QMessageBox::Yes);
+    if (msgBox.exec() != QMessageBox::Yes)
+    {
+        journal->finish();
+        return;
+    }
+
+    manager->setResume(index, path, line);
+}
+
+void MachineDashboard::removeMachine()
+{
+    manager->removeMachine(currentMachine());
+}
+
+void MachineDashboard::openPort()
+{
+    manager->openPort(currentMachine());
+}
+
+void MachineDashboard::closePort()
+{
+    manager->closePort(currentMachine());
+}
+
+void MachineDashboard::sendFile()
+{
+    int index = currentMachine();
+    if (index < 0)
+        return;
+
+    // confirmed by 'recoverInterruptedJob()'
+    if (manager->machine(index).resumeLine > 0)
+    {
+        manager->resumeJob(index);
+        return;
+    }
+
+    QString fileName = QFileDialog::getOpenFileName(this, tr("Open File"), directory,
+                                                    tr("NC (*.nc);;All Files (*.*)"));
+    if (fileName.isEmpty())
+        return;
+
+    directory = QFileInfo(fileName).absolutePath();
+    manager->sendFile(index, fileName);
+}
+
+void MachineDashboard::stop()
+{
+    manager->stop(currentMachine());
+}
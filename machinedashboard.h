@@ -0,0 +1,78 @@
+/****************************************************************
+ * machinedashboard.h
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#ifndef MACHINEDASHBOARD_H
+#define MACHINEDASHBOARD_H
+
+#include <QDialog>
+#include <QTimer>
+#include <QTableWidget>
+#include <QComboBox>
+#include <QPushButton>
+
+#include "machinemanager.h"
+
+// columns of the dashboard
+enum
+{
+    DASH_COL_PORT,
+    DASH_COL_STATE,
+    DASH_COL_LINE,
+    DASH_COL_PROGRESS,
+    DASH_COL_QUEUE,
+    DASH_COL_POSITION,
+    DASH_COL_MESSAGE,
+    DASH_COL_COUNT
+};
+
+// One row for each machine of 'MachineManager', refreshed from the
+// telemetry of each engine once per display frame.
+class MachineDashboard : public QDialog
+{
+    Q_OBJECT
+
+public:
+    MachineDashboard(MachineManager *manager, QWidget *parent = 0);
+
+public slots:
+    void refresh();
+
+private slots:
+    void rebuild();
+    void addMachine();
+    void removeMachine();
+    void openPort();
+    void closePort();
+    void sendFile();
+    void stop();
+    void updateButtons();
+
+private:
+    void recoverInterruptedJob(int index);
+    int currentMachine() const;
+    void setCell(int row, int col, const QString& text);
+
+private:
+    MachineManager *manager;
+    QTableWidget *table;
+    QComboBox *cmbPort;
+    QComboBox *cmbBaud;
+    QPushButton *btnAdd;
+    QPushButton *btnRemove;
+    QPushButton *btnOpen;
+    QPushButton *btnClose;
+    QPushButton *btnSend;
+    QPushButton *btnStop;
+    QTimer refreshTimer;
+    // telemetry shown on each row
+    QList<TelemetrySnapshot> shown;
+    QString directory;
+};
+
+#endif // MACHINEDASHBOARD_H
@@ -0,0 +1,254 @@
+/****************************************************************
+ * machinemanager.cpp
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#include "machinemanager.h"
+
+#include <QDir>
+
+#include "programanalyzer.h"
+
+MachineManager::MachineManager(JournalSync *sync, QObject *parent)
+    : QObject(parent), journalSync(sync), inMemoryLimit(0)
+{
+}
+
+MachineManager::~MachineManager()
+{
+    shutdown();
+}
+
+int MachineManager::count() const
+{
+    return machines.size();
+}
+
+const Machine& MachineManager::machine(int index) const
+{
+    return machines.at(index);
+}
+
+int MachineManager::indexOfPort(const QString& port) const
+{
+    for (int i = 0; i < machines.size(); i++)
+    {
+        if (machines.at(i).port == port)
+            return i;
+    }
+    return -1;
+}
+
+// calls : 'MachineDashboard::addMachine()':1
+int MachineManager::addMachine(const QString& port, const QString& baudRate)
+{
+    // a port is driven by a single engine
+    if (port.isEmpty() || port == mainPort || indexOfPort(port) != -1
+        || machines.size() >= MACHINE_MAX_COUNT)
+        return -1;
+
+    Machine m;
+    m.port = port;
+    m.baudRate = baudRate;
+    m.gcode = new GCode();
+    m.thread = new QThread(this);
+
+    QString name = port;
+    name.replace(QRegExp("[^A-Za-z0-9]"), "_");
+    m.gcode->getJournal()->open(QDir::homePath() + QString(MACHINE_JOURNAL_FILE).arg(name));
+    journalSync->addJournal(m.gcode->getJournal());
+
+    m.gcode->moveToThread(m.thread);
+    connect(m.thread, SIGNAL(finished()), m.gcode, SLOT(deleteLater()));
+
+    // only what the dashboard shows, progress and position are read from telemetry
+    connect(m.gcode, SIGNAL(portIsOpen(bool)), this, SLOT(portOpened()));
+    connect(m.gcode, SIGNAL(portIsClosed()), this, SLOT(portClosed()));
+    connect(m.gcode, SIGNAL(addList(QString)), this, SLOT(receiveMessage(QString)));
+    connect(m.gcode, SIGNAL(addListChunk(QStringList)), this, SLOT(receiveChunk(QStringList)));
+
+    m.thread->start();
+    QMetaObject::invokeMethod(m.gcode, "setResponseWait", Qt::QueuedConnection,
+                              Q_ARG(ControlParams, controlParams));
+
+    machines.append(m);
+    info(qPrintable(tr("Machine added on port %s")), qPrintable(port));
+    emit machinesChanged();
+    return machines.size() - 1;
+}
+
+void MachineManager::removeMachine(int index)
+{
+    if (index < 0 || index >= machines.size())
+        return;
+
+    Machine m = machines.takeAt(index);
+    journalSync->removeJournal(m.gcode->getJournal());
+
+    m.gcode->setShutdown();
+    m.gcode->setAbort();
+    m.gcode->setReset();
+    disconnect(m.gcode, 0, this, 0);
+    // the abort ends a slot still running, the port is closed before the
+    // event loop of the engine stops
+    if (m.portOpen)
+        QMetaObject::invokeMethod(m.gcode, "closePort", Qt::BlockingQueuedConnection);
+
+    // 'deleteLater()' of the engine runs when the thread ends
+    m.thread->quit();
+    m.thread->wait();
+    delete m.thread;
+
+    emit machinesChanged();
+}
+
+void MachineManager::setControlParams(const ControlParams& params)
+{
+    controlParams = params;
+    foreach (const Machine& m, machines)
+    {
+        QMetaObject::invokeMethod(m.gcode, "setResponseWait", Qt::QueuedConnection,
+                                  Q_ARG(ControlParams, controlParams));
+    }
+}
+
+// calls : 'MainWindow::openPortCtl()':1, 'MainWindow::portIsClosed()':1
+void MachineManager::setMainPort(const QString& port)
+{
+    mainPort = port;
+}
+
+void MachineManager::setInMemoryLimit(qint64 bytes)
+{
+    inMemoryLimit = bytes;
+}
+
+void MachineManager::openPort(int index)
+{
+    if (index < 0 || index >= machines.size())
+        return;
+
+    const Machine& m = machines.at(index);
+    QMetaObject::invokeMethod(m.gcode, "openPort", Qt::QueuedConnection,
+                              Q_ARG(QString, m.port), Q_ARG(QString, m.baudRate));
+}
+
+void MachineManager::closePort(int index)
+{
+    if (index < 0 || index >= machines.size())
+        return;
+
+    QMetaObject::invokeMethod(machines.at(index).gcode, "closePort", Qt::QueuedConnection);
+}
+
+void MachineManager::sendFile(int index, const QString& path)
+{
+    if (index < 0 || index >= machines.size() || !machines.at(index).portOpen)
+        return;
+
+    machines[index].file = path;
+    QMetaObject::invokeMethod(machines.at(index).gcode, "sendFile", Qt::QueuedConnection,
+                              Q_ARG(QString, path), Q_ARG(bool, false));
+}
+
+// calls : 'MachineDashboard::recoverInterruptedJob()':1
+void MachineManager::setResume(int index, const QString& path, int line)
+{
+    if (index < 0 || index >= machines.size())
+        return;
+
+    machines[index].resumeFile = path;
+    machines[index].resumeLine = line;
+}
+
+// Like 'MainWindow::begin()' after 'MainWindow::recoverInterruptedJob()' :
+// the file is read again for the offset of the line and the modal state
+// and position in force before it.
+// calls : 'MachineDashboard::sendFile()':1
+void MachineManager::resumeJob(int index)
+{
+    if (index < 0 || index >= machines.size() || !machines.at(index).portOpen)
+        return;
+
+    Machine& m = machines[index];
+    QString path = m.resumeFile;
+    int line = m.resumeLine;
+    m.resumeLine = 0;
+    if (line <= 1)
+    {
+        sendFile(index, path);
+        return;
+    }
+
+    ProgramAnalysis analysis = ProgramAnalyzer::analyze(path, inMemoryLimit);
+    if (!analysis.valid || line > analysis.lineCount)
+    {
+        warn(qPrintable(tr("Interrupted job '%s' can't be resumed at line %d")), qPrintable(path), line);
+        return;
+    }
+
+    m.file = path;
+    QMetaObject::invokeMethod(m.gcode, "sendFileFrom", Qt::QueuedConnection,
+                              Q_ARG(QString, path), Q_ARG(bool, false), Q_ARG(int, line),
+                              Q_ARG(qint64, analysis.index->lineOffset(line - 1)),
+                              Q_ARG(int, analysis.lineCount),
+                              Q_ARG(QStringList, analysis.resumePreamble(line)));
+}
+
+void MachineManager::stop(int index)
+{
+    if (index < 0 || index >= machines.size())
+        return;
+
+    // like 'MainWindow::stop()', the flag is read by the sending loop
+    machines.at(index).gcode->setAbort();
+}
+
+// calls : 'MainWindow::closeEvent()':1, 'MachineManager::~MachineManager()':1
+void MachineManager::shutdown()
+{
+    while (!machines.isEmpty())
+        removeMachine(machines.size() - 1);
+}
+
+int MachineManager::indexOfSender() const
+{
+    for (int i = 0; i < machines.size(); i++)
+    {
+        if (machines.at(i).gcode == sender())
+            return i;
+    }
+    return -1;
+}
+
+void MachineManager::portOpened()
+{
+    int index = indexOfSender();
+    if (index >= 0)
+        machines[index].portOpen = true;
+}
+
+void MachineManager::portClosed()
+{
+    int index = indexOfSender();
+    if (index >= 0)
+        machines[index].portOpen = false;
+}
+
+void MachineManager::receiveMessage(QString line)
+{
+    int index = indexOfSender();
+    if (index >= 0)
+        machines[index].lastMessage = line;
+}
+
+void MachineManager::receiveChunk(QStringList list)
+{
+    int index = indexOfSender();
+    if (index >= 0 && !list.isEmpty())
+        machines[index].lastMessage = list.last();
+}
@@ -0,0 +1,97 @@
+/****************************************************************
+ * machinemanager.h
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#ifndef MACHINEMANAGER_H
+#define MACHINEMANAGER_H
+
+#include <QObject>
+#include <QList>
+#include <QThread>
+
+#include "gcode.h"
+#include "controlparams.h"
+
+// one journal for each additional machine, '%1' is the port
+#define MACHINE_JOURNAL_FILE    "/GrblController-job-%1.journal"
+#define MACHINE_MAX_COUNT       16
+
+// One Grbl controller : its own 'GCode' engine in its own thread
+class Machine
+{
+public:
+    Machine() : gcode(NULL), thread(NULL), portOpen(false), resumeLine(0) {}
+
+public:
+    GCode *gcode;
+    QThread *thread;
+    QString port;
+    QString baudRate;
+    QString file;
+    bool portOpen;
+    // last line sent to the log, the whole log is not kept here
+    QString lastMessage;
+    // interrupted job of the journal sent by 'resumeJob()', 0 for none
+    QString resumeFile;
+    int resumeLine;
+};
+
+// Runs several 'GCode' engines at the same time. Each engine streams in
+// its own thread; the GUI only reads their 'Telemetry' when it paints,
+// so a busy machine doesn't queue events that would slow down the others.
+class MachineManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    MachineManager(JournalSync *sync, QObject *parent = 0);
+    ~MachineManager();
+
+    int count() const;
+    const Machine& machine(int index) const;
+    int indexOfPort(const QString& port) const;
+
+    // returns the index of the machine, -1 if not possible
+    int addMachine(const QString& port, const QString& baudRate);
+    void removeMachine(int index);
+    void setControlParams(const ControlParams& params);
+    // port of the main window, never given to a machine, empty if none
+    void setMainPort(const QString& port);
+    // see 'ProgramAnalyzer::analyze()', for the jobs resumed
+    void setInMemoryLimit(qint64 bytes);
+
+    void openPort(int index);
+    void closePort(int index);
+    void sendFile(int index, const QString& path);
+    // the interrupted job of the journal of the machine, from 'line'
+    void setResume(int index, const QString& path, int line);
+    void resumeJob(int index);
+    void stop(int index);
+    void shutdown();
+
+signals:
+    void machinesChanged();
+
+private slots:
+    void portOpened();
+    void portClosed();
+    void receiveMessage(QString line);
+    void receiveChunk(QStringList list);
+
+private:
+    int indexOfSender() const;
+
+private:
+    JournalSync *journalSync;
+    QList<Machine> machines;
+    ControlParams controlParams;
+    QString mainPort;
+    qint64 inMemoryLimit;
+};
+
+#endif // MACHINEMANAGER_H
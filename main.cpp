@@ -12,6 +12,9 @@
 #else
 #include <QtWidgets/QApplication>
 #endif
+#include <QCommandLineParser>
+#include "headless.h"
+#include "asyncfileappender.h"
 
 enum GC_LOG_TYPES
 {
@@ -23,11 +26,12 @@ enum GC_LOG_TYPES
 };
 
 void logit(GC_LOG_TYPES type, const char *str, va_list args);
+int runHeadless(int argc, char *argv[]);
 
 FILE *pDebugLogFile = NULL;
 AtomicIntBool g_enableDebugLog;
 Log4Qt::PatternLayout *p_layout;
-Log4Qt::FileAppender *p_fappender;
+AsyncFileAppender *p_fappender;
 
 int main(int argc, char *argv[])
 {
@@ -50,8 +54,8 @@ int main(int argc, char *argv[])
     p_appender->activateOptions();
     Log4Qt::Logger::rootLogger()->addAppender(p_appender);
 
-    // Create a file appender
-    p_fappender = new Log4Qt::FileAppender();
+    // Create a file appender, written by its own thread
+    p_fappender = new AsyncFileAppender();
     p_fappender->setLayout(p_layout);
     p_fappender->setThreshold(Log4Qt::Level::TRACE_INT);
     p_fappender->setFile(QDir::homePath() + "/GrblController.log");
@@ -60,6 +64,22 @@ int main(int argc, char *argv[])
     //p_fappender->activateOptions();
     //Log4Qt::Logger::rootLogger()->addAppender(p_fappender);
 
+    // '--stream' : no widget, no OpenGL
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--stream"))
+        {
+            int result = runHeadless(argc, argv);
+            p_fappender->close();
+            if (pDebugLogFile != NULL)
+            {
+                fclose(pDebugLogFile);
+                pDebugLogFile = NULL;
+            }
+            return result;
+        }
+    }
+
     QApplication a(argc, argv);
 
     QString locale = QLocale::system().name().section('_', 0, 0);
@@ -90,6 +110,8 @@ int main(int argc, char *argv[])
 
     int result = a.exec();
 
+    // what is still queued reaches the file
+    p_fappender->close();
     if (pDebugLogFile != NULL)
     {
         fclose(pDebugLogFile);
@@ -98,6 +120,59 @@ int main(int argc, char *argv[])
     return result;
 }
 
+// GrblController --port <port> [--baud <rate>] [--check] [--follow]
+//                [--prebuffer <lines>] --stream <file>|-
+int runHeadless(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setOrganizationName(COMPANY_NAME);
+    QCoreApplication::setOrganizationDomain(DOMAIN_NAME);
+    QCoreApplication::setApplicationName(APPLICATION_NAME);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QObject::tr("Streams a G-code file to Grbl without the user interface."));
+    parser.addHelpOption();
+    QCommandLineOption portOption("port", QObject::tr("Serial port of Grbl."), "port");
+    QCommandLineOption baudOption("baud", QObject::tr("Baud rate, 9600 by default."), "rate", "9600");
+    QCommandLineOption streamOption("stream", QObject::tr("File to send, a named pipe, or - for the standard input."), "file");
+    QCommandLineOption checkOption("check", QObject::tr("Only check the file with Grbl ($C)."));
+    QCommandLineOption followOption("follow", QObject::tr("Send the file while it is written, up to M2 or M30."));
+    QCommandLineOption prebufferOption("prebuffer", QObject::tr("Lines of a stream read before the first one is sent."), "lines");
+    parser.addOption(portOption);
+    parser.addOption(baudOption);
+    parser.addOption(streamOption);
+    parser.addOption(checkOption);
+    parser.addOption(followOption);
+    parser.addOption(prebufferOption);
+    parser.process(a);
+
+    if (parser.value(portOption).isEmpty() || parser.value(streamOption).isEmpty())
+    {
+        fprintf(stderr, "%s\n", qPrintable(parser.helpText()));
+        return HEADLESS_EXIT_BAD_ARGS;
+    }
+
+    // file logging as configured in the GUI
+    QSettings settings;
+    QString sdbgLog = settings.value(SETTINGS_ENABLE_DEBUG_LOG, "true").value<QString>();
+    g_enableDebugLog.set(sdbgLog == "true");
+    if (g_enableDebugLog.get())
+    {
+        p_fappender->activateOptions();
+        Log4Qt::Logger::rootLogger()->addAppender(p_fappender);
+    }
+
+    // 0 : the value of the options dialog
+    int prebuffer = parser.value(prebufferOption).toInt();
+    HeadlessRunner runner(parser.value(portOption), parser.value(baudOption),
+                          parser.value(streamOption), parser.isSet(checkOption),
+                          parser.isSet(followOption), prebuffer);
+    // 'exit()' only works once the loop runs
+    QTimer::singleShot(0, &runner, SLOT(start()));
+
+    return a.exec();
+}
+
 
 //------------------------------
 void status(const char *str, ...)
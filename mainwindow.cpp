@@ -8,6 +8,11 @@
  ****************************************************************/
 
 #include <QDataStream>
+#include <QFileInfo>
+#include <QEventLoop>
+#include <QElapsedTimer>
+#include <QProgressDialog>
+#include <QtConcurrent/QtConcurrentRun>
 /// qt5
 #include <QPrinter>
 #include <QPrintDialog>
@@ -17,16 +22,23 @@
 #include "mainwindow.h"
 #include "version.h"
 #include "ui_mainwindow.h"
+#include "asyncfileappender.h"
 
-extern Log4Qt::FileAppender *p_fappender;
+extern AsyncFileAppender *p_fappender;
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
-    ui(new Ui::MainWindow), opt(this),
+    ui(new Ui::MainWindow),
+    machines(&journalSync), dashboard(NULL),
+    automation(gcode.getTelemetry(), this),
+    libraryDialog(NULL),
+    opt(this),
     open_button_text(tr("Open")),
     close_button_text(tr("Close")),
     absoluteAfterAxisAdj(false),
     checkLogWrite(false),
+    lineIndex(new LineIndex()),
+    inMemoryLimit((qint64)TOOLPATH_DEFAULT_LIMIT_MB << 20),
     sliderPressed(false),
     sliderTo(0.0),
     sliderZCount(0),
@@ -34,7 +46,10 @@ MainWindow::MainWindow(QWidget *parent) :
  //   scrollRequireMove(true), scrollPressed(false),
     queuedCommandsStarved(false), lastQueueCount(0), queuedCommandState(QCS_OK),
     lastLcdStateValid(true),
-    activeLine(0), cmdMan(false)
+    activeLine(0), cmdMan(false), resumeLine(0), automatedBegin(false),
+    rapidRateX(0), rapidRateY(0),
+    droDirty(false),
+    stockLine(0), stockDirty(false), stockFull(false)
 {
     // Setup our application information to be used by QSettings
     QCoreApplication::setOrganizationName(COMPANY_NAME);
@@ -44,6 +59,7 @@ MainWindow::MainWindow(QWidget *parent) :
     // required if passing the object by reference into signals/slots
     qRegisterMetaType<Coord3D>("Coord3D");
     qRegisterMetaType<PosItem>("PosItem");
+    qRegisterMetaType<ModalTimeline>("ModalTimeline");
     qRegisterMetaType<ControlParams>("ControlParams");
 
     ui->setupUi(this);
@@ -66,6 +82,10 @@ MainWindow::MainWindow(QWidget *parent) :
 
     runtimeTimer.moveToThread(&runtimeTimerThread);
 
+    gcode.getJournal()->open(QDir::homePath() + JOURNAL_FILE);
+    journalSync.addJournal(gcode.getJournal());
+    journalSync.moveToThread(&journalSyncThread);
+
     ui->lcdWorkNumberX->setDigitCount(8);
     ui->lcdMachNumberX->setDigitCount(8);
     ui->lcdWorkNumberY->setDigitCount(8);
@@ -153,6 +173,22 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(ui->spindleButton,SIGNAL(toggled(bool)),this,SLOT(toggleSpindle(bool)));
     connect(ui->chkRestoreAbsolute,SIGNAL(toggled(bool)),this,SLOT(toggleRestoreAbsolute()));
     connect(ui->actionOptions,SIGNAL(triggered()),this,SLOT(getOptions()));
+    connect(ui->actionMachines,SIGNAL(triggered()),this,SLOT(showMachines()));
+    connect(ui->actionJobLibrary,SIGNAL(triggered()),this,SLOT(showLibrary()));
+    connect(ui->actionQueueJobs,SIGNAL(triggered()),this,SLOT(queueJobs()));
+    connect(ui->actionNextJob,SIGNAL(triggered()),this,SLOT(loadNextJob()));
+    connect(ui->actionClearJobQueue,SIGNAL(triggered()),this,SLOT(clearJobQueue()));
+    connect(ui->actionOptimizePath,SIGNAL(triggered()),this,SLOT(optimizePath()));
+    connect(ui->actionOptimizeTravel,SIGNAL(triggered()),this,SLOT(optimizeTravel()));
+    connect(ui->actionSimulateStock,SIGNAL(triggered()),this,SLOT(simulateStock()));
+    connect(ui->actionShowStock,SIGNAL(toggled(bool)),this,SLOT(showStock(bool)));
+    connect(ui->actionShowStock,SIGNAL(toggled(bool)),ui->visu3D,SLOT(setStock(bool)));
+    connect(&stockTimer,SIGNAL(timeout()),this,SLOT(refreshStock()));
+    reloadTimer.setSingleShot(true);
+    reloadTimer.setInterval(PROGRAM_RELOAD_MSEC);
+    connect(&programWatcher,SIGNAL(fileChanged(QString)),this,SLOT(programChanged(QString)));
+    connect(&reloadTimer,SIGNAL(timeout()),this,SLOT(reloadProgram()));
+    connect(&jobQueue,SIGNAL(changed()),this,SLOT(jobQueueChanged()));
     connect(ui->actionExit,SIGNAL(triggered()),this,SLOT(close()));
     connect(ui->actionAbout,SIGNAL(triggered()),this,SLOT(showAbout()));
 
@@ -164,6 +200,8 @@ MainWindow::MainWindow(QWidget *parent) :
 
 /// T3
     connect(this, SIGNAL(sendFile(QString, bool)), &gcode, SLOT(sendFile(QString, bool)));
+    connect(this, SIGNAL(sendFileFrom(QString, bool, int, qint64, int, QStringList)),
+            &gcode, SLOT(sendFileFrom(QString, bool, int, qint64, int, QStringList)));
     connect(this, SIGNAL(openPort(QString,QString)), &gcode, SLOT(openPort(QString,QString)));
     connect(this, SIGNAL(closePort()), &gcode, SLOT(closePort()));
     connect(this, SIGNAL(sendGcode(QString)), &gcode, SLOT(sendGcode(QString)));
@@ -172,6 +210,7 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(this, SIGNAL(setResponseWait(ControlParams)), &gcode, SLOT(setResponseWait(ControlParams)));
     connect(this, SIGNAL(shutdown()), &gcodeThread, SLOT(quit()));
     connect(this, SIGNAL(shutdown()), &runtimeTimerThread, SLOT(quit()));
+    connect(this, SIGNAL(shutdown()), &journalSyncThread, SLOT(quit()));
     connect(this, SIGNAL(setProgress(int)), ui->progressFileSend, SLOT(setValue(int)));
     connect(this, SIGNAL(setRuntime(QString)), ui->outputRuntime, SLOT(setText(QString)));
     connect(this, SIGNAL(sendSetHome()), &gcode, SLOT(grblSetHome()));
@@ -202,24 +241,21 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(&gcode, SIGNAL(addList(QString)),this,SLOT(receiveList(QString)));
     connect(&gcode, SIGNAL(addListFull(QStringList)),this,SLOT(receiveListFull(QStringList)));
     connect(&gcode, SIGNAL(addListOut(QString)),this,SLOT(receiveListOut(QString)));
+    connect(&gcode, SIGNAL(addListChunk(QStringList)),this,SLOT(receiveListChunk(QStringList)));
     connect(&gcode, SIGNAL(stopSending()), this, SLOT(stopSending()));
     connect(&gcode, SIGNAL(setCommandText(QString)), ui->comboCommand->lineEdit(), SLOT(setText(QString)));
-    connect(&gcode, SIGNAL(setProgress(int)), ui->progressFileSend, SLOT(setValue(int)));
-    connect(&gcode, SIGNAL(setQueuedCommands(int, bool)), this, SLOT(setQueuedCommands(int, bool)));
     connect(&gcode, SIGNAL(adjustedAxis()), this, SLOT(adjustedAxis()));
     connect(&gcode, SIGNAL(resetTimer(bool)), &runtimeTimer, SLOT(resetTimer(bool)));
     connect(&gcode, SIGNAL(enableGrblDialogButton()), this, SLOT(enableGrblDialogButton()));
-    connect(&gcode, SIGNAL(updateCoordinates(Coord3D,Coord3D)), this, SLOT(updateCoordinates(Coord3D,Coord3D)));
 /// T4  3D animator
     connect(ui->visu3D, SIGNAL(updateLCD(QVector3D)), this, SLOT(updateLCD(QVector3D)));
    // connect(&gcode, SIGNAL(setLastState(QString)), ui->outputLastState, SLOT(setText(QString)));
     connect(&gcode, SIGNAL(setLastState(QString)), this, SLOT(setLastState(QString)));
     connect(&gcode, SIGNAL(setUnitMmAll(bool)), this, SLOT(setUnitMmAll(bool)));
+    connect(&gcode, SIGNAL(setRapidRates(double,double)), this, SLOT(setRapidRates(double,double)));
 
     /// 2D
-    connect(&gcode, SIGNAL(setLivePoint(double, double, bool, bool)), ui->wgtVisualizer, SLOT(setLivePoint(double, double, bool, bool)));
     connect(&gcode, SIGNAL(setVisualLivenessCurrPos(bool)), ui->wgtVisualizer, SLOT(setVisualLivenessCurrPos(bool)));
-    connect(&gcode, SIGNAL(setVisCurrLine(int)), ui->wgtVisualizer, SLOT(setVisCurrLine(int)));
 /// T4  for visu3D
     connect(&gcode, SIGNAL(setLivePoint(QVector3D)), ui->visu3D, SLOT(setLivePoint(QVector3D)));
   //  connect(this, SIGNAL(setLiveRelPoint(QVector3D)), ui->visu3D, SLOT(setLiveRelPoint(QVector3D)));
@@ -229,18 +265,27 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(&runtimeTimer, SIGNAL(setRuntime(QString)), ui->outputRuntime, SLOT(setText(QString)));
 /// T2
 	connect(&gcode, SIGNAL(setVersionGrbl(QString)), ui->GrblVersion, SLOT(setText(QString)));
-/// T3
-    connect(&gcode, SIGNAL(setLinesFile(QString, bool)), this, SLOT(setLinesFile(QString, bool)));
+/// progress, current line, queue and position are sampled, not signaled
+    connect(&telemetryTimer, SIGNAL(timeout()), this, SLOT(refreshTelemetry()));
+/// live updates of the views are painted once per frame
+    connect(&frameScheduler, SIGNAL(frame()), this, SLOT(renderFrame()));
+    ui->wgtVisualizer->setFrameScheduler(&frameScheduler);
+    ui->visu3D->setFrameScheduler(&frameScheduler);
+    ui->visuGcode->setFrameScheduler(&frameScheduler);
 /// T4 for visuGcode
-    connect(ui->visuGcode, SIGNAL(cursorPositionChanged() ), this, SLOT(on_cursorVisuGcode()) ) ;
+    connect(ui->visuGcode, SIGNAL(lineActivated(int) ), this, SLOT(on_cursorVisuGcode(int)) ) ;
     connect(this, SIGNAL(setLineCode(QString) ), ui->lineCode, SLOT(setText(QString)) ) ;
     connect(this, SIGNAL(setNumLine(QString) ), ui->visu3D, SLOT(setNumLine(QString)) ) ;
-    connect(&gcode, SIGNAL(setNumLine(QString) ), ui->visu3D, SLOT(setNumLine(QString)) ) ;
     connect(ui->visu3D, SIGNAL(setLineNum(QString) ), ui->lineCode, SLOT(setText(QString)) ) ;
     connect(this, SIGNAL(setTotalNumLine(QString) ), ui->visu3D, SLOT(setTotalNumLine(QString)) ) ;
-    connect(this, SIGNAL(setFeedRateToLine(QList<double>)), ui->visu3D, SLOT(setFeedRateToLine(QList<double>))) ;
-    connect(this, SIGNAL(setSpeedSpindleToLine(QList<double>)), ui->visu3D, SLOT(setSpeedSpindleToLine(QList<double>))) ;
+    connect(this, SIGNAL(setModalTimeline(ModalTimeline)), ui->visu3D, SLOT(setModalTimeline(ModalTimeline))) ;
+    connect(this, SIGNAL(setReferenceItems(QList<PosItem>)), ui->visu3D, SLOT(setReferenceItems(QList<PosItem>))) ;
+    connect(this, SIGNAL(setStockMap(StockMap)), ui->visu3D, SLOT(setStockMap(StockMap))) ;
+    connect(ui->actionShowOriginal, SIGNAL(toggled(bool)), ui->visu3D, SLOT(setReference(bool))) ;
     connect(ui->visu3D, SIGNAL(setActiveLineVisuGcode(int, bool)), this, SLOT(setActiveLineVisuGcode(int, bool)) );
+    connect(ui->visu3D, SIGNAL(linePicked(int)), this, SLOT(pickLine(int)) );
+    connect(ui->wgtVisualizer, SIGNAL(linePicked(int)), this, SLOT(pickLine(int)) );
+    connect(&segmentWatcher, SIGNAL(finished()), this, SLOT(segmentIndexReady()) );
 /// T4 for animator
     connect(ui->visualButton, SIGNAL(toggled(bool) ), this, SLOT(toVisual(bool)) ) ;
     connect(this, SIGNAL(setVisual(bool) ), ui->visu3D, SLOT(setVisual(bool)) ) ;
@@ -251,8 +296,12 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(this, SIGNAL(runCode(bool, int) ), ui->visu3D, SLOT(runCode(bool, int)) ) ;
     connect(this, SIGNAL(setPosReqKind(int)), &gcode, SLOT(setPosReqKind(int)) );
 
-    connect(ui->dialPeriodRepeat, SIGNAL(valueChanged(int)),ui->visu3D,SLOT(setPeriod(int)));
-    connect(ui->dialPeriodRepeat, SIGNAL(valueChanged(int)),ui->lcdPeriodAnim, SLOT(display(int)));
+    connect(ui->dialSpeedAnim, SIGNAL(valueChanged(int)),ui->visu3D,SLOT(setSpeed(int)));
+    connect(ui->dialSpeedAnim, SIGNAL(valueChanged(int)),ui->lcdSpeedAnim, SLOT(display(int)));
+    connect(ui->visu3D, SIGNAL(setSimTime(QString)), ui->labelSimTime, SLOT(setText(QString)) );
+    connect(ui->visu3D, SIGNAL(setSimProgress(int)), ui->sliderSimTime, SLOT(setValue(int)) );
+    connect(ui->sliderSimTime, SIGNAL(valueChanged(int)), ui->visu3D, SLOT(seekProgress(int)) );
+    connect(this, SIGNAL(setRapidRate(double)), ui->visu3D, SLOT(setRapidRate(double)) );
 
     connect(ui->visu3D, SIGNAL(setPauseVisual(bool)), ui->pauseButton, SLOT(setChecked(bool)) );
 
@@ -271,7 +320,9 @@ MainWindow::MainWindow(QWidget *parent) :
 /// end connect
     /// start threads
     runtimeTimerThread.start();
+    journalSyncThread.start();
     gcodeThread.start();
+    telemetryTimer.start(TELEMETRY_REFRESH_MSEC);
 
     queuedCommandsEmptyTimer.start();
     queuedCommandsRefreshTimer.start();
@@ -417,15 +468,72 @@ MainWindow::MainWindow(QWidget *parent) :
     /// associate 'menuTool' and 'toolButton'
     ui->toolButton->setMenu(menuTool);
 /// T4
-    // period animation mS
-    ui->dialPeriodRepeat->setValue(100);
+    // animation : one minute of machining per second
+    ui->dialSpeedAnim->setValue(60);
 
 /// <-- T4  call 'setUnitMmAll(..)'
     emit setResponseWait(controlParams);
+    machines.setControlParams(controlParams);
+
+    automation.listen();
+    // the next job is analyzed as soon as the window is up
+    jobQueue.restore();
+
+    recoverInterruptedJob();
+}
+
+// The journal of the last session still shows a job running : the host
+// stopped in the middle of a file. One prompt reloads the file and
+// selects the first line that may not have run, see 'JobJournal::resumeLine()'.
+// calls : 'MainWindow::MainWindow()':1
+void MainWindow::recoverInterruptedJob()
+{
+    JobJournal *journal = gcode.getJournal();
+    if (!journal->interrupted())
+        return;
+
+    QString path = journal->jobFile();
+    int line = journal->resumeLine();
+    if (!QFile::exists(path))
+    {
+        warn(qPrintable(tr("Interrupted job '%s' no longer exists")), qPrintable(path));
+        journal->finish();
+        return;
+    }
+
+    Coord3D work = journal->workPosition();
+    QMessageBox msgBox;
+    msgBox.setText(tr("The job '%1' was interrupted after line %2 of %3 "
+                      "was acknowledged by Grbl (work position %4, %5, %6).\n\n"
+                      "Grbl acknowledges a line when it is planned, not when it has run : "
+                      "line %7 is a conservative resume point, the lines %7 to %2 may "
+                      "run a second time.\n\n"
+                      "Load it and resume at line %7 once the port is open?")
+                   .arg(path).arg(journal->ackedLine()).arg(journal->totalLines())
+                   .arg(work.x).arg(work.y).arg(work.z).arg(line));
+    msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
+    msgBox.setDefaultButton(QMessageBox::Yes);
+    if (msgBox.exec() != QMessageBox::Yes)
+    {
+        journal->finish();
+        return;
+    }
+
+    loadFile(path);
+    if (line > 1 && line <= lineIndex->lineCount())
+    {
+        setActiveLineVisuGcode(line, false);
+        resumeLine = line;
+    }
 }
 
 MainWindow::~MainWindow()
 {
+    if (segmentWatcher.isRunning())
+    {
+        segmentWatcher.waitForFinished();
+        delete segmentWatcher.result();
+    }
     delete ui;
 }
 
@@ -435,6 +543,7 @@ void MainWindow::closeEvent(QCloseEvent *event)
     gcode.setShutdown();
     gcode.setAbort();
     gcode.setReset();
+    machines.shutdown();
 
     writeSettings();
 
@@ -491,7 +600,36 @@ void MainWindow::begin()
     resetProgress();
 
     int ret = QMessageBox::No;
-    if (!checkState) {
+    // resume at the line selected in 'visuGcode'
+    int startLine = 1;
+    bool automated = automatedBegin;
+    automatedBegin = false;
+    if (automated)
+    {
+        // requested through 'automation', nobody to answer a prompt
+        startLine = qBound(1, resumeLine, lineIndex->lineCount());
+        resumeLine = 0;
+    }
+    else
+    if (resumeLine > 1 && resumeLine <= lineIndex->lineCount())
+    {
+        // already confirmed by 'recoverInterruptedJob()'
+        startLine = resumeLine;
+        resumeLine = 0;
+    }
+    else
+    if (activeLine > 1 && activeLine <= lineIndex->lineCount())
+    {
+        QMessageBox msgBox;
+        msgBox.setText(tr("Start at line %1 instead of the beginning of the file?").arg(activeLine));
+        msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::No | QMessageBox::Cancel);
+        msgBox.setDefaultButton(QMessageBox::No);
+        ret = msgBox.exec();
+        if (ret == QMessageBox::Yes)
+            startLine = activeLine;
+    }
+    // the work position is kept when resuming
+    if (!checkState && !automated && startLine == 1 && ret != QMessageBox::Cancel) {
         if((ui->lcdWorkNumberX->value()!=0)||(ui->lcdWorkNumberY->value()!=0)||(ui->lcdWorkNumberZ->value()!=0)
             || (ui->lcdWorkNumberFourth->value()!=0))
         {
@@ -532,7 +670,14 @@ void MainWindow::begin()
         // commands 'tabVisu'
         enableTabVisuControls(false);
 
-        emit sendFile(ui->filePath->text(), checkState);
+        if (startLine > 1)
+        {
+            emit sendFileFrom(ui->filePath->text(), checkState, startLine,
+                              lineIndex->lineOffset(startLine - 1), lineIndex->lineCount(),
+                              program.resumePreamble(startLine));
+        }
+        else
+            emit sendFile(ui->filePath->text(), checkState);
     }
 }
 
@@ -593,6 +738,96 @@ void MainWindow::pauseSend(bool valid)
     // color 'pauseButton'
     ui->btnPause->setPalette(palette);
 }
+//------------------------------------------
+// Requests of 'automation' go through the same paths as the buttons
+// calls : 'AutomationServer::handle()':1
+bool MainWindow::automationSubmit(const QString& file, QString& error)
+{
+    // 'runFile' stays set after the end of a file, 'Stop' does not
+    if (ui->Stop->isEnabled())
+    {
+        error = tr("A file is being sent");
+        return false;
+    }
+    QFileInfo info(file);
+    if (!info.isFile() || !info.isReadable())
+    {
+        error = tr("Can't read '%1'").arg(file);
+        return false;
+    }
+
+    loadFile(info.absoluteFilePath());
+    if (!lineIndex->isOpen())
+    {
+        error = tr("Can't open '%1'").arg(file);
+        return false;
+    }
+    return true;
+}
+
+// calls : 'AutomationServer::handle()':1
+bool MainWindow::automationStart(int line, QString& error)
+{
+    if (!lineIndex->isOpen() || !ui->Begin->isEnabled())
+    {
+        error = openState ? tr("No file to send") : tr("Port is closed");
+        return false;
+    }
+    if (line < 1 || line > lineIndex->lineCount())
+    {
+        error = tr("Line %1 out of range").arg(line);
+        return false;
+    }
+
+    automatedBegin = true;
+    resumeLine = line;
+    begin();
+    return true;
+}
+
+// calls : 'AutomationServer::handle()':1
+bool MainWindow::automationPause(bool pause, QString& error)
+{
+    if (!ui->Stop->isEnabled() || !ui->btnPause->isEnabled())
+    {
+        error = tr("No file is being sent");
+        return false;
+    }
+    // checked : running, see 'pauseSend()'
+    ui->btnPause->setChecked(!pause);
+    return true;
+}
+
+// calls : 'AutomationServer::handle()':1
+bool MainWindow::automationAbort(QString& error)
+{
+    if (!ui->Stop->isEnabled())
+    {
+        error = tr("No file is being sent");
+        return false;
+    }
+    stop();
+    return true;
+}
+
+// calls : 'AutomationServer::handle()':1
+void MainWindow::automationSettingsChanged()
+{
+    setSettingsOptions();
+}
+
+// calls : 'AutomationServer::telemetryValues()':1
+QVariantMap MainWindow::automationState()
+{
+    QVariantMap state;
+    state.insert("portOpen", openState);
+    state.insert("port", lastOpenPort);
+    state.insert("file", lineIndex->isOpen() ? lineIndex->fileName() : QString());
+    state.insert("check", checkState);
+    state.insert("sending", ui->Stop->isEnabled());
+    state.insert("paused", ui->Stop->isEnabled() && !ui->btnPause->isChecked());
+    return state;
+}
 
 void MainWindow::grblHelp()
 {
@@ -706,6 +941,10 @@ void MainWindow::goHomeSafe()
 // slot called from GCode class to update our state
 void MainWindow::stopSending()
 {
+    // last progress and position published before the stop
+    refreshTelemetry();
+    // 'stop()' clears 'runFile', a lost port leaves the journal open
+    bool completed = runFile && !checkState && !gcode.getJournal()->interrupted();
     ui->tabAxisVisualizer->setEnabled(true);
     // valid manual controls
     enableManualControl(true);
@@ -740,6 +979,10 @@ void MainWindow::stopSending()
 /// T4
     // commands 'tabVisu'
     enableTabVisuControls(true);
+
+    // changeover : the next program was prepared while this one ran
+    if (completed)
+        loadNextJob();
 }
 
 // User has asked to open the port
@@ -775,8 +1018,17 @@ void MainWindow::resetProgress()
 
 void MainWindow::openPortCtl()
 {
+        // a port is driven by a single engine, see 'MachineManager'
+        if (machines.indexOfPort(ui->cmbPort->currentText()) != -1)
+        {
+            QMessageBox::warning(this, windowTitle(),
+                                 tr("The port '%1' is used by a machine of the dashboard.")
+                                 .arg(ui->cmbPort->currentText()));
+            return;
+        }
 
         portStr = ui->cmbPort->currentText();
+        machines.setMainPort(portStr);
         QString baudRate = ui->comboBoxBaudRate->currentText();
 
         ui->labelLines->setEnabled(false);
@@ -907,6 +1159,7 @@ void MainWindow::portIsClosed()
 
 /// T4
     openState =  false;
+    machines.setMainPort(QString());
 }
 
 // slot that tells us the gcode thread successfully opened the port
@@ -1198,7 +1451,7 @@ void MainWindow::openFile()
 {
     QFileDialog dialog(this, tr("Open File"),
                        directory,
-                       tr("NC (*.nc);;All Files (*.*)"));
+                       tr("NC (*.nc);;Compressed NC (*.nc.gz *.nc.zst);;All Files (*.*)"));
 
     dialog.setFileMode(QFileDialog::ExistingFile);
 
@@ -1223,6 +1476,14 @@ void MainWindow::openFile()
         resetProgress();
     }
 
+    loadFile(fileName);
+}
+
+// calls : 'MainWindow::openFile()':1, 'MainWindow::recoverInterruptedJob()':1
+void MainWindow::loadFile(QString fileName)
+{
+    resumeLine = 0;
+
     int slash = fileName.lastIndexOf('/');
     if (slash == -1)
     {
@@ -1284,301 +1545,121 @@ void MainWindow::openFile()
 
 void MainWindow::preProcessFile(QString filepath)
 {
-    QFile file(filepath);
-    if (file.open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        QTextStream code(&file);
-        posList.clear();
-/// T4
-
-        ui->visuGcode->clear() ;
-        int plane = NO_PLANE;
-        double x, y, z, i,  j, k ;
-        x=y=z=i=j=k=0;
-        QVector3D xyz, ijk;
-        int p = 0;    // arc revolutions
-        int g = 0;
-        bool helix = false;
-    // feedrate 'Fxxxx'
-        double fr, prevfr = 0.0;
-        QList<double> feedRateToLine;
-        feedRateToLine.append(prevfr);// case 0
-    // Spindle Speed   Sxxxxx
-        double ss, prevss = 0.0;
-        QList<double> speedSpindleToLine;
-        speedSpindleToLine.append(prevss); // case 0
-
-/// T4 animator
-        QString codeText;
-        QString line;
-        bool arc = false, cw = false, mm = true;
-        int index = 0;
-       // bool zeroInsert = false;  // ???
-        bool zeroInsert = true;
-        QString strline;
-        /// total lines
-        QString alltext = code.readAll() ;
-        totalLinesFile = alltext.count(QChar('\n')) ;
-        QString strmax = QString().number(totalLinesFile);
-        int n = strmax.size();
-
-        code.seek(0);
-
-        do
-        {
-            strline = code.readLine();
-
-/// T4 test line analyze    TODO ...
-         //   line = gcode.removeUnsupportedCommands(strline);
-//diag("gcode:line = %s", qPrintable(line));
-///<--
-            index++;
-/// T4      construct strline with index
-            line = "%1";
-            line = line.arg(index, n , 10 , QChar(' ') ) + " : " + strline;
-            codeText.append(line + "\n");
-/// <--
-            GCode::trimToEnd(strline, '(');
-            GCode::trimToEnd(strline, ';');
-            GCode::trimToEnd(strline, '%');
-
-            strline = strline.trimmed();
-            g=0; p=0; fr=0.0; ss = 0.0;
-          if (strline.size() == 0)
-            {   // ignore the white lines
-
-            }
-            else
-            {
-                strline = strline.toUpper();
-                strline.replace("M6", "M06");
-                strline.replace(QRegExp("([A-Z])"), " \\1");
-                strline.replace(QRegExp("\\s+"), " ");
-/// T4
-                if (processGCode(strline, x, y, z, i, j, k,
-                                  p, arc, cw, mm, g,
-                                  plane, helix, fr, ss
-                                  )
-                    )
-                {
-                    if (!zeroInsert)
-                    {
-                        // insert 0,0 position
-                        posList.append(PosItem());
-                        zeroInsert = true;
-                    }
-                    xyz = QVector3D(x, y, z); ijk = QVector3D(i,j,k);
-                    posList.append(PosItem(strline, xyz, ijk, p, arc, cw, mm, g, plane, helix, index, fr, ss));
-                }
-            }
-            /// Fxxxx
-            if (fr > 0)
-                prevfr = fr;
-            feedRateToLine.append(prevfr);
-            /// Sxxxx
-            if (ss > 0)
-                prevss = ss;
-            speedSpindleToLine.append(prevss);
-
-        } while (code.atEnd() == false);
-
-
-        /// number of lines
-        strline = QString().setNum(index) ;
-
-        ui->outputLines->setText(strline);
-        /// write all lines
-        ui->visuGcode->setPlainText(codeText);
-
-        file.close();
-
-        /// to 'ui-visu3D::setTotalNumLine(QString)'
-        emit setTotalNumLine(strline)  ;
-        /// to 'ui->wgtVisualizer::setItems(posList)' and 'ui->visu3D::setItems(posList)'
-       emit setItems(posList);
-        /// to to 'ui-visu3D::setFeedRateToLine(QList<double>)'
-        emit setFeedRateToLine(feedRateToLine);
-        /// to to 'ui-visu3D::setSpeedSpindleToLine(QList<double>)'
-       emit setSpeedSpindleToLine(speedSpindleToLine);
-        // the correct unit
-       setUseMm(mm);
-
-    }
-    else
-        printf("Can't open file\n");
+    // read in advance when the file comes from the job queue
+    ProgramAnalysis analysis;
+    if (!jobQueue.takePrepared(filepath, analysis))
+        analysis = ProgramAnalyzer::analyze(filepath, inMemoryLimit);
+    showProgram(analysis);
 }
 
-/// T4
-bool MainWindow::processGCode(QString inputLine,
-                            double& x, double& y, double& z,
-                            double& i, double& j, double& k,
-                            int& p, bool& arc, bool& cw, bool& mm, int& g,
-                            int& plane, bool& helix, double& f, double& sp
-                            )
-{
-    QString line = inputLine.toUpper();
-    QStringList components = line.split(" ", QString::SkipEmptyParts);
-    QString s;
-    arc = false;
-    bool valid = false;
-    f = 0.0;
-    sp = 0.0;
-    int nextIsValue = NO_ITEM;
-    int value;
-    bool bi(false), bj(false), bk(false);
-  //  bool bx(false), by(false), bz(false);
-    foreach (s, components)
-    {
-//diag("s= %s", qPrintable(s) );
-        if (s.at(0) == 'F') {
-            f = decodeLineItem(s, F_ITEM, valid, nextIsValue);
-        }
-        else
-        if (s.at(0) == 'S') {
-            sp = decodeLineItem(s, S_ITEM, valid, nextIsValue);
-        }
-        else
-        if (s.at(0) == 'G')
-        {
-            value = s.mid(1).toInt();
-            if (value >= 0 && value <= 3)
-            {
-                g = value;
-                if (value == 2)
-                    cw = true;
-                else if (value == 3)
-                    cw = false;
-            }
-            else if (value == 20)
-                mm = false;
-            else if (value == 21)
-                mm = true;
-/// T4   for arcs
-            else if (value == 17)   // plane XY
-                plane = PLANE_XY_G17;
-            else if (value == 18)   // plane ZX
-                plane = PLANE_ZX_G19;
-            else if (value == 19)   // plane YZ
-                plane = PLANE_YZ_G18;
-        }
-        else if (g >= 0 && g <= 3 && s.at(0) == 'X')
-        {
-            x = decodeLineItem(s, X_ITEM, valid, nextIsValue);
-            helix = plane == PLANE_YZ_G18;
-        }
-        else if (g >= 0 && g <= 3 && s.at(0) == 'Y')
-        {
-            y = decodeLineItem(s, Y_ITEM, valid, nextIsValue);
-            helix = plane == PLANE_ZX_G19;
-        }
-/// T4
-        else if (g >= 0 && g <= 3 && s.at(0) == 'Z')
-        {
-            z = decodeLineItem(s, Z_ITEM, valid, nextIsValue);
-            helix = plane == PLANE_XY_G17;
-        }
-        else if ((g == 2 || g == 3) && s.at(0) == 'I')
-        {
-            i = decodeLineItem(s, I_ITEM, arc, nextIsValue);
-            bi = true;
-        }
-        else if ((g == 2 || g == 3) && s.at(0) == 'J')
-        {
-            j = decodeLineItem(s, J_ITEM, arc, nextIsValue);
-            bj = true;
-        }
-/// T4
-        else if ((g == 2 || g == 3) && s.at(0) == 'K')
-        {
-            k = decodeLineItem(s, K_ITEM, arc, nextIsValue);
-            bk = true;
-        }
-        else if ((g == 2 || g == 3) && s.at(0) == 'P')
-        {
-            p = decodeLineItem(s, P_ITEM, valid, nextIsValue);
-        }
-/// Fxxxx
-        else if ((g == 1 || g == 2 || g == 3) && s.at(0) == 'F')
-        {
-            f = decodeLineItem(s, F_ITEM, valid, nextIsValue);
-        }
-        else if ((g == 1 || g == 2 || g == 3) && s.at(0) == 'S')
-        {
-            sp = decodeLineItem(s, S_ITEM, valid, nextIsValue);
-        }
-/// <--
-        else if (nextIsValue != NO_ITEM)
-        {
-            switch (nextIsValue)
-            {
-            case X_ITEM:
-                x = decodeDouble(s, valid);
-                break;
-            case Y_ITEM:
-                y = decodeDouble(s, valid);
-                break;
-/// T4
-            case Z_ITEM:
-                z = decodeDouble(s, valid);
-                break;
-            case I_ITEM:
-                i = decodeDouble(s, arc);
-                break;
-            case J_ITEM:
-                j = decodeDouble(s, arc);
-                break;
-/// T4
-            case K_ITEM:
-                k = decodeDouble(s, arc);
-                break;
-            case P_ITEM:
-                p = decodeDouble(s, valid);
-                break;
-            case F_ITEM:
-                f = decodeDouble(s, valid);
-                break;
-            case S_ITEM:
-                sp = decodeDouble(s, valid);
-                break;
-            };
-            nextIsValue = NO_ITEM;
-        }
-        // plane if NO_PLANE
-        if (!(plane == PLANE_XY_G17 || plane == PLANE_YZ_G18 || plane == PLANE_ZX_G19) )
-        {
-            if (bi && bj && !bk)
-                plane = PLANE_XY_G17 ;
-            else
-            if (bi && !bj && bk)
-                plane = PLANE_ZX_G19 ;
-            else
-            if (!bi && bj && bk)
-                plane = PLANE_YZ_G18 ;
-        }
-    }
-    return valid;
+// The listing stops at once reading a file being written, the writer
+// may truncate it under the mapping : it is shown again when the program
+// is reloaded, after the writer and the job are done.
+// calls : 'programWatcher::fileChanged()'
+void MainWindow::programChanged(QString path)
+{
+    Q_UNUSED(path);
+    if (lineIndex->readsFile())
+        ui->visuGcode->setSource(NULL);
+    reloadTimer.start();
 }
 
-double MainWindow::decodeLineItem(const QString& item, const int next, bool& valid, int& nextIsValue)
+// The file is written again while it is sent, or by the CAM : only the
+// lines changed are parsed again, the views get the spliced moves.
+// Waits for the end of a job and for the writer to be done.
+// calls : 'reloadTimer::timeout()'
+void MainWindow::reloadProgram()
 {
-    if (item.size() == 1)
+    if (!program.valid || program.isCurrent())
     {
-        nextIsValue = next;
-        return 0;
+        // touched but not changed, see 'programChanged()'
+        if (lineIndex->readsFile() && lineIndex->isCurrent())
+            ui->visuGcode->setSource(lineIndex.data());
+        return;
     }
-    else
+    if (ui->Stop->isEnabled() || !QFileInfo(program.path).exists())
     {
-        nextIsValue = NO_ITEM;
-        return decodeDouble(item.mid(1,-1), valid);
+        reloadTimer.start();
+        return;
     }
+
+    ProgramAnalysis analysis = ProgramAnalyzer::reanalyze(program, inMemoryLimit);
+    showProgram(analysis);
+    if (analysis.valid)
+        receiveMsgSatusBar(tr("'%1' reloaded, %2 of %3 lines parsed again")
+                           .arg(QFileInfo(analysis.path).fileName())
+                           .arg(analysis.parsedLines).arg(analysis.lineCount));
 }
 
-double MainWindow::decodeDouble(QString value, bool& valid)
+// calls : 'preProcessFile()':1, 'reloadProgram()':1
+void MainWindow::showProgram(const ProgramAnalysis& analysis)
 {
-    if (value.indexOf(QRegExp("^[+-]?[0-9]*\\.?[0-9]*$")) == -1)
-        return 0;
-    valid = true;
-    return value.toDouble();
+    if (!analysis.valid)
+    {
+        printf("Can't open file\n");
+        return;
+    }
+
+    // a file replaced by a rename is no longer watched, added again
+    program = analysis;
+    if (!programWatcher.files().isEmpty())
+        programWatcher.removePaths(programWatcher.files());
+    bool stream = StreamSource::isStream(program.path);
+    if (!stream)
+        programWatcher.addPath(program.path);
+
+    /// the listing reads the text back from the index
+    ui->visuGcode->clear() ;
+    lineIndex = analysis.index;
+    totalLinesFile = lineIndex->lineCount() ;
+    posList = analysis.posList;
+    toolpathStore = analysis.store;
+    modalTimeline = analysis.modalTimeline;
+
+    /// number of lines
+    QString strline = QString().setNum(analysis.lineCount) ;
+
+    ui->outputLines->setText(strline);
+    /// show all lines
+    ui->visuGcode->setSource(lineIndex.data());
+
+    /// to 'ui-visu3D::setTotalNumLine(QString)'
+    emit setTotalNumLine(strline)  ;
+    // the pages of a large program, before the items that are then empty
+    ui->visu3D->setToolpathStore(toolpathStore);
+    /// to 'ui->wgtVisualizer::setItems(posList)' and 'ui->visu3D::setItems(posList)'
+    emit setItems(posList);
+    /// to 'ui-visu3D::setModalTimeline(ModalTimeline)'
+    emit setModalTimeline(modalTimeline);
+    if (!toolpathStore.isNull())
+        receiveMsgSatusBar(tr("Large program, %1 segments drawn from a cache file in the 3D view only")
+                           .arg(toolpathStore->segmentCount()));
+    if (stream)
+        receiveMsgSatusBar(tr("'%1' is a pipe, read when it is sent : no preview").arg(program.path));
+    // nothing to compare with, see 'optimizePath()'
+    emit setReferenceItems(QList<PosItem>());
+    ui->actionShowOriginal->setEnabled(false);
+    // picking waits for the segments of the new program
+    ui->wgtVisualizer->setSegmentIndex(NULL);
+    ui->visu3D->setSegmentIndex(NULL);
+    if (segmentWatcher.isRunning())
+    {
+        segmentWatcher.waitForFinished();
+        delete segmentWatcher.result();
+    }
+    segmentIndex.clear();
+    segmentWatcher.setFuture(QtConcurrent::run(&SegmentIndex::create, posList));
+    // the stock of the previous program is gone
+    stockFull = false;
+    if (ui->actionShowStock->isChecked())
+        prepareStockPreview();
+    else
+    {
+        stockPreview.setPath(QList<PosItem>(), 0);
+        emit setStockMap(StockMap());
+    }
+    // the correct unit
+    setUseMm(analysis.mm);
 }
 
 void MainWindow::readSettings()
@@ -1625,6 +1706,7 @@ void MainWindow::setSettingsOptionsUseMm()
     controlParams.xyRateAmount = opt.getXYRate();
     // update gcode thread with latest values
     emit setResponseWait(controlParams);
+    machines.setControlParams(controlParams);
 }
 
 // Slot called from settings 'Options' dialog after user made a change.
@@ -1636,13 +1718,20 @@ void MainWindow::setSettingsOptions()
     updateSettingsFromOptionDlg(settings);
     // update gcode thread with latest values
     emit setResponseWait(controlParams);
+    machines.setControlParams(controlParams);
 }
 
 // calls : 'setSettingsOptions()':1,
 void MainWindow::updateSettingsFromOptionDlg(QSettings& settings)
 {
 /// T4
-    ui->statusList->setMaximumBlockCount( settings.value( SETTINGS_MAX_STATUS_LINES, 0 ).value<int>() );
+    ui->statusList->setCapacity( settings.value( SETTINGS_MAX_STATUS_LINES, 0 ).value<int>() );
+    // large programs, for the next files loaded
+    inMemoryLimit = (qint64)settings.value( SETTINGS_IN_MEMORY_LIMIT_MB, TOOLPATH_DEFAULT_LIMIT_MB ).value<int>() << 20;
+    jobQueue.setInMemoryLimit(inMemoryLimit);
+    library.setInMemoryLimit(inMemoryLimit);
+    machines.setInMemoryLimit(inMemoryLimit);
+    ui->visu3D->setPageBudget( settings.value( SETTINGS_PAGE_BUDGET_MB, TOOLPATH_DEFAULT_BUDGET_MB ).value<int>() );
 
     QString sinvX = settings.value(SETTINGS_INVERSE_X, "false").value<QString>();
     QString sinvY = settings.value(SETTINGS_INVERSE_Y, "false").value<QString>();
@@ -1671,22 +1760,7 @@ void MainWindow::updateSettingsFromOptionDlg(QSettings& settings)
     invZ = sinvZ == "true";
     invFourth = sinvFourth == "true";
 
-    controlParams.waitTime = settings.value(SETTINGS_RESPONSE_WAIT_TIME, DEFAULT_WAIT_TIME_SEC).value<int>();
-    controlParams.zJogRate = settings.value(SETTINGS_Z_JOG_RATE, DEFAULT_Z_JOG_RATE).value<double>();
-    QString useMmManualCmds = settings.value(SETTINGS_USE_MM_FOR_MANUAL_CMDS, "true").value<QString>();
-    controlParams.useMm = useMmManualCmds == "true";
-    QString useAggrPreload = settings.value(SETTINGS_USE_AGGRESSIVE_PRELOAD, "true").value<QString>();
-    controlParams.useAggressivePreload = useAggrPreload == "true";
-    QString waitForJogToComplete = settings.value(SETTINGS_WAIT_FOR_JOG_TO_COMPLETE, "true").value<QString>();
-    controlParams.waitForJogToComplete = waitForJogToComplete == "true";
-
-    QString useFourAxis = settings.value(SETTINGS_FOUR_AXIS_USE, "false").value<QString>();
-    controlParams.useFourAxis = useFourAxis == "true";
-
-    char name = settings.value(SETTINGS_FOUR_AXIS_NAME, FOURTH_AXIS_A).value<char>();
-    controlParams.fourthAxisName = name;
-    bool rot = settings.value(SETTINGS_FOUR_AXIS_ROTATE, true).value<bool>();
-    controlParams.fourthAxisRotate = rot;
+    controlParams.load(settings);
 
     ui->lcdWorkNumberFourth->setEnabled(controlParams.useFourAxis);
     ui->lcdMachNumberFourth->setEnabled(controlParams.useFourAxis);
@@ -1748,46 +1822,8 @@ void MainWindow::updateSettingsFromOptionDlg(QSettings& settings)
         }
     }
 
-    QString zRateLimit = settings.value(SETTINGS_Z_RATE_LIMIT, "false").value<QString>();
-    controlParams.zRateLimit = zRateLimit == "true";
-
-    QString ffCommands = settings.value(SETTINGS_FILTER_FILE_COMMANDS, "false").value<QString>();
-    controlParams.filterFileCommands = ffCommands == "true";
-    QString rPrecision = settings.value(SETTINGS_REDUCE_PREC_FOR_LONG_LINES, "false").value<QString>();
-    controlParams.reducePrecision = rPrecision == "true";
-    controlParams.grblLineBufferLen = settings.value(SETTINGS_GRBL_LINE_BUFFER_LEN, DEFAULT_GRBL_LINE_BUFFER_LEN).value<int>();
-    controlParams.charSendDelayMs = settings.value(SETTINGS_CHAR_SEND_DELAY_MS, DEFAULT_CHAR_SEND_DELAY_MS).value<int>();
-
-    controlParams.zRateLimitAmount = settings.value(SETTINGS_Z_RATE_LIMIT_AMOUNT, DEFAULT_Z_LIMIT_RATE).value<double>();
-    controlParams.xyRateAmount = settings.value(SETTINGS_XY_RATE_AMOUNT, DEFAULT_XY_RATE).value<double>();
-
-    QString enPosReq = settings.value(SETTINGS_ENABLE_POS_REQ, "true").value<QString>();
-   // controlParams.usePositionRequest = enPosReq == "true";
-    controlParams.positionRequestType = settings.value(SETTINGS_TYPE_POS_REQ, PREQ_ALWAYS_NO_IDLE_CHK).value<QString>();
-    double posReqFreq = settings.value(SETTINGS_POS_REQ_FREQ_SEC, DEFAULT_POS_REQ_FREQ_SEC).value<double>();
-    controlParams.postionRequestTimeMilliSec = static_cast<int>(posReqFreq) * 1000;
-
-    controlParams.posReqKind =  settings.value(SETTINGS_POS_REQ_KIND, POS_REQ).value<int>();
-
 /// T4
     posReqKind = controlParams.posReqKind;
-    switch (posReqKind) {
-        case POS_REQ:
-            controlParams.usePositionRequest = true;
-            controlParams.positionSyncSimu = false;
-            controlParams.positionNoDisplay = false;
-            break;
-        case POS_SYNC:
-            controlParams.usePositionRequest = false;
-            controlParams.positionSyncSimu = true;
-            controlParams.positionNoDisplay = false;
-            break;
-        case POS_NO:
-            controlParams.usePositionRequest = false;
-            controlParams.positionSyncSimu = false;
-            controlParams.positionNoDisplay = true;
-            break;
-    }
     // -> 'gcode::setPosReqKind(posRegKind)'
     emit setPosReqKind(posReqKind) ;
 
@@ -1840,6 +1876,15 @@ void MainWindow::receiveListOut(QString msg)
     addToStatusList(false, msg);
 }
 
+// lines already trimmed and prefixed by 'GCode::queueList()'
+void MainWindow::receiveListChunk(QStringList list)
+{
+    if (list.isEmpty())
+        return;
+
+    ui->statusList->appendLines(list);
+}
+
 void MainWindow::addToStatusList(bool in, QString msg)
 {
     msg = msg.trimmed();
@@ -1854,12 +1899,12 @@ void MainWindow::addToStatusList(bool in, QString msg)
         nMsg = "> " + msg;
 
 
-   ui->statusList->appendPlainText( nMsg );
-  //  ui->statusList->insertPlainText( nMsg );
+    ui->statusList->appendLine( nMsg );
 }
 
 void MainWindow::addToStatusList(QStringList& list)
 {
+    QStringList lines;
     foreach (QString msg, list)
     {
         msg = msg.trimmed();
@@ -1869,10 +1914,11 @@ void MainWindow::addToStatusList(QStringList& list)
         if (msg.length() == 0)
             continue;
 
-        ui->statusList->appendPlainText( msg );
+        lines.append( msg );
 
         status("%s", qPrintable(msg) );
     }
+    ui->statusList->appendLines( lines );
 }
 
 void MainWindow::receiveMsgSatusBar(QString msg)
@@ -1890,6 +1936,363 @@ void MainWindow::grblSettings()
     dlg.exec();
 }
 
+// calls : 'ui->actionMachines::triggered()'
+void MainWindow::showMachines()
+{
+    if (dashboard == NULL)
+        dashboard = new MachineDashboard(&machines, this);
+    dashboard->show();
+    dashboard->raise();
+}
+
+// calls : 'ui->actionJobLibrary::triggered()'
+void MainWindow::showLibrary()
+{
+    if (libraryDialog == NULL)
+    {
+        libraryDialog = new JobLibraryDialog(&library, this);
+        connect(libraryDialog,SIGNAL(loadRequested(QString)),this,SLOT(loadFromLibrary(QString)));
+        connect(libraryDialog,SIGNAL(queueRequested(QStringList)),this,SLOT(addJobs(QStringList)));
+    }
+    libraryDialog->show();
+    libraryDialog->raise();
+}
+
+// calls : 'JobLibraryDialog::loadRequested()'
+void MainWindow::loadFromLibrary(QString path)
+{
+    if (ui->Stop->isEnabled())
+    {
+        receiveMsgSatusBar(tr("A job is running, '%1' can only be queued").arg(QFileInfo(path).fileName()));
+        return;
+    }
+    resetProgress();
+    loadFile(path);
+}
+
+// calls : 'MainWindow::queueJobs()':1, 'JobLibraryDialog::queueRequested()'
+void MainWindow::addJobs(QStringList paths)
+{
+    jobQueue.append(paths);
+
+    // nothing loaded yet : the first job goes straight to the listing
+    if (ui->filePath->text().isEmpty() && !ui->Stop->isEnabled())
+        loadNextJob();
+}
+
+// calls : 'ui->actionQueueJobs::triggered()'
+void MainWindow::queueJobs()
+{
+    QFileDialog dialog(this, tr("Add to Job Queue"),
+                       directory,
+                       tr("NC (*.nc);;Compressed NC (*.nc.gz *.nc.zst);;All Files (*.*)"));
+
+    dialog.setFileMode(QFileDialog::ExistingFiles);
+
+    if (nameFilter.size() > 0)
+        dialog.selectNameFilter(nameFilter);
+
+    if (!dialog.exec())
+        return;
+
+    addJobs(dialog.selectedFiles());
+}
+
+// Loads the first queued job, already analyzed in the background
+// calls : 'ui->actionNextJob::triggered()', 'MainWindow::stopSending()':1,
+//         'MainWindow::addJobs()':1
+void MainWindow::loadNextJob()
+{
+    if (ui->Stop->isEnabled() || jobQueue.isEmpty())
+        return;
+
+    QString path = jobQueue.takeFirst();
+    resetProgress();
+    loadFile(path);
+    receiveMsgSatusBar(tr("Job '%1' loaded, %2 more queued")
+                       .arg(QFileInfo(path).fileName()).arg(jobQueue.jobs().size()));
+}
+
+// Writes an optimized copy of the loaded file next to it and, when the
+// user accepts the result, loads it over the original path in 'visu3D'.
+// calls : 'ui->actionOptimizePath::triggered()'
+void MainWindow::optimizePath()
+{
+    QString path = ui->filePath->text();
+    if (path.isEmpty() || ui->Stop->isEnabled())
+        return;
+
+    QSettings settings;
+    double tolerance = settings.value(SETTINGS_OPTIMIZE_TOLERANCE, DEFAULT_OPTIMIZE_TOLERANCE_MM).toDouble();
+    int baud = lastBaudRate.toInt();
+    PathOptimizer optimizer(tolerance, baud);
+    QString outPath = PathOptimizer::optimizedPath(path);
+
+    // the pass reads the whole file, off the GUI thread
+    QProgressDialog progress(tr("Optimizing toolpath..."), QString(), 0, 0, this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.show();
+    QEventLoop loop;
+    QFutureWatcher<bool> watcher;
+    connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
+    watcher.setFuture(QtConcurrent::run(&optimizer, &PathOptimizer::optimize, path, outPath));
+    loop.exec();
+    progress.close();
+
+    if (!watcher.result())
+    {
+        QMessageBox::warning(this, tr("Optimize Toolpath"),
+                             tr("Can't optimize '%1' : %2").arg(path).arg(optimizer.errorString()));
+        return;
+    }
+
+    const PathOptimizerStats& stats = optimizer.stats();
+    QTime zero(0, 0);
+    QMessageBox msgBox;
+    msgBox.setText(tr("%1 lines reduced to %2 : %3 moves merged, %4 arcs fitted.\n"
+                      "Predicted time %5 instead of %6 (feed rates, %7 baud).\n\n"
+                      "Load '%8' ?")
+                   .arg(stats.linesIn).arg(stats.linesOut).arg(stats.merged).arg(stats.arcs)
+                   .arg(zero.addMSecs(qRound64(stats.secondsOut * 1000)).toString("hh:mm:ss"))
+                   .arg(zero.addMSecs(qRound64(stats.secondsIn * 1000)).toString("hh:mm:ss"))
+                   .arg(baud).arg(QFileInfo(outPath).fileName()));
+    msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
+    msgBox.setDefaultButton(QMessageBox::Yes);
+    if (msgBox.exec() != QMessageBox::Yes)
+        return;
+
+    QList<PosItem> original = posList;
+    loadFile(outPath);
+    /// to 'ui->visu3D::setReferenceItems(original)'
+    emit setReferenceItems(original);
+    ui->actionShowOriginal->setEnabled(true);
+}
+
+// Same flow as 'optimizePath()' : the cut groups of the loaded file are
+// visited in a shorter order, the copy is loaded over the original.
+// calls : 'ui->actionOptimizeTravel::triggered()'
+void MainWindow::optimizeTravel()
+{
+    QString path = ui->filePath->text();
+    if (path.isEmpty() || ui->Stop->isEnabled())
+        return;
+
+    TravelOptimizer optimizer;
+    optimizer.setRapidRates(rapidRateX, rapidRateY);
+    QString outPath = TravelOptimizer::optimizedPath(path);
+
+    QProgressDialog progress(tr("Optimizing rapid moves..."), QString(), 0, 0, this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.show();
+    QEventLoop loop;
+    QFutureWatcher<bool> watcher;
+    connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
+    watcher.setFuture(QtConcurrent::run(&optimizer, &TravelOptimizer::optimize, path, outPath));
+    loop.exec();
+    progress.close();
+
+    if (!watcher.result())
+    {
+        QMessageBox::warning(this, tr("Optimize Rapid Moves"),
+                             tr("Can't optimize '%1' : %2").arg(path).arg(optimizer.errorString()));
+        return;
+    }
+
+    const TravelOptimizerStats& stats = optimizer.stats();
+    if (stats.runs == 0)
+    {
+        QMessageBox::information(this, tr("Optimize Rapid Moves"),
+                                 tr("%1 cut groups found, %2 free to move : nothing to reorder.")
+                                 .arg(stats.groups).arg(stats.movable));
+        QFile::remove(outPath);
+        return;
+    }
+
+    QString saved;
+    if (stats.secondsIn > 0)
+    {
+        QTime zero(0, 0);
+        saved = tr("Rapid time %1 instead of %2 ($110, $111).\n")
+                .arg(zero.addMSecs(qRound64(stats.secondsOut * 1000)).toString("hh:mm:ss"))
+                .arg(zero.addMSecs(qRound64(stats.secondsIn * 1000)).toString("hh:mm:ss"));
+    }
+    else
+        saved = tr("Rapid rates unknown, connect to Grbl to estimate the time.\n");
+
+    QMessageBox msgBox;
+    msgBox.setText(tr("%1 of %2 cut groups free to move, reordered in %3 runs.\n"
+                      "Rapid travel %4 instead of %5.\n%6\n"
+                      "Load '%7' ?")
+                   .arg(stats.movable).arg(stats.groups).arg(stats.runs)
+                   .arg(stats.distanceOut, 0, 'f', 1).arg(stats.distanceIn, 0, 'f', 1)
+                   .arg(saved).arg(QFileInfo(outPath).fileName()));
+    msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
+    msgBox.setDefaultButton(QMessageBox::Yes);
+    if (msgBox.exec() != QMessageBox::Yes)
+        return;
+
+    QList<PosItem> original = posList;
+    loadFile(outPath);
+    /// to 'ui->visu3D::setReferenceItems(original)'
+    emit setReferenceItems(original);
+    ui->actionShowOriginal->setEnabled(true);
+}
+
+// Sweeps the cutter chosen for 'visu3D' along the whole program at
+// full resolution, saves the heightmap next to the file and shows it.
+// calls : 'ui->actionSimulateStock::triggered()'
+void MainWindow::simulateStock()
+{
+    QString path = ui->filePath->text();
+    if (path.isEmpty() || posList.isEmpty())
+        return;
+
+    StockSimulator simulator;
+    simulator.setTool(ui->visu3D->toolType(), posList.last().mm);
+
+    QProgressDialog progress(tr("Simulating stock..."), QString(), 0, 0, this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.show();
+    QElapsedTimer clock;
+    clock.start();
+    QEventLoop loop;
+    QFutureWatcher<void> watcher;
+    connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
+    watcher.setFuture(QtConcurrent::run(&simulator, &StockSimulator::simulate, posList, STOCK_FULL_CELLS));
+    loop.exec();
+    progress.close();
+
+    const StockMap& map = simulator.map();
+    if (map.isEmpty())
+    {
+        QMessageBox::information(this, tr("Simulate Stock"), tr("No feed move in '%1'.").arg(path));
+        return;
+    }
+
+    QFileInfo info(path);
+    QString imagePath = info.path() + "/" + info.completeBaseName() + STOCK_IMAGE_SUFFIX;
+    bool saved = map.toImage().save(imagePath);
+
+    stockFull = true;
+    /// to 'ui->visu3D::setStockMap(map)'
+    emit setStockMap(map);
+    ui->actionShowStock->setChecked(true);
+
+    QString unit = posList.last().mm ? tr("mm") : tr("in");
+    QMessageBox::information(this, tr("Simulate Stock"),
+            tr("%1 moves swept over %2 x %3 cells in %4 s.\n"
+               "Stock top %5 %6, deepest cut %7 %6, %8% of the area cut.\n%9")
+            .arg(simulator.segmentCount()).arg(map.cols).arg(map.rows)
+            .arg(clock.elapsed() / 1000.0, 0, 'f', 1)
+            .arg(map.top, 0, 'f', 3).arg(unit).arg(map.bottom, 0, 'f', 3)
+            .arg(100.0 * simulator.cutCells() / (map.cols * map.rows), 0, 'f', 1)
+            .arg(saved ? tr("Heightmap saved to '%1'.").arg(QFileInfo(imagePath).fileName())
+                       : tr("Can't save the heightmap to '%1'.").arg(imagePath)));
+}
+
+// calls : 'ui->actionShowStock::toggled(bool)'
+void MainWindow::showStock(bool show)
+{
+    if (!show)
+    {
+        stockTimer.stop();
+        return;
+    }
+    if (!stockFull)
+        prepareStockPreview();
+    stockTimer.start(STOCK_PREVIEW_MSEC);
+}
+
+// calls : 'showStock()':1, 'showProgram()':1
+void MainWindow::prepareStockPreview()
+{
+    if (!posList.isEmpty())
+        stockPreview.setTool(ui->visu3D->toolType(), posList.last().mm);
+    stockPreview.setPath(posList, STOCK_PREVIEW_CELLS);
+    stockPreview.advanceTo(activeLine);
+    stockLine = activeLine;
+    stockDirty = true;
+}
+
+// The preview cuts as the active line moves forward, going back to an
+// earlier line starts again from the uncut stock.
+// calls : 'setActiveLineVisuGcode()':1
+void MainWindow::advanceStock(int line)
+{
+    if (stockFull)
+    {
+        // sending : the preview takes over the full simulation
+        if (!ui->Stop->isEnabled())
+            return;
+        stockFull = false;
+        prepareStockPreview();
+    }
+    if (!stockPreview.hasPath())
+        return;
+
+    if (line < stockLine)
+    {
+        stockPreview.reset();
+        stockDirty = true;
+    }
+    stockDirty |= stockPreview.advanceTo(line);
+    stockLine = line;
+}
+
+// at most one new display list every 'STOCK_PREVIEW_MSEC'
+// calls : 'stockTimer::timeout()'
+void MainWindow::refreshStock()
+{
+    if (!stockDirty || stockFull)
+        return;
+    stockDirty = false;
+    /// to 'ui->visu3D::setStockMap(map)'
+    emit setStockMap(stockPreview.map());
+}
+
+// calls : 'segmentWatcher::finished()'
+void MainWindow::segmentIndexReady()
+{
+    segmentIndex = QSharedPointer<SegmentIndex>(segmentWatcher.result());
+    ui->wgtVisualizer->setSegmentIndex(segmentIndex.data());
+    ui->visu3D->setSegmentIndex(segmentIndex.data());
+}
+
+// a click on the path in 'wgtVisualizer' or 'visu3D', the listing and
+// the 3D view move to the line, not while sending
+// calls : 'RenderArea::linePicked()', 'Viewer::linePicked()'
+void MainWindow::pickLine(int line)
+{
+    if (ui->Stop->isEnabled() || line > totalLinesFile)
+        return;
+
+    setActiveLineVisuGcode(line, false);
+}
+
+// calls : 'gcode::setRapidRates()'
+void MainWindow::setRapidRates(double x, double y)
+{
+    rapidRateX = x;
+    rapidRateY = y;
+    /// to 'ui->visu3D::setRapidRate(double)'
+    emit setRapidRate(qMin(x, y));
+}
+
+// calls : 'ui->actionClearJobQueue::triggered()'
+void MainWindow::clearJobQueue()
+{
+    jobQueue.clear();
+}
+
+// calls : 'jobQueue::changed()'
+void MainWindow::jobQueueChanged()
+{
+    int count = jobQueue.jobs().size();
+    ui->actionNextJob->setEnabled(count > 0);
+    ui->actionClearJobQueue->setEnabled(count > 0);
+    ui->actionNextJob->setText(tr("Load &Next Job (%1 queued)").arg(count));
+}
+
 void MainWindow::showAbout()
 {
     About about(this);
@@ -1941,7 +2344,8 @@ void MainWindow::updateLCD(QVector3D coord)
     workCoordinates = Coord3D(coord);
 // T4   !!!
     cmdMan = false;
-    refreshLcd();
+    droDirty = true;
+    frameScheduler.requestFrame();
 }
 ///<--
 
@@ -1955,6 +2359,18 @@ void MainWindow::updateCoordinates(Coord3D machineCoord, Coord3D workCoord)
     machineCoordinates = machineCoord;
     workCoordinates = workCoord;
 
+    droDirty = true;
+    frameScheduler.requestFrame();
+}
+
+// the last coordinates of the frame only, the LCDs are drawn once
+// calls : 'frameScheduler::frame()'
+void MainWindow::renderFrame()
+{
+    if (!droDirty)
+        return;
+
+    droDirty = false;
     refreshLcd();
 }
 
@@ -2187,6 +2603,59 @@ void MainWindow::setQueuedCommands(int commandCount, bool running)
 
     lastQueueCount = commandCount;
 }
+// Applies what the GCode thread published since the last frame, so a
+// fast stream costs the GUI one update per frame instead of several
+// queued signals per line.
+// calls : 'telemetryTimer::timeout()', 'stopSending()':1
+void MainWindow::refreshTelemetry()
+{
+    const Telemetry& telemetry = gcode.getTelemetry();
+    if (telemetry.sequence() == lastTelemetry.sequence)
+    {
+        // starvation display depends on time, not only on changes
+        if (lastTelemetry.queueRunning)
+            setQueuedCommands(lastTelemetry.queuedCommands, true);
+        return;
+    }
+
+    TelemetrySnapshot snap;
+    telemetry.read(snap);
+
+    if (snap.running && snap.currLine != lastTelemetry.currLine)
+    {
+        if (snap.totalLines > 0)
+            setLinesFile(QString::number(snap.currLine), true);
+        else
+            // a stream : lines and bytes sent so far
+            setLinesFile(tr("%1 (%2 KB)").arg(snap.currLine).arg(snap.bytesSent / 1024), false);
+        if (snap.visual)
+        {
+            ui->wgtVisualizer->setVisCurrLine(snap.currLine);
+            emit setNumLine(QString::number(snap.currLine));
+        }
+    }
+
+    // no total for a stream, the bar is busy while it runs
+    bool streaming = snap.running && snap.totalLines == 0;
+    if (streaming != (lastTelemetry.running && lastTelemetry.totalLines == 0))
+        ui->progressFileSend->setMaximum(streaming ? 0 : 100);
+    if (snap.progress != lastTelemetry.progress)
+        ui->progressFileSend->setValue(snap.progress);
+
+    if (snap.queueRunning || snap.queuedCommands != lastTelemetry.queuedCommands
+            || snap.queueRunning != lastTelemetry.queueRunning)
+        setQueuedCommands(snap.queuedCommands, snap.queueRunning);
+
+    if (snap.positionCount != lastTelemetry.positionCount)
+    {
+        updateCoordinates(snap.machineCoord, snap.workCoord);
+        // 2D
+        ui->wgtVisualizer->setLivePoint(snap.workCoord.x, snap.workCoord.y, snap.useMm, snap.positionValid);
+    }
+
+    lastTelemetry = snap;
+}
+
 /// T4
 // calls :
 void MainWindow::setQueueClear()
@@ -2238,7 +2707,7 @@ void MainWindow::stepChanged(int newstep)
 
 ///-----------------------------------------------------------------------------
 ///  T2
-// calls : 'GCode::sendGcodeInternal()':1,
+// calls : 'refreshTelemetry()':1,
 void MainWindow::setLinesFile(QString linesFile, bool check)
 {
     if (check)   /// T3
@@ -2305,13 +2774,13 @@ void MainWindow::toPause(bool valid)
         ui->pauseButton->setText(tr("Run")) ;
         palette.setColor(QPalette::Button,Qt::gray) ;
         // mouse and keyboard key
-        connect(ui->visuGcode, SIGNAL(cursorPositionChanged() ), this, SLOT(on_cursorVisuGcode()) ) ;
+        connect(ui->visuGcode, SIGNAL(lineActivated(int) ), this, SLOT(on_cursorVisuGcode(int)) ) ;
     }
     else  {
         ui->pauseButton->setText(tr("Pause")) ;
         palette.setColor(QPalette::Button,Qt::yellow);
         // no mouse and no keyboard key
-        disconnect(ui->visuGcode, SIGNAL(cursorPositionChanged() ), this, SLOT(on_cursorVisuGcode()) ) ;
+        disconnect(ui->visuGcode, SIGNAL(lineActivated(int) ), this, SLOT(on_cursorVisuGcode(int)) ) ;
     }
     // color 'pauseButton'
     ui->pauseButton->setPalette(palette);
@@ -2319,12 +2788,11 @@ void MainWindow::toPause(bool valid)
     emit setPause(valid);
 }
 
-// calls : 'ui->visuGcode::cursorPositionChanged()'
-void MainWindow::on_cursorVisuGcode()
+// calls : 'ui->visuGcode::lineActivated(int)'
+void MainWindow::on_cursorVisuGcode(int line)
 {
-    int line = ui->visuGcode->textCursor().blockNumber();
     if (line <= totalLinesFile)
-        setActiveLineVisuGcode(line +1, false);
+        setActiveLineVisuGcode(line, false);
 }
 
 // calls :  MainWindow::on_cursorVisuGcode()':1, 'Viewer::setLivePoint()':1,
@@ -2333,24 +2801,11 @@ void MainWindow::setActiveLineVisuGcode( int line, bool visu )
 {
     if (!line) return ;
 
-    QTextBlock       block;
-    QTextCursor      cursor;
-    QTextBlockFormat blockFormat;
-
-    block       = ui->visuGcode->document()->findBlockByNumber( activeLine - 1 );
-    cursor      = QTextCursor( block );
-    blockFormat = cursor.blockFormat();
-    blockFormat.clearBackground();
-    cursor.setBlockFormat( blockFormat );
-
     activeLine = line ;
-
-    block       = ui->visuGcode->document()->findBlockByNumber( activeLine - 1 );
-    cursor      = QTextCursor( block );
-    blockFormat = cursor.blockFormat();
-    blockFormat.setBackground( Qt::lightGray );
-    cursor.setBlockFormat( blockFormat );
-    ui->visuGcode->setTextCursor( cursor );
+    // overlay on the listing, only two rows are repainted
+    ui->visuGcode->setActiveLine( activeLine );
+    if (ui->actionShowStock->isChecked())
+        advanceStock(activeLine);
     /// emission line number
     QString strline = QString().setNum(activeLine) ;
     // to 'ui->lineCode'  (QLabel)
@@ -2361,11 +2816,11 @@ void MainWindow::setActiveLineVisuGcode( int line, bool visu )
     }
 }
 
-/// display timer period animation
+/// display speed animation
 // calls :  none ?
 void MainWindow::setLCDValue(int value)
 {
-    ui->lcdPeriodAnim->display(value);
+    ui->lcdSpeedAnim->display(value);
 }
 
 // display the correct unit
@@ -2455,10 +2910,12 @@ void MainWindow::enableManualControl(bool v)
 
 void MainWindow::enableTabVisuControls(bool v)
 {
-    // animation period
-    ui->lcdPeriodAnim->setEnabled(v);
-    ui->labelPeriod->setEnabled(v);
-    ui->dialPeriodRepeat->setEnabled(v);
+    // animation speed and time
+    ui->lcdSpeedAnim->setEnabled(v);
+    ui->labelSpeed->setEnabled(v);
+    ui->dialSpeedAnim->setEnabled(v);
+    ui->labelSimTime->setEnabled(v);
+    ui->sliderSimTime->setEnabled(v);
     // animation cursors
     ui->nextButton->setEnabled(v);
     ui->lineCode->setEnabled(v);
@@ -2504,8 +2961,8 @@ void MainWindow::enableButtonGrblControls(bool v)
 // calls : 'ui->btnClearStatusList'
 void MainWindow::toClearSatusList()
 {
-    if (ui->statusList->textCursor().hasSelection())   {
-         ui->statusList->textCursor().removeSelectedText();
+    if (ui->statusList->hasSelection())   {
+         ui->statusList->removeSelectedLines();
     }
 }
 
@@ -2519,13 +2976,13 @@ void MainWindow::toPrintStatusList()
     txt += ui->filePath->text();
     txt += "\n\n";
     QPrintDialog *dialog = new QPrintDialog(&printer, this);
-    if (ui->statusList->textCursor().hasSelection())   {
+    if (ui->statusList->hasSelection())   {
          dialog->addEnabledOption(QAbstractPrintDialog::PrintSelection);
          printer.setPrintRange(QPrinter::Selection);
-         txt += ui->statusList->textCursor().selectedText();
+         txt += ui->statusList->selectedText();
     }
     else {
-        txt += ui->statusList->document()->toPlainText();
+        txt += ui->statusList->toPlainText();
     }
     if (dialog->exec() == QDialog::Accepted)      {
        QTextDocument  doc(txt);
@@ -2543,13 +3000,13 @@ void MainWindow::toPrintVisual()
     txt += ui->filePath->text();
     txt += "\n\n";
     QPrintDialog *dialog = new QPrintDialog(&printer, this);
-    if (ui->visuGcode->textCursor().hasSelection())  {
+    if (ui->visuGcode->hasSelection())  {
          dialog->addEnabledOption(QAbstractPrintDialog::PrintSelection);
          printer.setPrintRange(QPrinter::Selection);
-         txt += ui->visuGcode->textCursor().selectedText();
+         txt += ui->visuGcode->selectedText();
     }
     else {
-        txt += ui->visuGcode->document()->toPlainText();
+        txt += ui->visuGcode->toPlainText();
     }
     if (dialog->exec() == QDialog::Accepted)  {
        QTextDocument  doc(txt);
@@ -2557,7 +3014,7 @@ void MainWindow::toPrintVisual()
     }
 }
 
-// calls : 'processGCode(...)':1,
+// calls : 'showProgram(...)':1,
 void MainWindow::setUseMm(bool useMm)
 {
     /// acces to "Options::checkBoxUseMmManualCmds"
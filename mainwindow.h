@@ -17,8 +17,11 @@
 #include <QSettings>
 #include <QCloseEvent>
 #include <QItemDelegate>
+#include <QTimer>
 /// T4
 #include <QListView>
+#include <QFutureWatcher>
+#include <QFileSystemWatcher>
 #include "about.h"
 #include "definitions.h"
 #include "grbldialog.h"
@@ -27,6 +30,18 @@
 #include "positem.h"
 #include "gcode.h"
 #include "renderarea.h"
+#include "lineindex.h"
+#include "programanalyzer.h"
+#include "jobqueue.h"
+#include "joblibrarydialog.h"
+#include "pathoptimizer.h"
+#include "traveloptimizer.h"
+#include "stocksimulator.h"
+#include "segmentindex.h"
+#include "modaltimeline.h"
+#include "machinedashboard.h"
+#include "automationserver.h"
+#include "framescheduler.h"
 #include "visu3D/viewer3D.h"
 
 #define COMPANY_NAME "NoName"
@@ -43,12 +58,14 @@
 #define CENTER_POS              40
 
 #define MAX_STATUS_LINES_WHEN_ACTIVE        200
+// quiet time after the last write to the loaded file before reloading it
+#define PROGRAM_RELOAD_MSEC                 500
 
 namespace Ui {
 class MainWindow;
 }
 
-class MainWindow : public QMainWindow
+class MainWindow : public QMainWindow, public AutomationTarget
 {
     Q_OBJECT
 
@@ -57,6 +74,14 @@ public:
     ~MainWindow();
     void closeEvent(QCloseEvent *event);
 
+    // 'AutomationTarget', requests of the local automation clients
+    bool automationSubmit(const QString& file, QString& error);
+    bool automationStart(int line, QString& error);
+    bool automationPause(bool pause, QString& error);
+    bool automationAbort(QString& error);
+    void automationSettingsChanged();
+    QVariantMap automationState();
+
     //variables
     int delete_nr;
 
@@ -68,6 +93,8 @@ signals:
     void sendGcode(QString line, bool recordResponseOnFail = false, int waitCount = SHORT_WAIT_SEC);
 /// T3
     void sendFile(QString path, bool);
+    void sendFileFrom(QString path, bool, int firstLine, qint64 offset,
+                      int totalLines, QStringList preamble);
     void gotoXYZFourth(QString line);
     void axisAdj(char axis, float coord, bool inv, bool absoluteAfterAxisAdj, int sliderZCount);
     void setResponseWait(ControlParams controlParams);
@@ -99,8 +126,10 @@ signals:
     void setLivePoint(QVector3D, bool) ;
     void setLiveRelPoint(QVector3D) ;
 /// T4
-    void setFeedRateToLine(QList<double>) ;
-    void setSpeedSpindleToLine(QList<double>) ;
+    void setModalTimeline(ModalTimeline) ;
+    void setReferenceItems(QList<PosItem>);
+    void setStockMap(StockMap);
+    void setRapidRate(double);
     void runCode(bool, int);
     void setVisual(bool);
     void setPause(bool);
@@ -151,6 +180,25 @@ void grblFeedHold();
 /// T3
     void begin();
     void openFile();
+    void showMachines();
+    void showLibrary();
+    void loadFromLibrary(QString path);
+    void addJobs(QStringList paths);
+    void queueJobs();
+    void loadNextJob();
+    void clearJobQueue();
+    void optimizePath();
+    void optimizeTravel();
+    void simulateStock();
+    void showStock(bool);
+    void refreshStock();
+    void segmentIndexReady();
+    void pickLine(int line);
+    void programChanged(QString path);
+    void reloadProgram();
+    void setRapidRates(double x, double y);
+    void jobQueueChanged();
+    void loadFile(QString fileName);
     void stop();
     void stopSending();
     //
@@ -170,6 +218,7 @@ void grblFeedHold();
     void receiveList(QString msg);
     void receiveListFull(QStringList list);
     void receiveListOut(QString msg);
+    void receiveListChunk(QStringList list);
     void receiveMsgSatusBar(QString msg);
     //menu bar
     void getOptions();
@@ -184,6 +233,8 @@ void grblFeedHold();
     void zJogSliderReleased();
 
     void setQueuedCommands(int commandCount, bool running);
+    void refreshTelemetry();
+    void renderFrame();
 /// T4
     void setQueueClear();
     void setLcdState(bool valid);
@@ -196,7 +247,7 @@ void grblFeedHold();
 /// T4  for 'visuGcode'
     void toVisual(bool);
     void toPause(bool);
-    void on_cursorVisuGcode();
+    void on_cursorVisuGcode(int line);
     void setActiveLineVisuGcode(int, bool);
     void setLCDValue(int value);
     // change  text "mm" <=> "in"
@@ -219,11 +270,6 @@ void grblFeedHold();
 private:
     // enums
     enum
-    {
-        NO_ITEM = 0, X_ITEM, Y_ITEM, Z_ITEM, I_ITEM, J_ITEM, K_ITEM,
-        P_ITEM, F_ITEM, S_ITEM
-    };
-    enum
     {
         QCS_OK = 0, QCS_WAITING_FOR_ITEMS
     };
@@ -237,6 +283,42 @@ private:
     Timer runtimeTimer;
     QThread runtimeTimerThread;
 
+    // writes the job journals of 'gcode' and 'machines' back to the disk
+    JournalSync journalSync;
+    QThread journalSyncThread;
+
+    // additional machines, each with its own 'GCode' thread
+    MachineManager machines;
+    MachineDashboard *dashboard;
+
+    // job control for other local programs
+    AutomationServer automation;
+
+    // files to send after the loaded one
+    JobQueue jobQueue;
+
+    // programs of a directory with their thumbnails, to pick the next job
+    JobLibrary library;
+    JobLibraryDialog *libraryDialog;
+
+    // samples 'gcode' telemetry once per frame
+    QTimer telemetryTimer;
+    TelemetrySnapshot lastTelemetry;
+
+    // repaints of the DRO, the listing, the 2D and the 3D views, at most
+    // once per refresh of the screen
+    FrameScheduler frameScheduler;
+    // coordinates changed since the last frame
+    bool droDirty;
+
+    // coarse stock following the active line, see 'advanceStock()'
+    StockSimulator stockPreview;
+    QTimer stockTimer;
+    int stockLine;
+    bool stockDirty;
+    // the viewer shows a full resolution 'simulateStock()'
+    bool stockFull;
+
     Options opt;
 
     //variables
@@ -263,6 +345,22 @@ private:
     QTime queuedCommandsEmptyTimer;
     QTime queuedCommandsRefreshTimer;
     QList<PosItem> posList;
+    // line offsets of the loaded file, text for 'ui->visuGcode'
+    QSharedPointer<LineIndex> lineIndex;
+    // analysis of the loaded file, compared with its next version when
+    // 'programWatcher' sees it written again
+    ProgramAnalysis program;
+    QFileSystemWatcher programWatcher;
+    QTimer reloadTimer;
+    // moves of a program above 'inMemoryLimit' bytes, 'posList' is empty
+    QSharedPointer<ToolpathStore> toolpathStore;
+    qint64 inMemoryLimit;
+    // segments of 'posList' for picking in the views, built in the
+    // background by 'segmentWatcher'
+    QSharedPointer<SegmentIndex> segmentIndex;
+    QFutureWatcher<SegmentIndex *> segmentWatcher;
+    // F, S, units, plane and motion mode of the loaded file by line
+    ModalTimeline modalTimeline;
     bool sliderPressed;
     double sliderTo;
     int sliderZCount;
@@ -286,10 +384,18 @@ private:
     bool runFile, cmdMan;
     /// mode display request
     int posReqKind;
+    // line chosen when recovering an interrupted job, 0 : none
+    int resumeLine;
+    // 'begin()' called by an automation client : no prompt
+    bool automatedBegin;
+    // mm/min read from '$$' at connection, 0 : unknown
+    double rapidRateX, rapidRateY;
 
 private:
 // methods
     void setUseMm(bool);
+    void prepareStockPreview();
+    void advanceStock(int line);
     int SendJog(QString strline);
     void readSettings();
     void writeSettings();
@@ -303,20 +409,11 @@ private:
     void updateSettingsFromOptionDlg(QSettings& settings);
     int computeListViewMinimumWidth(QAbstractItemView* view);
     void preProcessFile(QString filepath);
+    void showProgram(const ProgramAnalysis& analysis);
+    void recoverInterruptedJob();
     void closePortHelper();
     void closeSerialPort();
 
-/// T4  3 axes + plane
-    bool processGCode(QString inputLine,
-                        double& x, double& y, double& z,
-                        double& i, double& j, double& k,
-                        int& p, bool& arc, bool& cw, bool& mm,
-                        int& g, int& plane, bool& helix,
-                        double& f, double& ss
-                        );
-/// <-
-    double decodeLineItem(const QString& item, const int next, bool& valid, int& nextIsValue);
-    double decodeDouble(QString value, bool& valid);
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,68 @@
+/****************************************************************
+ * modaltimeline.cpp
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#include "modaltimeline.h"
+
+#include <QtAlgorithms>
+
+bool ModalState::operator==(const ModalState& other) const
+{
+    return feedrate == other.feedrate
+        && speedspindle == other.speedspindle
+        && mm == other.mm
+        && plane == other.plane
+        && motion == other.motion
+        && absolute == other.absolute
+        && spindle == other.spindle;
+}
+
+void ModalTimeline::clear()
+{
+    startLine.clear();
+    states.clear();
+}
+
+// calls : 'MainWindow::preProcessFile()':1
+void ModalTimeline::record(int line, const ModalState& state)
+{
+    if (states.isEmpty() ? state == ModalState() : state == states.last())
+        return;
+
+    if (!startLine.isEmpty() && startLine.last() == line)
+        states.last() = state;
+    else
+    {
+        startLine.append(line);
+        states.append(state);
+    }
+}
+
+ModalState ModalTimeline::at(int line) const
+{
+    QVector<int>::const_iterator it = qUpperBound(startLine.constBegin(), startLine.constEnd(), line);
+    int n = it - startLine.constBegin();
+    if (n == 0)
+        return ModalState();
+    return states.at(n - 1);
+}
+
+int ModalTimeline::changeCount() const
+{
+    return states.size();
+}
+
+int ModalTimeline::changeLine(int n) const
+{
+    return startLine.at(n);
+}
+
+const ModalState& ModalTimeline::changeState(int n) const
+{
+    return states.at(n);
+}
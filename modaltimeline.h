@@ -0,0 +1,64 @@
+/****************************************************************
+ * modaltimeline.h
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#ifndef MODALTIMELINE_H
+#define MODALTIMELINE_H
+
+#include <QMetaType>
+#include <QVector>
+
+#include "definitions.h"
+
+// Modal values in force after a line of the program
+class ModalState
+{
+public:
+    ModalState()
+        : feedrate(0), speedspindle(0), mm(true),
+          plane(NO_PLANE), motion(0), absolute(true), spindle(5) {}
+
+    bool operator==(const ModalState& other) const;
+    bool operator!=(const ModalState& other) const { return !(*this == other); }
+
+public:
+    double feedrate;        // Fxxxx
+    double speedspindle;    // Sxxxx
+    bool mm;                // G21 / G20
+    int plane;              // G17, G18, G19
+    int motion;             // in [0..3] for Gx
+    bool absolute;          // G90 / G91
+    int spindle;            // M3, M4, M5
+};
+
+// Run length encoded modal state of a program : one entry for each line
+// where a value changes, so memory follows the number of changes and
+// not the number of lines. 'at()' is a binary search.
+class ModalTimeline
+{
+public:
+    ModalTimeline() {}
+
+    void clear();
+    // lines are recorded in increasing order, identical states are merged
+    void record(int line, const ModalState& state);
+    // state after 'line', default state before the first record
+    ModalState at(int line) const;
+    int changeCount() const;
+    // change 'n' in [0..changeCount()[, recorded again by 'ParseCache'
+    int changeLine(int n) const;
+    const ModalState& changeState(int n) const;
+
+private:
+    QVector<int> startLine;
+    QVector<ModalState> states;
+};
+
+Q_DECLARE_METATYPE ( ModalTimeline )
+
+#endif // MODALTIMELINE_H
@@ -0,0 +1,98 @@
+/****************************************************************
+ * motiontimeline.cpp
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#include "motiontimeline.h"
+
+#include <QtAlgorithms>
+
+void MotionTimeline::clear()
+{
+    points.clear();
+    lines.clear();
+    times.clear();
+}
+
+void MotionTimeline::setStart(const QVector3D& p)
+{
+    clear();
+    points.append(p);
+    lines.append(0);
+    times.append(0.0);
+}
+
+// calls : 'Viewer::Scene()':1
+void MotionTimeline::append(const QVector3D& p, int line, double feed)
+{
+    if (points.isEmpty())
+        setStart(p);
+
+    double seconds = 0;
+    if (feed > 0)
+        seconds = (p - points.last()).length() / (feed / 60.0);
+
+    points.append(p);
+    lines.append(line);
+    times.append(times.last() + seconds);
+}
+
+int MotionTimeline::count() const
+{
+    return points.size();
+}
+
+double MotionTimeline::duration() const
+{
+    return times.isEmpty() ? 0 : times.last();
+}
+
+int MotionTimeline::pointAfter(double t) const
+{
+    return qUpperBound(times.constBegin(), times.constEnd(), t) - times.constBegin();
+}
+
+QVector3D MotionTimeline::positionAt(double t) const
+{
+    if (points.isEmpty())
+        return QVector3D();
+
+    int n = pointAfter(t);
+    if (n == 0)
+        return points.first();
+    if (n == points.size())
+        return points.last();
+
+    // 'times' is strictly greater at 'n', no division by zero
+    double f = (t - times.at(n - 1)) / (times.at(n) - times.at(n - 1));
+    return points.at(n - 1) + (points.at(n) - points.at(n - 1)) * f;
+}
+
+int MotionTimeline::lineAt(double t) const
+{
+    if (lines.isEmpty())
+        return 0;
+
+    int n = pointAfter(t);
+    return n == lines.size() ? lines.last() : lines.at(n);
+}
+
+double MotionTimeline::startOfLine(int line) const
+{
+    int n = qLowerBound(lines.constBegin(), lines.constEnd(), line) - lines.constBegin();
+    if (n == 0)
+        return 0;
+    if (n == lines.size())
+        return duration();
+    return times.at(n - 1);
+}
+
+double MotionTimeline::endOfLine(int line) const
+{
+    int n = qUpperBound(lines.constBegin(), lines.constEnd(), line) - lines.constBegin();
+    return n == 0 ? 0 : times.at(n - 1);
+}
@@ -0,0 +1,55 @@
+/****************************************************************
+ * motiontimeline.h
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#ifndef MOTIONTIMELINE_H
+#define MOTIONTIMELINE_H
+
+#include <QVector>
+#include <QVector3D>
+
+// rapid rate mm per mn until Grbl reports its settings
+#define MOTION_RAPID_DEFAULT    1500.0
+
+// Every interpolated point of the program with the machining time at
+// which the tool reaches it, computed from the feed rates. Times are
+// cumulative so that a time or a line is found by a binary search,
+// whatever the length of the program.
+class MotionTimeline
+{
+public:
+    MotionTimeline() {}
+
+    void clear();
+    // position of the tool before the first move, at time 0
+    void setStart(const QVector3D& p);
+    // 'feed' in units per mn, points are appended in program order
+    void append(const QVector3D& p, int line, double feed);
+
+    int count() const;
+    // seconds
+    double duration() const;
+    QVector3D positionAt(double t) const;
+    // line of the move going on at 't', 0 before the first move
+    int lineAt(double t) const;
+    // time the moves of 'line' begin and end, the moves of a line
+    // without motion take no time
+    double startOfLine(int line) const;
+    double endOfLine(int line) const;
+
+private:
+    // index of the first point reached after 't'
+    int pointAfter(double t) const;
+
+private:
+    QVector<QVector3D> points;
+    QVector<int> lines;
+    QVector<double> times;
+};
+
+#endif // MOTIONTIMELINE_H
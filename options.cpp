@@ -9,6 +9,7 @@
 
 #include "options.h"
 #include "ui_options.h"
+#include "toolpathstore.h"
 
 Options::Options(QWidget *parent) :
     QDialog(parent),
@@ -102,6 +103,8 @@ void Options::init()
 
 /// T4
     ui->spinMaxStatusLines->setValue( settings.value( SETTINGS_MAX_STATUS_LINES, 0 ).value<int>() );
+    ui->spinInMemoryLimit->setValue( settings.value( SETTINGS_IN_MEMORY_LIMIT_MB, TOOLPATH_DEFAULT_LIMIT_MB ).value<int>() );
+    ui->spinPageBudget->setValue( settings.value( SETTINGS_PAGE_BUDGET_MB, TOOLPATH_DEFAULT_BUDGET_MB ).value<int>() );
 
     QString zRateLimit = settings.value(SETTINGS_Z_RATE_LIMIT, "false").value<QString>();
     ui->chkLimitZRate->setChecked(zRateLimit == "true");
@@ -122,6 +125,10 @@ void Options::init()
     QString rPrecision = settings.value(SETTINGS_REDUCE_PREC_FOR_LONG_LINES, "false").value<QString>();
     ui->checkBoxReducePrecForLongLines->setChecked(rPrecision == "true");
     ui->spinBoxGrblLineBufferSize->setValue(settings.value(SETTINGS_GRBL_LINE_BUFFER_LEN, DEFAULT_GRBL_LINE_BUFFER_LEN).value<int>());
+    QString compact = settings.value(SETTINGS_COMPACT_LINES, "false").value<QString>();
+    ui->chkCompactLines->setChecked(compact == "true");
+    ui->spinBoxCompactDecimals->setValue(settings.value(SETTINGS_COMPACT_DECIMALS, DEFAULT_COMPACT_DECIMALS).value<int>());
+    ui->spinBoxStreamPrebuffer->setValue(settings.value(SETTINGS_STREAM_PREBUFFER_LINES, DEFAULT_STREAM_PREBUFFER_LINES).value<int>());
     ui->spinBoxCharSendDelay->setValue(settings.value(SETTINGS_CHAR_SEND_DELAY_MS, DEFAULT_CHAR_SEND_DELAY_MS).value<int>());
 /// T4
     int posReqKind = settings.value(SETTINGS_POS_REQ_KIND, POS_REQ).value<int>();
@@ -184,11 +191,16 @@ void Options::accept()
     settings.setValue(SETTINGS_XY_RATE_AMOUNT, ui->doubleSpinXYRate->value());
 /// T4
     settings.setValue(SETTINGS_MAX_STATUS_LINES, ui->spinMaxStatusLines->value());
+    settings.setValue(SETTINGS_IN_MEMORY_LIMIT_MB, ui->spinInMemoryLimit->value());
+    settings.setValue(SETTINGS_PAGE_BUDGET_MB, ui->spinPageBudget->value());
 
 // tab Filtering
     settings.setValue(SETTINGS_FILTER_FILE_COMMANDS, ui->chkFilterFileCommands->isChecked());
     settings.setValue(SETTINGS_REDUCE_PREC_FOR_LONG_LINES, ui->checkBoxReducePrecForLongLines->isChecked());
     settings.setValue(SETTINGS_GRBL_LINE_BUFFER_LEN, ui->spinBoxGrblLineBufferSize->value());
+    settings.setValue(SETTINGS_COMPACT_LINES, ui->chkCompactLines->isChecked());
+    settings.setValue(SETTINGS_COMPACT_DECIMALS, ui->spinBoxCompactDecimals->value());
+    settings.setValue(SETTINGS_STREAM_PREBUFFER_LINES, ui->spinBoxStreamPrebuffer->value());
     settings.setValue(SETTINGS_CHAR_SEND_DELAY_MS, ui->spinBoxCharSendDelay->value());
 
 // tab Display
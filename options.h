@@ -49,6 +49,9 @@
 #define SETTINGS_FILTER_FILE_COMMANDS       "filterFileCommands"
 #define SETTINGS_REDUCE_PREC_FOR_LONG_LINES "reducePrecisionForLongLines"
 #define SETTINGS_GRBL_LINE_BUFFER_LEN       "grblLineBufferLen"
+#define SETTINGS_COMPACT_LINES              "compactLines"
+#define SETTINGS_COMPACT_DECIMALS           "compactDecimals"
+#define SETTINGS_STREAM_PREBUFFER_LINES     "streamPrebufferLines"
 #define SETTINGS_CHAR_SEND_DELAY_MS         "charSendDelayMs"
 #define SETTINGS_JOG_STEP                   "jogStep"
 
@@ -58,6 +61,11 @@
 /// T4
 #define SETTINGS_POS_REQ_KIND                "positionReqKind"
 #define SETTINGS_MAX_STATUS_LINES            "maxStatusLines"
+#define SETTINGS_JOB_QUEUE                   "jobQueue"
+#define SETTINGS_LIBRARY_DIRECTORY           "libraryDirectory"
+#define SETTINGS_OPTIMIZE_TOLERANCE          "optimizeTolerance"
+#define SETTINGS_IN_MEMORY_LIMIT_MB          "inMemoryLimitMb"
+#define SETTINGS_PAGE_BUDGET_MB              "pageBudgetMb"
 
 namespace Ui {
 class Options;
@@ -0,0 +1,242 @@
+/****************************************************************
+ * parsecache.cpp
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#include "parsecache.h"
+
+#include <cstring>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include "programanalyzer.h"
+
+#define PARSE_CACHE_MAGIC       "GCVPARSE"
+#define PARSE_CACHE_HASH_BYTES  20
+
+namespace
+{
+    struct Header
+    {
+        char magic[8];
+        quint32 version;
+        // sizes of the records, another build or platform does not match
+        quint32 posSize, modalSize;
+        qint64 fileSize;
+        qint64 modified;        // ms since epoch
+        char hash[PARSE_CACHE_HASH_BYTES];
+        qint32 lineCount;
+        qint32 posCount;
+        qint32 modalCount;
+        qint32 mm;
+        double maxZ;
+    };
+
+    struct PosRecord
+    {
+        double x, y, z;
+        double i, j, k;
+        double feedrate, speedspindle;
+        qint32 p, g, plane, index;
+        quint8 arc, cw, mm, helix;
+    };
+
+    struct ModalRecord
+    {
+        double feedrate, speedspindle;
+        qint32 line, plane, motion, spindle;
+        quint8 mm, absolute;
+    };
+}
+
+QByteArray ParseCache::contentHash(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (!hash.addData(&file))
+        return QByteArray();
+    return hash.result();
+}
+
+QString ParseCache::directory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/programs";
+}
+
+QString ParseCache::cacheFile(const QByteArray& hash)
+{
+    return directory() + "/" + QString::fromLatin1(hash.toHex()) + PARSE_CACHE_SUFFIX;
+}
+
+// calls : 'ProgramAnalyzer::analyze()':1
+bool ParseCache::load(ProgramAnalysis& result)
+{
+    if (result.contentHash.size() != PARSE_CACHE_HASH_BYTES)
+        return false;
+
+    QFile file(cacheFile(result.contentHash));
+    if (!file.open(QIODevice::ReadOnly) || file.size() < (qint64)sizeof(Header))
+        return false;
+
+    qint64 bytes = file.size();
+    const uchar *data = file.map(0, bytes);
+    if (data == NULL)
+        return false;
+
+    const Header *head = (const Header *)data;
+    bool valid = memcmp(head->magic, PARSE_CACHE_MAGIC, sizeof(head->magic)) == 0
+        && head->version == PARSE_CACHE_VERSION
+        && head->posSize == sizeof(PosRecord)
+        && head->modalSize == sizeof(ModalRecord)
+        && head->fileSize == result.fileSize
+        && head->modified == result.fileModified.toMSecsSinceEpoch()
+        && memcmp(head->hash, result.contentHash.constData(), PARSE_CACHE_HASH_BYTES) == 0
+        && head->posCount >= 0 && head->modalCount >= 0
+        && bytes == (qint64)sizeof(Header) + head->posCount * (qint64)sizeof(PosRecord)
+                    + head->modalCount * (qint64)sizeof(ModalRecord);
+    if (!valid)
+    {
+        file.unmap((uchar *)data);
+        return false;
+    }
+
+    const PosRecord *pos = (const PosRecord *)(data + sizeof(Header));
+    result.posList.clear();
+    result.posList.reserve(head->posCount);
+    for (int n = 0; n < head->posCount; n++, pos++)
+    {
+        PosItem item;
+        item.x = pos->x; item.y = pos->y; item.z = pos->z;
+        item.i = pos->i; item.j = pos->j; item.k = pos->k;
+        item.feedrate = pos->feedrate;
+        item.speedspindle = pos->speedspindle;
+        item.p = pos->p;
+        item.g = pos->g;
+        item.plane = pos->plane;
+        item.index = pos->index;
+        item.arc = pos->arc;
+        item.cw = pos->cw;
+        item.mm = pos->mm;
+        item.helix = pos->helix;
+        result.posList.append(item);
+    }
+
+    // recorded again in the same order, the timeline stays identical
+    const ModalRecord *modal = (const ModalRecord *)pos;
+    result.modalTimeline.clear();
+    for (int n = 0; n < head->modalCount; n++, modal++)
+    {
+        ModalState state;
+        state.feedrate = modal->feedrate;
+        state.speedspindle = modal->speedspindle;
+        state.plane = modal->plane;
+        state.motion = modal->motion;
+        state.spindle = modal->spindle;
+        state.mm = modal->mm;
+        state.absolute = modal->absolute;
+        result.modalTimeline.record(modal->line, state);
+    }
+
+    result.lineCount = head->lineCount;
+    result.maxZ = head->maxZ;
+    result.mm = head->mm != 0;
+
+    file.unmap((uchar *)data);
+    return true;
+}
+
+// The file is replaced atomically, an analysis of the same program on
+// another thread reads the old one or the new one.
+// calls : 'ProgramAnalyzer::analyze()':1
+void ParseCache::save(const ProgramAnalysis& result)
+{
+    if (!result.valid || result.contentHash.size() != PARSE_CACHE_HASH_BYTES)
+        return;
+    if (!QDir().mkpath(directory()))
+        return;
+
+    Header head;
+    memset(&head, 0, sizeof(head));
+    memcpy(head.magic, PARSE_CACHE_MAGIC, sizeof(head.magic));
+    head.version = PARSE_CACHE_VERSION;
+    head.posSize = sizeof(PosRecord);
+    head.modalSize = sizeof(ModalRecord);
+    head.fileSize = result.fileSize;
+    head.modified = result.fileModified.toMSecsSinceEpoch();
+    memcpy(head.hash, result.contentHash.constData(), PARSE_CACHE_HASH_BYTES);
+    head.lineCount = result.lineCount;
+    head.posCount = result.posList.size();
+    head.modalCount = result.modalTimeline.changeCount();
+    head.mm = result.mm;
+    head.maxZ = result.maxZ;
+
+    QVector<PosRecord> moves(head.posCount);
+    memset(moves.data(), 0, moves.size() * sizeof(PosRecord));
+    for (int n = 0; n < head.posCount; n++)
+    {
+        const PosItem& item = result.posList.at(n);
+        PosRecord& pos = moves[n];
+        pos.x = item.x; pos.y = item.y; pos.z = item.z;
+        pos.i = item.i; pos.j = item.j; pos.k = item.k;
+        pos.feedrate = item.feedrate;
+        pos.speedspindle = item.speedspindle;
+        pos.p = item.p;
+        pos.g = item.g;
+        pos.plane = item.plane;
+        pos.index = item.index;
+        pos.arc = item.arc;
+        pos.cw = item.cw;
+        pos.mm = item.mm;
+        pos.helix = item.helix;
+    }
+
+    QVector<ModalRecord> changes(head.modalCount);
+    memset(changes.data(), 0, changes.size() * sizeof(ModalRecord));
+    for (int n = 0; n < head.modalCount; n++)
+    {
+        const ModalState& state = result.modalTimeline.changeState(n);
+        ModalRecord& modal = changes[n];
+        modal.line = result.modalTimeline.changeLine(n);
+        modal.feedrate = state.feedrate;
+        modal.speedspindle = state.speedspindle;
+        modal.plane = state.plane;
+        modal.motion = state.motion;
+        modal.spindle = state.spindle;
+        modal.mm = state.mm;
+        modal.absolute = state.absolute;
+    }
+
+    QSaveFile file(cacheFile(result.contentHash));
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+    file.write((const char *)&head, sizeof(head));
+    file.write((const char *)moves.constData(), moves.size() * sizeof(PosRecord));
+    file.write((const char *)changes.constData(), changes.size() * sizeof(ModalRecord));
+    if (file.commit())
+        prune();
+}
+
+// the most recently written files are kept
+void ParseCache::prune()
+{
+    QDir dir(directory());
+    QFileInfoList files = dir.entryInfoList(QStringList(QString("*") + PARSE_CACHE_SUFFIX),
+                                            QDir::Files, QDir::Time);
+    qint64 total = 0;
+    foreach (const QFileInfo& info, files)
+    {
+        total += info.size();
+        if (total > (qint64)PARSE_CACHE_MAX_MB << 20)
+            QFile::remove(info.absoluteFilePath());
+    }
+}
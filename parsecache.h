@@ -0,0 +1,47 @@
+/****************************************************************
+ * parsecache.h
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#ifndef PARSECACHE_H
+#define PARSECACHE_H
+
+#include <QByteArray>
+#include <QString>
+
+class ProgramAnalysis;
+
+// bumped each time the layout of a cache file changes
+#define PARSE_CACHE_VERSION     1
+#define PARSE_CACHE_SUFFIX      ".parse"
+// oldest cache files are removed above this total, MB
+#define PARSE_CACHE_MAX_MB      1024
+
+// Analyses of the programs already opened, one file per program content
+// in the user cache directory. A file holds a header, the moves then the
+// modal changes as fixed size records, read back through a memory map.
+// It is used only if the size, the date and the content hash of the
+// program are the same, and if it was written by the same layout.
+class ParseCache
+{
+public:
+    // SHA-1 of the content of 'path', empty if it can't be read
+    static QByteArray contentHash(const QString& path);
+
+    // fills the moves, modal states, maximum Z, units and line count
+    // of 'result' from its cache file, false if there is none
+    static bool load(ProgramAnalysis& result);
+    static void save(const ProgramAnalysis& result);
+
+    static QString directory();
+
+private:
+    static QString cacheFile(const QByteArray& hash);
+    static void prune();
+};
+
+#endif // PARSECACHE_H
@@ -0,0 +1,453 @@
+/****************************************************************
+ * pathoptimizer.cpp
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#include "pathoptimizer.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QRegExp>
+#include <QScopedPointer>
+#include <qmath.h>
+
+#include "compressedfile.h"
+#include "definitions.h"
+#include "gcode.h"
+#include "programanalyzer.h"
+
+#define AXIS_X_KNOWN    1
+#define AXIS_Y_KNOWN    2
+#define AXIS_Z_KNOWN    4
+#define AXES_KNOWN      (AXIS_X_KNOWN | AXIS_Y_KNOWN | AXIS_Z_KNOWN)
+
+PathOptimizer::PathOptimizer(double tolMm, int baudRate)
+    : toleranceMm(tolMm), baud(qMax(baudRate, 1)),
+      tol(tolMm), mm(true), plane(NO_PLANE), feed(0), lastMotion(0),
+      axesKnown(0), runMm(true), runPlane(NO_PLANE)
+{
+}
+
+const PathOptimizerStats& PathOptimizer::stats() const
+{
+    return result;
+}
+
+QString PathOptimizer::errorString() const
+{
+    return error;
+}
+
+QString PathOptimizer::optimizedPath(const QString& inPath)
+{
+    // the copy is written uncompressed
+    QFileInfo info(CompressedFile::plainPath(inPath));
+    QString path = info.path() + "/" + info.completeBaseName() + OPTIMIZE_FILE_SUFFIX;
+    if (!info.suffix().isEmpty())
+        path += "." + info.suffix();
+    return path;
+}
+
+// calls : 'MainWindow::optimizePath()':1
+bool PathOptimizer::optimize(const QString& inPath, const QString& outPath)
+{
+    error.clear();
+    QScopedPointer<QIODevice> inFile(CompressedFile::openRead(inPath, &error));
+    if (inFile.isNull())
+        return false;
+    QFile outFile(outPath);
+    if (!outFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        error = outFile.errorString();
+        return false;
+    }
+    QTextStream code(inFile.data());
+    QTextStream out(&outFile);
+
+    result = PathOptimizerStats();
+    run.clear();
+    runLines.clear();
+    mm = true;
+    tol = toleranceMm;
+    plane = NO_PLANE;
+    feed = 0;
+    lastMotion = 0;
+    axesKnown = 0;
+
+    // modal values of 'ProgramAnalyzer::processGCode()', the motion
+    // mode is kept from line to line here
+    double x, y, z, i, j, k;
+    x = y = z = i = j = k = 0;
+    int p = 0, g = 0, spindle = 5;
+    bool arc = false, cw = false, helix = false, absolute = true;
+    double fr, ss;
+    QVector3D pos;
+
+    while (!code.atEnd())
+    {
+        QString raw = code.readLine();
+        result.linesIn++;
+
+        QString strline = raw;
+        GCode::trimToEnd(strline, '(');
+        GCode::trimToEnd(strline, ';');
+        GCode::trimToEnd(strline, '%');
+        strline = strline.trimmed();
+        if (strline.isEmpty())
+        {
+            // comments stay where they are
+            flush(out);
+            out << raw << "\n";
+            result.linesOut++;
+            continue;
+        }
+
+        QString formatted = strline.toUpper();
+        formatted.replace("M6", "M06");
+        formatted.replace(QRegExp("([A-Z])"), " \\1");
+        formatted.replace(QRegExp("\\s+"), " ");
+
+        QVector3D before = pos;
+        bool startKnown = axesKnown == AXES_KNOWN;
+        p = 0; fr = 0.0; ss = 0.0;
+        ProgramAnalyzer::processGCode(formatted, x, y, z, i, j, k,
+                                      p, arc, cw, mm, g,
+                                      plane, helix, fr, ss,
+                                      absolute, spindle);
+        pos = QVector3D(x, y, z);
+        tol = mm ? toleranceMm : toleranceMm / MM_IN_AN_INCH;
+
+        if (startKnown && isCandidate(raw, formatted, g, absolute, fr))
+        {
+            if (run.isEmpty())
+            {
+                run.append(before);
+                runMm = mm;
+                runPlane = plane;
+            }
+            run.append(pos);
+            runLines.append(raw);
+            if (run.size() > OPTIMIZE_MAX_RUN)
+                flush(out);
+            continue;
+        }
+
+        flush(out);
+        if (fr > 0)
+            feed = fr;
+
+        if (!keepsPosition(formatted, absolute))
+            axesKnown = 0;
+        else
+        {
+            foreach (const QString& word, formatted.split(" ", QString::SkipEmptyParts))
+            {
+                if (word.at(0) == 'X')
+                    axesKnown |= AXIS_X_KNOWN;
+                else if (word.at(0) == 'Y')
+                    axesKnown |= AXIS_Y_KNOWN;
+                else if (word.at(0) == 'Z')
+                    axesKnown |= AXIS_Z_KNOWN;
+            }
+        }
+
+        double length = (pos - before).length();
+        bool feedMove = g >= 1 && g <= 3;
+        result.secondsIn += blockSeconds(raw.trimmed(), length, feedMove);
+        writeBlock(out, raw, length, feedMove);
+        lastMotion = g;
+    }
+    flush(out);
+
+    out.flush();
+    if (outFile.error() != QFile::NoError)
+    {
+        error = outFile.errorString();
+        return false;
+    }
+    return true;
+}
+
+// G1 with nothing but coordinates and the current feed rate
+bool PathOptimizer::isCandidate(const QString& raw, const QString& formatted, int g,
+                                bool absolute, double f) const
+{
+    if (g != 1 || !absolute || raw.contains('(') || raw.contains(';'))
+        return false;
+    if (f > 0 && f != feed)
+        return false;
+
+    foreach (const QString& word, formatted.split(" ", QString::SkipEmptyParts))
+    {
+        QChar letter = word.at(0);
+        if (letter == 'G')
+        {
+            if (word.mid(1).toDouble() != 1.0)
+                return false;
+        }
+        else if (letter != 'X' && letter != 'Y' && letter != 'Z' && letter != 'F')
+            return false;
+    }
+    return true;
+}
+
+// false after a line moving the machine to a place not written in the
+// program (homing, probing, offsets) or changing what coordinates mean
+bool PathOptimizer::keepsPosition(const QString& formatted, bool absolute) const
+{
+    if (!absolute)
+        return false;
+
+    static const double kept[] = { 0, 1, 2, 3, 4, 17, 18, 19, 40, 49, 61, 64, 80, 90, 93, 94 };
+    foreach (const QString& word, formatted.split(" ", QString::SkipEmptyParts))
+    {
+        if (word.at(0) != 'G')
+            continue;
+
+        double value = word.mid(1).toDouble();
+        bool found = false;
+        for (unsigned n = 0; n < sizeof(kept) / sizeof(kept[0]) && !found; n++)
+            found = value == kept[n];
+        if (!found)
+            return false;
+    }
+    return true;
+}
+
+// Greedy cover of the run : from each point the longest line or arc
+// within the tolerance, the arc only when it swallows more moves.
+void PathOptimizer::flush(QTextStream& out)
+{
+    if (run.size() < 2)
+    {
+        run.clear();
+        runLines.clear();
+        return;
+    }
+
+    bool fileMm = mm;
+    int filePlane = plane;
+    double fileTol = tol;
+    mm = runMm;
+    plane = runPlane;
+    tol = mm ? toleranceMm : toleranceMm / MM_IN_AN_INCH;
+
+    for (int n = 0; n < runLines.size(); n++)
+        result.secondsIn += blockSeconds(runLines.at(n).trimmed(), (run.at(n + 1) - run.at(n)).length(), true);
+
+    int last = run.size() - 1;
+    int i = 0;
+    while (i < last)
+    {
+        QVector3D center;
+        bool cw = false;
+        int jl = lineEnd(i);
+        int ja = arcEnd(i, center, cw);
+        if (ja > jl)
+        {
+            writeArc(out, i, ja, center, cw);
+            result.arcs++;
+            i = ja;
+        }
+        else
+        {
+            writeLine(out, i, jl);
+            result.merged += jl - i - 1;
+            i = jl;
+        }
+    }
+    // the lines after the run may rely on the modal G1
+    if (lastMotion != 1)
+    {
+        writeBlock(out, "G1", 0, false);
+        lastMotion = 1;
+    }
+
+    run.clear();
+    runLines.clear();
+    mm = fileMm;
+    plane = filePlane;
+    tol = fileTol;
+}
+
+// last point reachable from 'i' by one straight move
+int PathOptimizer::lineEnd(int i) const
+{
+    int j = i + 1;
+    while (j + 1 < run.size())
+    {
+        const QVector3D& a = run.at(i);
+        QVector3D ab = run.at(j + 1) - a;
+        double len2 = ab.lengthSquared();
+        if (len2 == 0)
+            break;
+
+        bool ok = true;
+        double lastT = 0;
+        for (int k = i + 1; k <= j && ok; k++)
+        {
+            double t = QVector3D::dotProduct(run.at(k) - a, ab) / len2;
+            // no going back along the line
+            ok = t >= lastT && t <= 1 && (a + ab * t - run.at(k)).length() <= tol;
+            lastT = t;
+        }
+        if (!ok)
+            break;
+        j++;
+    }
+    return j;
+}
+
+// last point reachable from 'i' by one arc, 'i' when none
+int PathOptimizer::arcEnd(int i, QVector3D& center, bool& cw) const
+{
+    if (plane != PLANE_XY_G17 && plane != NO_PLANE)
+        return i;
+
+    int best = i;
+    for (int j = i + OPTIMIZE_ARC_MIN_SEGMENTS; j < run.size(); j++)
+    {
+        QVector3D c;
+        bool dir;
+        if (!fitArc(i, j, c, dir))
+            break;
+        best = j;
+        center = c;
+        cw = dir;
+    }
+    return best;
+}
+
+// circle through the first, middle and last points, then every point
+// and every chord checked against it
+bool PathOptimizer::fitArc(int i, int j, QVector3D& center, bool& cw) const
+{
+    const QVector3D& a = run.at(i);
+    const QVector3D& m = run.at((i + j) / 2);
+    const QVector3D& b = run.at(j);
+
+    double d = 2 * (a.x() * (m.y() - b.y()) + m.x() * (b.y() - a.y()) + b.x() * (a.y() - m.y()));
+    if (qAbs(d) < 1e-12)
+        return false;
+
+    double a2 = a.x() * a.x() + a.y() * a.y();
+    double m2 = m.x() * m.x() + m.y() * m.y();
+    double b2 = b.x() * b.x() + b.y() * b.y();
+    double cx = (a2 * (m.y() - b.y()) + m2 * (b.y() - a.y()) + b2 * (a.y() - m.y())) / d;
+    double cy = (a2 * (b.x() - m.x()) + m2 * (a.x() - b.x()) + b2 * (m.x() - a.x())) / d;
+    double r = qSqrt((a.x() - cx) * (a.x() - cx) + (a.y() - cy) * (a.y() - cy));
+
+    double maxRadius = mm ? OPTIMIZE_ARC_MAX_RADIUS_MM : OPTIMIZE_ARC_MAX_RADIUS_MM / MM_IN_AN_INCH;
+    if (r > maxRadius)
+        return false;
+
+    double sweep = 0;
+    int sign = 0;
+    for (int k = i; k <= j; k++)
+    {
+        const QVector3D& pk = run.at(k);
+        if (qAbs(pk.z() - a.z()) > tol)
+            return false;
+
+        double dx = pk.x() - cx, dy = pk.y() - cy;
+        if (qAbs(qSqrt(dx * dx + dy * dy) - r) > tol)
+            return false;
+        if (k == j)
+            break;
+
+        const QVector3D& pn = run.at(k + 1);
+        double nx = pn.x() - cx, ny = pn.y() - cy;
+        double cross = dx * ny - dy * nx;
+        int s = cross > 0 ? 1 : (cross < 0 ? -1 : 0);
+        if (s == 0 || (sign != 0 && s != sign))
+            return false;
+        sign = s;
+        sweep += qAbs(qAtan2(cross, dx * nx + dy * ny));
+
+        // the arc bulges out of each original chord by its sagitta
+        double chord = qSqrt((pn.x() - pk.x()) * (pn.x() - pk.x()) + (pn.y() - pk.y()) * (pn.y() - pk.y()));
+        if (r - qSqrt(qMax(0.0, r * r - chord * chord / 4)) > tol)
+            return false;
+    }
+    // half a turn at most, well inside what Grbl computes accurately
+    if (sweep >= M_PI)
+        return false;
+
+    center = QVector3D(cx, cy, a.z());
+    cw = sign < 0;
+    return true;
+}
+
+void PathOptimizer::writeLine(QTextStream& out, int i, int j)
+{
+    QString block = axisWords(run.at(i), run.at(j));
+    if (lastMotion != 1)
+        block.prepend("G1 ");
+    writeBlock(out, block, (run.at(j) - run.at(i)).length(), true);
+    lastMotion = 1;
+}
+
+void PathOptimizer::writeArc(QTextStream& out, int i, int j, const QVector3D& center, bool cw)
+{
+    const QVector3D& a = run.at(i);
+    const QVector3D& b = run.at(j);
+
+    QString block = QString(cw ? "G2 " : "G3 ") + axisWords(a, b)
+            + " I" + number(center.x() - a.x()) + " J" + number(center.y() - a.y());
+
+    QVector3D ca = a - center, cb = b - center;
+    ca.setZ(0);
+    cb.setZ(0);
+    double angle = qAcos(qBound(-1.0, (double)QVector3D::dotProduct(ca, cb) / (ca.length() * cb.length()), 1.0));
+    writeBlock(out, block, ca.length() * angle, true);
+    lastMotion = cw ? 2 : 3;
+}
+
+void PathOptimizer::writeBlock(QTextStream& out, const QString& block, double length, bool feedMove)
+{
+    out << block << "\n";
+    result.linesOut++;
+    result.secondsOut += blockSeconds(block.trimmed(), length, feedMove);
+}
+
+// A block takes the longest of its move at the feed rate and its
+// transfer on the serial line, 10 bits per character.
+double PathOptimizer::blockSeconds(const QString& block, double length, bool feedMove) const
+{
+    double serial = (block.size() + 1) * 10.0 / baud;
+    double move = feedMove && feed > 0 ? length / feed * 60.0 : 0;
+    return qMax(serial, move);
+}
+
+// shortest text at the precision of the unit
+QString PathOptimizer::number(double v) const
+{
+    QString s = QString::number(v, 'f', mm ? 3 : 4);
+    if (s.contains('.'))
+    {
+        while (s.endsWith('0'))
+            s.chop(1);
+        if (s.endsWith('.'))
+            s.chop(1);
+    }
+    if (s == "-0")
+        s = "0";
+    return s;
+}
+
+// only the axes that move, an absolute block keeps the others
+QString PathOptimizer::axisWords(const QVector3D& from, const QVector3D& to) const
+{
+    QStringList words;
+    if (number(to.x()) != number(from.x()))
+        words << "X" + number(to.x());
+    if (number(to.y()) != number(from.y()))
+        words << "Y" + number(to.y());
+    if (number(to.z()) != number(from.z()) || words.isEmpty())
+        words << "Z" + number(to.z());
+    return words.join(" ");
+}
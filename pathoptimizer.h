@@ -0,0 +1,102 @@
+/****************************************************************
+ * pathoptimizer.h
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#ifndef PATHOPTIMIZER_H
+#define PATHOPTIMIZER_H
+
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+#include <QVector3D>
+
+// largest distance between the original and the optimized path
+#define DEFAULT_OPTIMIZE_TOLERANCE_MM   0.005
+// fewer segments are not worth an arc
+#define OPTIMIZE_ARC_MIN_SEGMENTS       4
+// longest run examined for one block, bounds the cost of the fit
+#define OPTIMIZE_MAX_RUN                256
+// flatter circles are left to the collinear merge
+#define OPTIMIZE_ARC_MAX_RADIUS_MM      1000.0
+// suffix of the optimized copy : 'part.nc' -> 'part-opt.nc'
+#define OPTIMIZE_FILE_SUFFIX            "-opt"
+
+class PathOptimizerStats
+{
+public:
+    PathOptimizerStats()
+        : linesIn(0), linesOut(0), merged(0), arcs(0),
+          secondsIn(0), secondsOut(0) {}
+
+public:
+    int linesIn;
+    int linesOut;
+    // G1 lines removed by collinear merge
+    int merged;
+    // G2/G3 blocks replacing G1 runs
+    int arcs;
+    // feed moves and serial transfer, see 'blockSeconds()'
+    double secondsIn;
+    double secondsOut;
+};
+
+// Rewrites runs of short G1 moves : collinear moves become one G1 and
+// moves lying on a circle of the XY plane become one G2/G3, both within
+// 'tolerance'. Every other line is copied as it is. The modal state is
+// followed with 'ProgramAnalyzer::processGCode()'.
+class PathOptimizer
+{
+public:
+    // tolerance in mm, divided for inch programs
+    PathOptimizer(double toleranceMm, int baudRate);
+
+    // any thread, one file at a time
+    bool optimize(const QString& inPath, const QString& outPath);
+    const PathOptimizerStats& stats() const;
+    QString errorString() const;
+
+    static QString optimizedPath(const QString& inPath);
+
+private:
+    bool isCandidate(const QString& raw, const QString& formatted, int g,
+                     bool absolute, double f) const;
+    bool keepsPosition(const QString& formatted, bool absolute) const;
+    bool fitArc(int i, int j, QVector3D& center, bool& cw) const;
+    void flush(QTextStream& out);
+    int lineEnd(int i) const;
+    int arcEnd(int i, QVector3D& center, bool& cw) const;
+    void writeLine(QTextStream& out, int i, int j);
+    void writeArc(QTextStream& out, int i, int j, const QVector3D& center, bool cw);
+    void writeBlock(QTextStream& out, const QString& block, double length, bool feedMove);
+    double blockSeconds(const QString& block, double length, bool feedMove) const;
+    QString number(double v) const;
+    QString axisWords(const QVector3D& from, const QVector3D& to) const;
+
+private:
+    double toleranceMm;
+    int baud;
+    PathOptimizerStats result;
+    QString error;
+
+    // state while reading
+    double tol;
+    bool mm;
+    int plane;
+    double feed;
+    int lastMotion;
+    // X, Y and Z programmed since the last unknown position
+    int axesKnown;
+    // run of candidate moves : 'run[0]' is the start point
+    QVector<QVector3D> run;
+    QStringList runLines;
+    bool runMm;
+    int runPlane;
+};
+
+#endif // PATHOPTIMIZER_H
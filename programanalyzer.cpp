@@ -0,0 +1,574 @@
+/****************************************************************
+ * programanalyzer.cpp
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#include "programanalyzer.h"
+
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QRegExp>
+#include <QStringList>
+#include <QVector3D>
+
+#include "gcode.h"
+#include "parsecache.h"
+#include "visu3D/Arc3D.h"
+
+ProgramAnalysis::ProgramAnalysis()
+    : valid(false), fileSize(0), lineCount(0), parsedLines(0), maxZ(0.0), mm(true)
+{
+}
+
+bool ProgramAnalysis::isCurrent() const
+{
+    QFileInfo info(path);
+    return valid && info.size() == fileSize && info.lastModified() == fileModified;
+}
+
+// Commands restoring the modal state in force before 'line' and moving
+// the tool above the last position, from the timeline of the program.
+// calls : 'MainWindow::begin()':1, 'MachineManager::resumeJob()':1
+QStringList ProgramAnalysis::resumePreamble(int line) const
+{
+    ModalState state = modalTimeline.at(line - 1);
+    int n = state.mm ? 3 : 4;
+    QStringList preamble;
+
+    preamble.append(state.mm ? "G21" : "G20");
+    if (state.plane == PLANE_XY_G17)
+        preamble.append("G17");
+    else if (state.plane == PLANE_ZX_G19)
+        preamble.append("G18");
+    else if (state.plane == PLANE_YZ_G18)
+        preamble.append("G19");
+    preamble.append("G90");
+
+    // last position reached before 'line', items are sorted by line
+    int lo = 0, hi = posList.size();
+    while (lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+        if (posList.at(mid).index < line)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    PosItem pos = lo > 0 ? posList.at(lo - 1) : PosItem();
+    QVector3D stored;
+    if (!store.isNull() && store->positionBefore(line, stored))
+        pos = PosItem(stored.x(), stored.y(), stored.z());
+
+    preamble.append(QString("G0 Z%1").arg(maxZ, 0, 'f', n));
+    preamble.append(QString("G0 X%1 Y%2").arg(pos.x, 0, 'f', n).arg(pos.y, 0, 'f', n));
+    if (state.spindle == 3 || state.spindle == 4)
+        preamble.append(QString("S%1 M%2").arg(state.speedspindle).arg(state.spindle));
+
+    QString plunge = QString("G1 Z%1").arg(pos.z, 0, 'f', n);
+    if (state.feedrate > 0)
+        plunge += QString(" F%1").arg(state.feedrate);
+    preamble.append(plunge);
+
+    if (state.motion == 0)
+        preamble.append("G0");
+    if (!state.absolute)
+        preamble.append("G91");
+
+    return preamble;
+}
+
+// Reads the whole file once : line index, moves and modal states.
+// calls : 'MainWindow::preProcessFile()':1, 'JobQueue::prepareNext()':1
+ProgramAnalysis ProgramAnalyzer::analyze(const QString& path, qint64 memoryLimit)
+{
+    ProgramAnalysis result;
+    result.path = path;
+
+    // a pipe is read only once, when it is sent : nothing to show before
+    if (StreamSource::isStream(path))
+    {
+        result.index = QSharedPointer<LineIndex>(new LineIndex());
+        result.valid = true;
+        return result;
+    }
+
+    QFileInfo info(path);
+    result.fileSize = info.size();
+    result.fileModified = info.lastModified();
+
+    // the parser reads the lines from the index, a compressed file is
+    // decompressed once
+    result.index = QSharedPointer<LineIndex>(new LineIndex());
+    if (!result.index->open(path, memoryLimit))
+        return result;
+    // the index is read by the GUI thread from now on
+    result.index->moveToThread(QCoreApplication::instance()->thread());
+
+    // too large for the moves to be kept in memory, the store is created
+    // at the first move when the units are known. The text of a
+    // compressed file is counted, not its size on the disk.
+    bool outOfCore = memoryLimit > 0 && result.index->size() > memoryLimit;
+
+    // a program opened before is not read again
+    if (!outOfCore)
+    {
+        result.contentHash = ParseCache::contentHash(path);
+        if (ParseCache::load(result))
+        {
+            result.lineHashes = result.index->lineHashes();
+            result.valid = true;
+            return result;
+        }
+    }
+
+    QVector3D plast;
+    QList<QVector3D> points;
+
+    ParseState state;
+    // per line : arc revolutions, G0..G3, feedrate 'Fxxxx', Spindle Speed 'Sxxxxx'
+    int p, g;
+    double fr, ss;
+    QVector3D xyz, ijk;
+    int index = 0;
+
+    while (index < result.index->lineCount())
+    {
+        index++;
+        if (parseLine(result.index->lineText(index - 1), state, p, g, fr, ss))
+        {
+            result.maxZ = qMax(result.maxZ, state.z);
+            xyz = QVector3D(state.x, state.y, state.z);
+            ijk = QVector3D(state.i, state.j, state.k);
+            if (outOfCore && result.store.isNull())
+            {
+                result.store = QSharedPointer<ToolpathStore>(new ToolpathStore());
+                if (!result.store->create(state.mm))
+                {
+                    result.store.clear();
+                    outOfCore = false;
+                }
+            }
+            if (!outOfCore)
+                result.posList.append(PosItem(xyz, ijk, p, state.arc, state.cw, state.mm, g,
+                                              state.plane, state.helix, index, fr, ss));
+            else if (g >= 0 && g <= 3)
+            {
+                points.clear();
+                if (g == 2 || g == 3)
+                {
+                    Arc3D curve(state.plane, state.cw, plast, xyz, ijk, 2, state.helix);
+                    curve.interpolateAng(state.mm ? TOOLPATH_ARC_TOL_MM : TOOLPATH_ARC_TOL_MM / MM_IN_AN_INCH, points);
+                }
+                if (points.isEmpty() || points.last() != xyz)
+                    points.append(xyz);
+                QVector3D a = plast;
+                foreach (const QVector3D& b, points)
+                {
+                    result.store->append(a, b, index, g);
+                    a = b;
+                }
+                plast = xyz;
+            }
+        }
+        result.modalTimeline.record(index, state.modal);
+    }
+
+    if (!result.store.isNull())
+    {
+        result.store->finish();
+        result.store->moveToThread(QCoreApplication::instance()->thread());
+    }
+
+    result.lineCount = index;
+    result.parsedLines = index;
+    result.mm = state.mm;
+    result.valid = true;
+    if (!outOfCore)
+    {
+        result.lineHashes = result.index->lineHashes();
+        ParseCache::save(result);
+    }
+    return result;
+}
+
+bool ProgramAnalyzer::ParseState::operator==(const ParseState& other) const
+{
+    return x == other.x && y == other.y && z == other.z
+        && i == other.i && j == other.j && k == other.k
+        && plane == other.plane && cw == other.cw && mm == other.mm
+        && helix == other.helix && absolute == other.absolute
+        && spindle == other.spindle && modal == other.modal;
+}
+
+// One line of the program, true for a move. 'state' carries the values
+// of the parser to the next line.
+bool ProgramAnalyzer::parseLine(QString strline, ParseState& state,
+                                int& p, int& g, double& fr, double& ss)
+{
+    GCode::trimToEnd(strline, '(');
+    GCode::trimToEnd(strline, ';');
+    GCode::trimToEnd(strline, '%');
+
+    strline = strline.trimmed();
+    g=0; p=0; fr=0.0; ss = 0.0;
+    bool move = false;
+    // ignore the white lines
+    if (strline.size() > 0)
+    {
+        strline = strline.toUpper();
+        strline.replace("M6", "M06");
+        strline.replace(QRegExp("([A-Z])"), " \\1");
+        strline.replace(QRegExp("\\s+"), " ");
+/// T4
+        move = processGCode(strline, state.x, state.y, state.z,
+                            state.i, state.j, state.k,
+                            p, state.arc, state.cw, state.mm, g,
+                            state.plane, state.helix, fr, ss,
+                            state.absolute, state.spindle
+                            );
+        if (move)
+            state.modal.motion = g;
+    }
+    /// Fxxxx
+    if (fr > 0)
+        state.modal.feedrate = fr;
+    /// Sxxxx
+    if (ss > 0)
+        state.modal.speedspindle = ss;
+    state.modal.mm = state.mm;
+    state.modal.plane = state.plane;
+    state.modal.absolute = state.absolute;
+    state.modal.spindle = state.spindle;
+    return move;
+}
+
+// Number of items of 'items' up to 'line', items are sorted by line.
+int ProgramAnalyzer::itemsUpTo(const QList<PosItem>& items, int line)
+{
+    int lo = 0, hi = items.size();
+    while (lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+        if (items.at(mid).index <= line)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// The parser after 'line' of an analysis, as far as its moves and modal
+// changes tell : the last move and the modal state of the line.
+ProgramAnalyzer::ParseState ProgramAnalyzer::stateAfter(const ProgramAnalysis& analysis, int line)
+{
+    ParseState state;
+    int n = itemsUpTo(analysis.posList, line);
+    if (n > 0)
+    {
+        const PosItem& item = analysis.posList.at(n - 1);
+        state.x = item.x; state.y = item.y; state.z = item.z;
+        state.i = item.i; state.j = item.j; state.k = item.k;
+        state.arc = item.arc;
+        state.cw = item.cw;
+        state.helix = item.helix;
+    }
+    if (line > 0)
+    {
+        state.modal = analysis.modalTimeline.at(line);
+        state.mm = state.modal.mm;
+        state.plane = state.modal.plane;
+        state.absolute = state.modal.absolute;
+        state.spindle = state.modal.spindle;
+    }
+    return state;
+}
+
+// Reads again only the lines that changed since 'previous' : the lines
+// between the common head and the common tail of both versions, then
+// the following lines until the parser is back in the state the
+// previous analysis had there (the modal ripple). The moves and modal
+// changes of the rest are kept, renumbered.
+// calls : 'MainWindow::reloadProgram()':1
+ProgramAnalysis ProgramAnalyzer::reanalyze(const ProgramAnalysis& previous, qint64 memoryLimit)
+{
+    const QString& path = previous.path;
+    QFileInfo info(path);
+    // the moves of an out of core program are not kept to be spliced
+    if (!previous.valid || !previous.store.isNull() || previous.lineHashes.isEmpty())
+        return analyze(path, memoryLimit);
+
+    ProgramAnalysis result;
+    result.path = path;
+    result.fileSize = info.size();
+    result.fileModified = info.lastModified();
+
+    result.index = QSharedPointer<LineIndex>(new LineIndex());
+    if (!result.index->open(path, memoryLimit) || result.index->lineCount() == 0
+        || (memoryLimit > 0 && result.index->size() > memoryLimit))
+        return analyze(path, memoryLimit);
+    result.lineHashes = result.index->lineHashes();
+
+    const QVector<uint>& before = previous.lineHashes;
+    const QVector<uint>& after = result.lineHashes;
+    int common = qMin(before.size(), after.size());
+    int head = 0;
+    while (head < common && before.at(head) == after.at(head))
+        head++;
+    int tail = 0;
+    while (tail < common - head
+           && before.at(before.size() - 1 - tail) == after.at(after.size() - 1 - tail))
+        tail++;
+    int delta = after.size() - before.size();
+
+    // unchanged head
+    int kept = itemsUpTo(previous.posList, head);
+    result.posList = previous.posList.mid(0, kept);
+    for (int n = 0; n < previous.modalTimeline.changeCount(); n++)
+    {
+        if (previous.modalTimeline.changeLine(n) > head)
+            break;
+        result.modalTimeline.record(previous.modalTimeline.changeLine(n),
+                                    previous.modalTimeline.changeState(n));
+    }
+
+    // changed lines, then the tail up to the first line where the
+    // parser is as it was
+    ParseState state = stateAfter(previous, head);
+    int p, g;
+    double fr, ss;
+    int line = head;
+    int synced = -1;
+    while (line < after.size())
+    {
+        if (line >= after.size() - tail && state == stateAfter(previous, line - delta))
+        {
+            synced = line - delta;
+            break;
+        }
+        line++;
+        if (parseLine(result.index->lineText(line - 1), state, p, g, fr, ss))
+            result.posList.append(PosItem(QVector3D(state.x, state.y, state.z),
+                                          QVector3D(state.i, state.j, state.k),
+                                          p, state.arc, state.cw, state.mm, g,
+                                          state.plane, state.helix, line, fr, ss));
+        result.modalTimeline.record(line, state.modal);
+    }
+    result.parsedLines = line - head;
+
+    // unchanged tail, renumbered
+    if (synced >= 0)
+    {
+        for (int n = itemsUpTo(previous.posList, synced); n < previous.posList.size(); n++)
+        {
+            PosItem item = previous.posList.at(n);
+            item.index += delta;
+            result.posList.append(item);
+        }
+        for (int n = 0; n < previous.modalTimeline.changeCount(); n++)
+        {
+            if (previous.modalTimeline.changeLine(n) > synced)
+                result.modalTimeline.record(previous.modalTimeline.changeLine(n) + delta,
+                                            previous.modalTimeline.changeState(n));
+        }
+    }
+
+    foreach (const PosItem& item, result.posList)
+        result.maxZ = qMax(result.maxZ, item.z);
+    result.lineCount = after.size();
+    result.mm = result.modalTimeline.at(result.lineCount).mm;
+    result.valid = true;
+
+    result.index->moveToThread(QCoreApplication::instance()->thread());
+    result.contentHash = ParseCache::contentHash(path);
+    ParseCache::save(result);
+    return result;
+}
+
+/// T4
+bool ProgramAnalyzer::processGCode(QString inputLine,
+                            double& x, double& y, double& z,
+                            double& i, double& j, double& k,
+                            int& p, bool& arc, bool& cw, bool& mm, int& g,
+                            int& plane, bool& helix, double& f, double& sp,
+                            bool& absolute, int& spindle
+                            )
+{
+    QString line = inputLine.toUpper();
+    QStringList components = line.split(" ", QString::SkipEmptyParts);
+    QString s;
+    arc = false;
+    bool valid = false;
+    f = 0.0;
+    sp = 0.0;
+    int nextIsValue = NO_ITEM;
+    int value;
+    bool bi(false), bj(false), bk(false);
+  //  bool bx(false), by(false), bz(false);
+    foreach (s, components)
+    {
+//diag("s= %s", qPrintable(s) );
+        if (s.at(0) == 'F') {
+            f = decodeLineItem(s, F_ITEM, valid, nextIsValue);
+        }
+        else
+        if (s.at(0) == 'S') {
+            sp = decodeLineItem(s, S_ITEM, valid, nextIsValue);
+        }
+        else
+        if (s.at(0) == 'M')
+        {
+            value = s.mid(1).toInt();
+            if (value == 3 || value == 4 || value == 5)
+                spindle = value;
+        }
+        else
+        if (s.at(0) == 'G')
+        {
+            value = s.mid(1).toInt();
+            if (value >= 0 && value <= 3)
+            {
+                g = value;
+                if (value == 2)
+                    cw = true;
+                else if (value == 3)
+                    cw = false;
+            }
+            else if (value == 20)
+                mm = false;
+            else if (value == 21)
+                mm = true;
+            else if (value == 90)
+                absolute = true;
+            else if (value == 91)
+                absolute = false;
+/// T4   for arcs
+            else if (value == 17)   // plane XY
+                plane = PLANE_XY_G17;
+            else if (value == 18)   // plane ZX
+                plane = PLANE_ZX_G19;
+            else if (value == 19)   // plane YZ
+                plane = PLANE_YZ_G18;
+        }
+        else if (g >= 0 && g <= 3 && s.at(0) == 'X')
+        {
+            x = decodeLineItem(s, X_ITEM, valid, nextIsValue);
+            helix = plane == PLANE_YZ_G18;
+        }
+        else if (g >= 0 && g <= 3 && s.at(0) == 'Y')
+        {
+            y = decodeLineItem(s, Y_ITEM, valid, nextIsValue);
+            helix = plane == PLANE_ZX_G19;
+        }
+/// T4
+        else if (g >= 0 && g <= 3 && s.at(0) == 'Z')
+        {
+            z = decodeLineItem(s, Z_ITEM, valid, nextIsValue);
+            helix = plane == PLANE_XY_G17;
+        }
+        else if ((g == 2 || g == 3) && s.at(0) == 'I')
+        {
+            i = decodeLineItem(s, I_ITEM, arc, nextIsValue);
+            bi = true;
+        }
+        else if ((g == 2 || g == 3) && s.at(0) == 'J')
+        {
+            j = decodeLineItem(s, J_ITEM, arc, nextIsValue);
+            bj = true;
+        }
+/// T4
+        else if ((g == 2 || g == 3) && s.at(0) == 'K')
+        {
+            k = decodeLineItem(s, K_ITEM, arc, nextIsValue);
+            bk = true;
+        }
+        else if ((g == 2 || g == 3) && s.at(0) == 'P')
+        {
+            p = decodeLineItem(s, P_ITEM, valid, nextIsValue);
+        }
+/// Fxxxx
+        else if ((g == 1 || g == 2 || g == 3) && s.at(0) == 'F')
+        {
+            f = decodeLineItem(s, F_ITEM, valid, nextIsValue);
+        }
+        else if ((g == 1 || g == 2 || g == 3) && s.at(0) == 'S')
+        {
+            sp = decodeLineItem(s, S_ITEM, valid, nextIsValue);
+        }
+/// <--
+        else if (nextIsValue != NO_ITEM)
+        {
+            switch (nextIsValue)
+            {
+            case X_ITEM:
+                x = decodeDouble(s, valid);
+                break;
+            case Y_ITEM:
+                y = decodeDouble(s, valid);
+                break;
+/// T4
+            case Z_ITEM:
+                z = decodeDouble(s, valid);
+                break;
+            case I_ITEM:
+                i = decodeDouble(s, arc);
+                break;
+            case J_ITEM:
+                j = decodeDouble(s, arc);
+                break;
+/// T4
+            case K_ITEM:
+                k = decodeDouble(s, arc);
+                break;
+            case P_ITEM:
+                p = decodeDouble(s, valid);
+                break;
+            case F_ITEM:
+                f = decodeDouble(s, valid);
+                break;
+            case S_ITEM:
+                sp = decodeDouble(s, valid);
+                break;
+            };
+            nextIsValue = NO_ITEM;
+        }
+        // plane if NO_PLANE
+        if (!(plane == PLANE_XY_G17 || plane == PLANE_YZ_G18 || plane == PLANE_ZX_G19) )
+        {
+            if (bi && bj && !bk)
+                plane = PLANE_XY_G17 ;
+            else
+            if (bi && !bj && bk)
+                plane = PLANE_ZX_G19 ;
+            else
+            if (!bi && bj && bk)
+                plane = PLANE_YZ_G18 ;
+        }
+    }
+    return valid;
+}
+
+double ProgramAnalyzer::decodeLineItem(const QString& item, const int next, bool& valid, int& nextIsValue)
+{
+    if (item.size() == 1)
+    {
+        nextIsValue = next;
+        return 0;
+    }
+    else
+    {
+        nextIsValue = NO_ITEM;
+        return decodeDouble(item.mid(1,-1), valid);
+    }
+}
+
+double ProgramAnalyzer::decodeDouble(QString value, bool& valid)
+{
+    if (value.indexOf(QRegExp("^[+-]?[0-9]*\\.?[0-9]*$")) == -1)
+        return 0;
+    valid = true;
+    return value.toDouble();
+}
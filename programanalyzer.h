@@ -0,0 +1,116 @@
+/****************************************************************
+ * programanalyzer.h
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#ifndef PROGRAMANALYZER_H
+#define PROGRAMANALYZER_H
+
+#include <QDateTime>
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+
+#include "lineindex.h"
+#include "modaltimeline.h"
+#include "positem.h"
+#include "toolpathstore.h"
+
+// Everything the GUI needs to show a program, built without any widget
+// so that it can be prepared on a worker thread.
+class ProgramAnalysis
+{
+public:
+    ProgramAnalysis();
+
+    // false when the file changed on the disk since the analysis
+    bool isCurrent() const;
+    // to send the program from 'line', 1 based
+    QStringList resumePreamble(int line) const;
+
+public:
+    QString path;
+    bool valid;
+    qint64 fileSize;
+    QDateTime fileModified;
+    // SHA-1 of the file, key of 'ParseCache'
+    QByteArray contentHash;
+    // line offsets, text for 'ui->visuGcode'
+    QSharedPointer<LineIndex> index;
+    int lineCount;
+    // hash of each line, to find the lines changed by a new version
+    QVector<uint> lineHashes;
+    // lines read by the parser, 0 when all came from 'ParseCache'
+    int parsedLines;
+    // moves for the 2D and 3D viewers, empty when out of core
+    QList<PosItem> posList;
+    // moves of a program above the memory limit, for the 3D viewer
+    QSharedPointer<ToolpathStore> store;
+    ModalTimeline modalTimeline;
+    // highest Z, clearance when resuming
+    double maxZ;
+    bool mm;
+};
+
+// G-code reader of 'MainWindow::preProcessFile()', thread safe
+class ProgramAnalyzer
+{
+public:
+    // files larger than 'memoryLimit' bytes go to a 'ToolpathStore',
+    // 0 keeps everything in memory
+    static ProgramAnalysis analyze(const QString& path, qint64 memoryLimit);
+    // new version of the file of 'previous', only its changes are parsed
+    static ProgramAnalysis reanalyze(const ProgramAnalysis& previous, qint64 memoryLimit);
+
+/// T4  3 axes + plane
+    static bool processGCode(QString inputLine,
+                        double& x, double& y, double& z,
+                        double& i, double& j, double& k,
+                        int& p, bool& arc, bool& cw, bool& mm,
+                        int& g, int& plane, bool& helix,
+                        double& f, double& ss,
+                        bool& absolute, int& spindle
+                        );
+
+private:
+    // parser values carried from one line to the next
+    class ParseState
+    {
+    public:
+        ParseState()
+            : x(0), y(0), z(0), i(0), j(0), k(0), plane(NO_PLANE),
+              arc(false), cw(false), mm(true), helix(false), absolute(true), spindle(5) {}
+
+        // 'arc' is set again by each line
+        bool operator==(const ParseState& other) const;
+
+    public:
+        double x, y, z, i, j, k;
+        int plane;
+        bool arc, cw, mm, helix, absolute;
+        int spindle;
+        // modal values, one entry in the timeline each time they change
+        ModalState modal;
+    };
+
+    static bool parseLine(QString strline, ParseState& state,
+                          int& p, int& g, double& fr, double& ss);
+    static int itemsUpTo(const QList<PosItem>& items, int line);
+    static ParseState stateAfter(const ProgramAnalysis& analysis, int line);
+
+    enum
+    {
+        NO_ITEM = 0, X_ITEM, Y_ITEM, Z_ITEM, I_ITEM, J_ITEM, K_ITEM,
+        P_ITEM, F_ITEM, S_ITEM
+    };
+
+    static double decodeLineItem(const QString& item, const int next, bool& valid, int& nextIsValue);
+    static double decodeDouble(QString value, bool& valid);
+};
+
+#endif // PROGRAMANALYZER_H
@@ -1,11 +1,14 @@
 #include "renderarea.h"
 
+#include <QMouseEvent>
+
 RenderArea::RenderArea(QWidget *parent)
     : QWidget(parent),
       penProposedPath(QPen(Qt::blue)), penAxes(QPen(QColor(193,97,0))),
       penCoveredPath(QPen(QColor(60,196,70), 2)),
       penCurrPosActive(QPen(Qt::red, 6)), penCurrPosInactive(QPen(QColor(60,196,70), 6)),
-      penMeasure(QPen(QColor(151,111,26))), isLiveCurrPos(false)
+      penMeasure(QPen(QColor(151,111,26))), isLiveCurrPos(false), segmentIndex(NULL),
+      scheduler(NULL)
 {
     penCurrPosActive.setCapStyle(Qt::RoundCap);
     penCurrPosInactive.setCapStyle(Qt::RoundCap);
@@ -26,8 +29,7 @@ void RenderArea::setLivePoint(double x, double y, bool mm, bool isLiveCP)
     isLiveCurrPos = isLiveCP;
     livePoint.setCoords(x, y, mm);
     listToRender.setLivePoint(livePoint);
-    update();
-
+    schedule();
 }
 
 void RenderArea::setVisualLivenessCurrPos(bool isLiveCP)
@@ -38,9 +40,41 @@ void RenderArea::setVisualLivenessCurrPos(bool isLiveCP)
 void RenderArea::setVisCurrLine(int currLine)
 {
     if (listToRender.setCurrFileLine(currLine))
+        schedule();
+}
+
+void RenderArea::setSegmentIndex(const SegmentIndex *index)
+{
+    segmentIndex = index;
+}
+
+void RenderArea::setFrameScheduler(FrameScheduler *frames)
+{
+    scheduler = frames;
+}
+
+// several positions and lines per frame are painted once
+void RenderArea::schedule()
+{
+    if (scheduler != NULL)
+        scheduler->invalidate(this);
+    else
         update();
 }
 
+void RenderArea::mousePressEvent(QMouseEvent *event)
+{
+    QWidget::mousePressEvent(event);
+
+    if (event->button() != Qt::LeftButton || segmentIndex == NULL || !items.size())
+        return;
+
+    QPointF p = listToRender.toFile(event->pos());
+    int line = segmentIndex->pickPoint(p, listToRender.toFileLength(PICK_RADIUS_PIXELS));
+    if (line > 0)
+        emit linePicked(line);
+}
+
 void RenderArea::paintEvent(QPaintEvent * /* event */)
 {
     if (!items.size())
@@ -9,6 +9,11 @@
 #include "renderitemlist.h"
 #include "arcitem.h"
 #include "lineitem.h"
+#include "segmentindex.h"
+#include "framescheduler.h"
+
+// distance in pixels of a click to the picked segment
+#define PICK_RADIUS_PIXELS  5
 
 class RenderArea : public QWidget
 {
@@ -16,7 +21,14 @@ class RenderArea : public QWidget
 public:
     explicit RenderArea(QWidget *parent = 0);
 
+    // the index must stay valid until the next call, 0 to detach
+    void setSegmentIndex(const SegmentIndex *index);
+    // live updates are repainted at its frames, 0 for at once
+    void setFrameScheduler(FrameScheduler *frames);
+
 signals:
+    // the user clicked a segment of 'line'
+    void linePicked(int line);
 
 public slots:
     void setItems(QList<PosItem>);
@@ -27,6 +39,10 @@ public slots:
 
 protected:
     void paintEvent(QPaintEvent *event);
+    void mousePressEvent(QMouseEvent *event);
+
+private:
+    void schedule();
 
 private:
     QList<PosItem> items;
@@ -34,6 +50,8 @@ private:
     QPen penProposedPath, penAxes, penCoveredPath, penCurrPosActive, penCurrPosInactive, penMeasure;
     PosItem livePoint;
     bool isLiveCurrPos;
+    const SegmentIndex *segmentIndex;
+    FrameScheduler *scheduler;
 };
 
 #endif // RENDERAREA_H
@@ -220,6 +220,18 @@ bool RenderItemList::setCurrFileLine(const int currLine)
     return false;
 }
 
+// inverse of 'ItemToBase::screenX()' and 'ItemToBase::screenY()'
+QPointF RenderItemList::toFile(const QPoint& pixel) const
+{
+    return QPointF((pixel.x() - offsetx) / scale,
+                   (windowSize.height() - pixel.y() - offsety) / scale);
+}
+
+double RenderItemList::toFileLength(double pixels) const
+{
+    return pixels / scale;
+}
+
 void RenderItemList::setLivePoint(const PosItem& livePoint1)
 {
     livePoint = livePoint1;
@@ -21,6 +21,9 @@ public:
     bool setCurrFileLine(const int currLine);
     void setLivePoint(const PosItem& livePoint);
     void updateLivePoint();
+    // file coordinates of a pixel and of a length in pixels
+    QPointF toFile(const QPoint& pixel) const;
+    double toFileLength(double pixels) const;
 
 private:
     void clearList();
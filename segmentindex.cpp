@@ -0,0 +1,445 @@
+/****************************************************************
+ * segmentindex.cpp
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#include "segmentindex.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <QVarLengthArray>
+
+#include "visu3D/Arc3D.h"
+
+namespace
+{
+    // nodes waiting in a traversal, the depth of the tree is about
+    // log2(segments / SEGMENT_LEAF_SIZE)
+    typedef QVarLengthArray<int, 64> NodeStack;
+
+    struct CentroidLess
+    {
+        explicit CentroidLess(int axis) : k(axis) {}
+        template <class S> bool operator()(const S& s1, const S& s2) const
+        {
+            return s1.a[k] + s1.b[k] < s2.a[k] + s2.b[k];
+        }
+        int k;
+    };
+
+    // part [t0, t1] of 'o + t d' inside the box grown by 'pad'
+    bool clipSlab(const double o[3], const double d[3], const float lo[3], const float hi[3],
+                  double pad, double& t0, double& t1)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            double l = lo[k] - pad, h = hi[k] + pad;
+            if (qAbs(d[k]) < 1e-12)
+            {
+                if (o[k] < l || o[k] > h)
+                    return false;
+                continue;
+            }
+            double ta = (l - o[k]) / d[k];
+            double tb = (h - o[k]) / d[k];
+            if (ta > tb)
+                qSwap(ta, tb);
+            t0 = qMax(t0, ta);
+            t1 = qMin(t1, tb);
+            if (t0 > t1)
+                return false;
+        }
+        return true;
+    }
+
+    double dot(const double u[3], const double v[3])
+    {
+        return u[0]*v[0] + u[1]*v[1] + u[2]*v[2];
+    }
+}
+
+SegmentIndex::SegmentIndex()
+{
+}
+
+SegmentIndex *SegmentIndex::create(QList<PosItem> items)
+{
+    SegmentIndex *index = new SegmentIndex();
+    index->build(items);
+    return index;
+}
+
+void SegmentIndex::clear()
+{
+    segments.clear();
+    nodes.clear();
+}
+
+// arcs are cut with the same 'Arc3D::interpolateAng()' as the 3D view
+void SegmentIndex::build(const QList<PosItem>& items)
+{
+    clear();
+    if (items.size() < 2)
+        return;
+
+    double minX = items.first().x, maxX = minX, minY = items.first().y, maxY = minY;
+    foreach (const PosItem& item, items)
+    {
+        minX = qMin(minX, item.x); maxX = qMax(maxX, item.x);
+        minY = qMin(minY, item.y); maxY = qMax(maxY, item.y);
+    }
+    double tol = qMax(maxX - minX, maxY - minY) / SEGMENT_ARC_DIVISOR;
+    if (tol <= 0)
+        tol = TOL_MM_STEP;
+
+    segments.reserve(items.size());
+    QVector3D plast(items.first().x, items.first().y, items.first().z);
+    QList<QVector3D> points;
+    foreach (const PosItem& item, items)
+    {
+        if (item.g < 0 || item.g > 3)
+            continue;
+
+        QVector3D pend(item.x, item.y, item.z);
+        points.clear();
+        if (item.g == 2 || item.g == 3)
+        {
+            Arc3D arc(item.plane, item.cw, plast, pend, QVector3D(item.i, item.j, item.k), 2, item.helix);
+            arc.interpolateAng(tol, points);
+        }
+        if (points.isEmpty() || points.last() != pend)
+            points.append(pend);
+
+        QVector3D a = plast;
+        foreach (const QVector3D& b, points)
+        {
+            addSegment(a, b, item.index);
+            a = b;
+        }
+        plast = pend;
+    }
+    segments.squeeze();
+    buildNodes();
+}
+
+void SegmentIndex::addSegment(const QVector3D& a, const QVector3D& b, int line)
+{
+    Segment s;
+    s.a[0] = a.x(); s.a[1] = a.y(); s.a[2] = a.z();
+    s.b[0] = b.x(); s.b[1] = b.y(); s.b[2] = b.z();
+    s.line = line;
+    segments.append(s);
+}
+
+// Top down, split at the median of the centroids along the longest
+// side. Nodes are stored depth first : the left child of a node is the
+// next one, so only the right child index is kept.
+void SegmentIndex::buildNodes()
+{
+    struct Task
+    {
+        int first, count, parent;
+    };
+
+    nodes.clear();
+    if (segments.isEmpty())
+        return;
+    nodes.reserve(2 * segments.size() / SEGMENT_LEAF_SIZE + 1);
+
+    QVector<Task> tasks;
+    Task root = { 0, segments.size(), -1 };
+    tasks.append(root);
+    while (!tasks.isEmpty())
+    {
+        Task t = tasks.last();
+        tasks.removeLast();
+
+        int n = nodes.size();
+        if (t.parent >= 0)
+            nodes[t.parent].first = n;
+        Node node;
+        float clo[3], chi[3];
+        for (int k = 0; k < 3; k++)
+        {
+            node.lo[k] = clo[k] = FLT_MAX;
+            node.hi[k] = chi[k] = -FLT_MAX;
+        }
+        for (int i = t.first; i < t.first + t.count; i++)
+        {
+            const Segment& s = segments.at(i);
+            for (int k = 0; k < 3; k++)
+            {
+                node.lo[k] = qMin(node.lo[k], qMin(s.a[k], s.b[k]));
+                node.hi[k] = qMax(node.hi[k], qMax(s.a[k], s.b[k]));
+                clo[k] = qMin(clo[k], s.a[k] + s.b[k]);
+                chi[k] = qMax(chi[k], s.a[k] + s.b[k]);
+            }
+        }
+        int axis = 0;
+        for (int k = 1; k < 3; k++)
+        {
+            if (chi[k] - clo[k] > chi[axis] - clo[axis])
+                axis = k;
+        }
+
+        if (t.count <= SEGMENT_LEAF_SIZE || chi[axis] <= clo[axis])
+        {
+            node.first = t.first;
+            node.count = t.count;
+            nodes.append(node);
+            continue;
+        }
+
+        node.first = -1;
+        node.count = 0;
+        nodes.append(node);
+
+        int half = t.count / 2;
+        Segment *base = segments.data() + t.first;
+        std::nth_element(base, base + half, base + t.count, CentroidLess(axis));
+        // the left child is popped first, right after its parent
+        Task right = { t.first + half, t.count - half, n };
+        Task left = { t.first, half, -1 };
+        tasks.append(right);
+        tasks.append(left);
+    }
+}
+
+bool SegmentIndex::isEmpty() const
+{
+    return nodes.isEmpty();
+}
+
+int SegmentIndex::segmentCount() const
+{
+    return segments.size();
+}
+
+QVector3D SegmentIndex::boundsMin() const
+{
+    if (nodes.isEmpty())
+        return QVector3D();
+    return QVector3D(nodes.first().lo[0], nodes.first().lo[1], nodes.first().lo[2]);
+}
+
+QVector3D SegmentIndex::boundsMax() const
+{
+    if (nodes.isEmpty())
+        return QVector3D();
+    return QVector3D(nodes.first().hi[0], nodes.first().hi[1], nodes.first().hi[2]);
+}
+
+// calls : 'Viewer::select()':1
+int SegmentIndex::pickRay(const QVector3D& origin, const QVector3D& dir, double radius) const
+{
+    if (nodes.isEmpty() || dir.isNull())
+        return 0;
+
+    QVector3D nd = dir.normalized();
+    double o[3] = { origin.x(), origin.y(), origin.z() };
+    double d[3] = { nd.x(), nd.y(), nd.z() };
+    double bestT = DBL_MAX;
+    int bestLine = 0;
+
+    NodeStack stack;
+    stack.append(0);
+    while (!stack.isEmpty())
+    {
+        int n = stack.last();
+        stack.removeLast();
+        const Node& node = nodes.at(n);
+
+        double t0 = 0, t1 = DBL_MAX;
+        if (!clipSlab(o, d, node.lo, node.hi, radius, t0, t1) || t0 > bestT)
+            continue;
+        if (!node.count)
+        {
+            stack.append(node.first);
+            stack.append(n + 1);
+            continue;
+        }
+
+        for (int i = node.first; i < node.first + node.count; i++)
+        {
+            const Segment& s = segments.at(i);
+            // closest points of 'o + t d' and 'a + u v', t >= 0 and u in [0, 1]
+            double v[3] = { s.b[0] - s.a[0], s.b[1] - s.a[1], s.b[2] - s.a[2] };
+            double w[3] = { o[0] - s.a[0], o[1] - s.a[1], o[2] - s.a[2] };
+            double b = dot(d, v), c = dot(v, v), e = dot(v, w), f = dot(d, w);
+            double u = 0, t;
+            if (c > 1e-18)
+            {
+                double den = c - b*b;
+                t = den > 1e-12 ? qMax(0.0, (b*e - c*f) / den) : 0.0;
+                u = qBound(0.0, (e + t*b) / c, 1.0);
+            }
+            t = qMax(0.0, u*b - f);
+
+            double dist2 = 0;
+            for (int k = 0; k < 3; k++)
+            {
+                double r = w[k] + t*d[k] - u*v[k];
+                dist2 += r*r;
+            }
+            if (dist2 <= radius*radius && t < bestT)
+            {
+                bestT = t;
+                bestLine = s.line;
+            }
+        }
+    }
+    return bestLine;
+}
+
+// calls : 'RenderArea::mousePressEvent()':1
+int SegmentIndex::pickPoint(const QPointF& p, double radius) const
+{
+    if (nodes.isEmpty())
+        return 0;
+
+    double best2 = radius*radius;
+    int bestLine = 0;
+
+    NodeStack stack;
+    stack.append(0);
+    while (!stack.isEmpty())
+    {
+        int n = stack.last();
+        stack.removeLast();
+        const Node& node = nodes.at(n);
+
+        double dx = qMax(0.0, qMax(node.lo[0] - p.x(), p.x() - node.hi[0]));
+        double dy = qMax(0.0, qMax(node.lo[1] - p.y(), p.y() - node.hi[1]));
+        if (dx*dx + dy*dy > best2)
+            continue;
+        if (!node.count)
+        {
+            stack.append(node.first);
+            stack.append(n + 1);
+            continue;
+        }
+
+        for (int i = node.first; i < node.first + node.count; i++)
+        {
+            const Segment& s = segments.at(i);
+            double vx = s.b[0] - s.a[0], vy = s.b[1] - s.a[1];
+            double wx = p.x() - s.a[0], wy = p.y() - s.a[1];
+            double c = vx*vx + vy*vy;
+            double u = c > 1e-18 ? qBound(0.0, (wx*vx + wy*vy) / c, 1.0) : 0.0;
+            double rx = wx - u*vx, ry = wy - u*vy;
+            double dist2 = rx*rx + ry*ry;
+            if (dist2 <= best2)
+            {
+                best2 = dist2;
+                bestLine = s.line;
+            }
+        }
+    }
+    return bestLine;
+}
+
+QVector<int> SegmentIndex::linesInBox(const QVector3D& lo, const QVector3D& hi) const
+{
+    QVector<int> lines;
+    if (nodes.isEmpty())
+        return lines;
+
+    float blo[3] = { lo.x(), lo.y(), lo.z() };
+    float bhi[3] = { hi.x(), hi.y(), hi.z() };
+
+    NodeStack stack;
+    stack.append(0);
+    while (!stack.isEmpty())
+    {
+        int n = stack.last();
+        stack.removeLast();
+        const Node& node = nodes.at(n);
+
+        bool overlap = true;
+        for (int k = 0; k < 3 && overlap; k++)
+            overlap = node.lo[k] <= bhi[k] && node.hi[k] >= blo[k];
+        if (!overlap)
+            continue;
+        if (!node.count)
+        {
+            stack.append(node.first);
+            stack.append(n + 1);
+            continue;
+        }
+
+        for (int i = node.first; i < node.first + node.count; i++)
+        {
+            const Segment& s = segments.at(i);
+            double o[3] = { s.a[0], s.a[1], s.a[2] };
+            double d[3] = { s.b[0] - s.a[0], s.b[1] - s.a[1], s.b[2] - s.a[2] };
+            double t0 = 0, t1 = 1;
+            if (clipSlab(o, d, blo, bhi, 0, t0, t1))
+                lines.append(s.line);
+        }
+    }
+    return uniqueLines(lines);
+}
+
+QVector<int> SegmentIndex::linesInFrustum(const double coef[6][4]) const
+{
+    QVector<int> lines;
+    if (nodes.isEmpty())
+        return lines;
+
+    NodeStack stack;
+    stack.append(0);
+    while (!stack.isEmpty())
+    {
+        int n = stack.last();
+        stack.removeLast();
+        const Node& node = nodes.at(n);
+
+        // out when the corner nearest to the inside is out of one plane
+        bool out = false;
+        for (int p = 0; p < 6 && !out; p++)
+        {
+            double dist = -coef[p][3];
+            for (int k = 0; k < 3; k++)
+                dist += coef[p][k] * (coef[p][k] > 0 ? node.lo[k] : node.hi[k]);
+            out = dist > 0;
+        }
+        if (out)
+            continue;
+        if (!node.count)
+        {
+            stack.append(node.first);
+            stack.append(n + 1);
+            continue;
+        }
+
+        for (int i = node.first; i < node.first + node.count; i++)
+        {
+            const Segment& s = segments.at(i);
+            for (int p = 0; p < 6 && !out; p++)
+            {
+                double da = -coef[p][3], db = -coef[p][3];
+                for (int k = 0; k < 3; k++)
+                {
+                    da += coef[p][k] * s.a[k];
+                    db += coef[p][k] * s.b[k];
+                }
+                out = da > 0 && db > 0;
+            }
+            if (!out)
+                lines.append(s.line);
+            out = false;
+        }
+    }
+    return uniqueLines(lines);
+}
+
+QVector<int> SegmentIndex::uniqueLines(QVector<int> lines)
+{
+    std::sort(lines.begin(), lines.end());
+    lines.erase(std::unique(lines.begin(), lines.end()), lines.end());
+    return lines;
+}
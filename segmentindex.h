@@ -0,0 +1,81 @@
+/****************************************************************
+ * segmentindex.h
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#ifndef SEGMENTINDEX_H
+#define SEGMENTINDEX_H
+
+#include <QList>
+#include <QPointF>
+#include <QVector>
+#include <QVector3D>
+
+#include "positem.h"
+
+// segments in a leaf of the hierarchy
+#define SEGMENT_LEAF_SIZE       4
+// arcs are cut in segments of at most 1/SEGMENT_ARC_DIVISOR of the
+// largest side of the program
+#define SEGMENT_ARC_DIVISOR     2000
+
+// Bounding volume hierarchy over the straight segments of a program,
+// arcs cut as for the 3D view, each segment keeping the line it comes
+// from. A pick or a box query visits O(log n) nodes instead of every
+// segment. The index is built by a worker thread, see 'create()', and
+// is read only afterwards.
+class SegmentIndex
+{
+public:
+    SegmentIndex();
+
+    // calls : 'MainWindow::preProcessFile()' through QtConcurrent
+    static SegmentIndex *create(QList<PosItem> items);
+    void build(const QList<PosItem>& items);
+    void clear();
+
+    bool isEmpty() const;
+    int segmentCount() const;
+    QVector3D boundsMin() const;
+    QVector3D boundsMax() const;
+
+    // line of the segment passing within 'radius' of the ray, the one
+    // nearest to 'origin' when several do, 0 if none
+    int pickRay(const QVector3D& origin, const QVector3D& dir, double radius) const;
+    // line of the segment nearest to 'p' in the XY plane within 'radius'
+    int pickPoint(const QPointF& p, double radius) const;
+    // lines with a segment crossing the box, in increasing order
+    QVector<int> linesInBox(const QVector3D& lo, const QVector3D& hi) const;
+    // lines with a segment inside the frustum given by its planes
+    // 'a x + b y + c z - d = 0', normals outward as in
+    // 'qglviewer::Camera::getFrustumPlanesCoefficients()'
+    QVector<int> linesInFrustum(const double coef[6][4]) const;
+
+private:
+    struct Segment
+    {
+        float a[3], b[3];
+        int line;
+    };
+    struct Node
+    {
+        float lo[3], hi[3];
+        // leaf : 'count' segments from 'first', else the left child
+        // follows the node and 'first' is the right child
+        int first, count;
+    };
+
+    void addSegment(const QVector3D& a, const QVector3D& b, int line);
+    void buildNodes();
+    static QVector<int> uniqueLines(QVector<int> lines);
+
+private:
+    QVector<Segment> segments;
+    QVector<Node> nodes;
+};
+
+#endif // SEGMENTINDEX_H
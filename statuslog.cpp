@@ -0,0 +1,288 @@
+/****************************************************************
+ * statuslog.cpp
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#include "statuslog.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QScrollBar>
+#include <QStandardPaths>
+#include <QTimerEvent>
+
+#include "asyncfileappender.h"
+#include "log4qt/patternlayout.h"
+
+StatusLogModel::StatusLogModel(int capacity)
+    : head(0), used(0), appended(0), spillLog(NULL), spilled(0)
+{
+    ring.resize(qMax(1, capacity));
+}
+
+StatusLogModel::~StatusLogModel()
+{
+    closeSpillFile();
+}
+
+void StatusLogModel::setCapacity(int capacity)
+{
+    capacity = qMax(1, capacity);
+    if (capacity == ring.size())
+        return;
+
+    int keep = qMin(used, capacity);
+    for (int row = 0; row < used - keep; row++)
+        spill(line(row));
+
+    QVector<QString> resized(capacity);
+    for (int i = 0; i < keep; i++)
+        resized[i] = line(used - keep + i);
+
+    ring = resized;
+    head = 0;
+    used = keep;
+}
+
+int StatusLogModel::capacity() const
+{
+    return ring.size();
+}
+
+int StatusLogModel::count() const
+{
+    return used;
+}
+
+const QString& StatusLogModel::line(int row) const
+{
+    return ring.at((head + row) % ring.size());
+}
+
+qint64 StatusLogModel::total() const
+{
+    return appended;
+}
+
+void StatusLogModel::append(const QStringList& lines)
+{
+    int size = ring.size();
+    foreach (const QString& text, lines)
+    {
+        if (used < size)
+        {
+            ring[(head + used) % size] = text;
+            used++;
+        }
+        else
+        {
+            // full : the oldest line leaves memory
+            spill(ring.at(head));
+            ring[head] = text;
+            head = (head + 1) % size;
+        }
+        appended++;
+    }
+}
+
+// calls : 'StatusLogView::removeSelectedLines()':1
+void StatusLogModel::removeRows(int first, int last)
+{
+    if (first < 0 || last < first || first >= used)
+        return;
+    last = qMin(last, used - 1);
+
+    QVector<QString> kept(ring.size());
+    int n = 0;
+    for (int row = 0; row < used; row++)
+    {
+        if (row < first || row > last)
+            kept[n++] = line(row);
+    }
+    ring = kept;
+    head = 0;
+    used = n;
+}
+
+void StatusLogModel::clear()
+{
+    for (int row = 0; row < used; row++)
+        ring[(head + row) % ring.size()].clear();
+    head = 0;
+    used = 0;
+}
+
+void StatusLogModel::setSpillFile(const QString& path)
+{
+    closeSpillFile();
+    if (path.isEmpty())
+        return;
+
+    Log4Qt::PatternLayout *layout = new Log4Qt::PatternLayout("%m%n");
+    layout->activateOptions();
+    spillLog = new AsyncFileAppender();
+    spillLog->setLayout(layout);
+    spillLog->setFile(path);
+    spillLog->setName(QLatin1String("GC Status Log Spill"));
+}
+
+// the spill file only lives as long as the session
+void StatusLogModel::closeSpillFile()
+{
+    if (spillLog == NULL)
+        return;
+
+    QString path = spillLog->file();
+    bool opened = spillLog->isActive();
+    spillLog->close();
+    delete spillLog;
+    spillLog = NULL;
+    if (opened)
+        QFile::remove(path);
+}
+
+qint64 StatusLogModel::spilledCount() const
+{
+    return spilled;
+}
+
+void StatusLogModel::spill(const QString& text)
+{
+    if (spillLog == NULL)
+        return;
+    if (!spillLog->isActive())
+    {
+        spillLog->activateOptions();
+        // not tried again for each line
+        if (!spillLog->isActive())
+        {
+            closeSpillFile();
+            return;
+        }
+    }
+    spillLog->appendText(text.toUtf8() + '\n');
+    spilled++;
+}
+
+///-----------------------------------------------------------------------------
+StatusLogView::StatusLogView(QWidget *parent)
+    : LineListView(parent),
+      flushTimerId(0)
+{
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (QDir().mkpath(dir))
+        model.setSpillFile(dir + QString(STATUS_LOG_SPILL_FILE).arg(QCoreApplication::applicationPid()));
+}
+
+int StatusLogView::rowCount() const
+{
+    return model.count();
+}
+
+QString StatusLogView::rowText(int row) const
+{
+    return model.line(row);
+}
+
+qint64 StatusLogView::rowKey(int row) const
+{
+    return model.total() - model.count() + row;
+}
+
+int StatusLogView::keyRow(qint64 key) const
+{
+    qint64 row = key - (model.total() - model.count());
+    return row < 0 ? -1 : (int)row;
+}
+
+void StatusLogView::setCapacity(int lines)
+{
+    flushPending();
+    model.setCapacity(lines > 0 ? lines : STATUS_LOG_DEFAULT_CAPACITY);
+    updateScrollBars();
+    viewport()->update();
+}
+
+void StatusLogView::appendLine(const QString& line)
+{
+    appendLines(QStringList(line));
+}
+
+// lines are only queued here, see 'timerEvent()'
+void StatusLogView::appendLines(const QStringList& lines)
+{
+    pending.append(lines);
+    if (!flushTimerId)
+        flushTimerId = startTimer(STATUS_LOG_FLUSH_MSEC);
+}
+
+void StatusLogView::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() != flushTimerId)
+    {
+        LineListView::timerEvent(event);
+        return;
+    }
+    killTimer(flushTimerId);
+    flushTimerId = 0;
+    flushPending();
+}
+
+void StatusLogView::flushPending()
+{
+    if (pending.isEmpty())
+        return;
+
+    QScrollBar *vbar = verticalScrollBar();
+    bool atBottom = vbar->value() >= vbar->maximum();
+    qint64 firstBefore = model.total() - model.count();
+
+    QFontMetrics fm(font());
+    int width = textWidth();
+    foreach (const QString& text, pending)
+        width = qMax(width, fm.width(text));
+    setTextWidth(width);
+
+    model.append(pending);
+    pending.clear();
+
+    updateScrollBars();
+    if (atBottom)
+        vbar->setValue(vbar->maximum());
+    else
+    {
+        // keep the rows being read in place while old ones leave
+        int shift = (int)(model.total() - model.count() - firstBefore);
+        vbar->setValue(vbar->value() - shift);
+    }
+    viewport()->update();
+}
+
+// calls : 'MainWindow::toClearSatusList()':1
+void StatusLogView::removeSelectedLines()
+{
+    int first, last;
+    selectionRows(first, last);
+    if (first < 0)
+        return;
+
+    model.removeRows(first, last);
+    clearSelection();
+    updateScrollBars();
+    viewport()->update();
+}
+
+void StatusLogView::clear()
+{
+    pending.clear();
+    model.clear();
+    setTextWidth(0);
+    clearSelection();
+    updateScrollBars();
+    viewport()->update();
+}
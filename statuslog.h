@@ -0,0 +1,102 @@
+/****************************************************************
+ * statuslog.h
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#ifndef STATUSLOG_H
+#define STATUSLOG_H
+
+#include <QVector>
+#include <QStringList>
+
+#include "linelistview.h"
+
+class AsyncFileAppender;
+
+// lines kept in memory when the option 'Max Log Lines' is 0
+#define STATUS_LOG_DEFAULT_CAPACITY     20000
+// appends are applied to the view once per frame
+#define STATUS_LOG_FLUSH_MSEC           16
+// lines pushed out of the ring go there, in the cache directory : one
+// file for each running instance, '%1' is the process id
+#define STATUS_LOG_SPILL_FILE           "/status-%1.log"
+
+// Fixed capacity ring of lines. When full, the oldest line is written
+// to the spill file and its slot reused, so memory and append cost do
+// not depend on how long the job has been running. The spill file is
+// written by the thread of an 'AsyncFileAppender', never by the GUI.
+class StatusLogModel
+{
+public:
+    explicit StatusLogModel(int capacity = STATUS_LOG_DEFAULT_CAPACITY);
+    ~StatusLogModel();
+
+    void setCapacity(int capacity);
+    int capacity() const;
+    int count() const;
+    // row 0 is the oldest line still in memory
+    const QString& line(int row) const;
+    // number of lines ever appended, first kept line has 'total() - count()'
+    qint64 total() const;
+
+    void append(const QStringList& lines);
+    void removeRows(int first, int last);
+    void clear();
+
+    void setSpillFile(const QString& path);
+    qint64 spilledCount() const;
+
+private:
+    Q_DISABLE_COPY(StatusLogModel)
+    void spill(const QString& line);
+    void closeSpillFile();
+
+private:
+    QVector<QString> ring;
+    int head;
+    int used;
+    qint64 appended;
+    // opened at the first line out of the ring, removed with the model
+    AsyncFileAppender *spillLog;
+    qint64 spilled;
+};
+
+// Log view of the ring, painting only the rows on screen.
+class StatusLogView : public LineListView
+{
+    Q_OBJECT
+
+public:
+    explicit StatusLogView(QWidget *parent = 0);
+
+    // 0 : STATUS_LOG_DEFAULT_CAPACITY
+    void setCapacity(int lines);
+    void appendLine(const QString& line);
+    void appendLines(const QStringList& lines);
+    void removeSelectedLines();
+
+public slots:
+    void clear();
+
+protected:
+    int rowCount() const;
+    QString rowText(int row) const;
+    // keys are append sequence numbers, selection survives lines leaving the ring
+    qint64 rowKey(int row) const;
+    int keyRow(qint64 key) const;
+    void timerEvent(QTimerEvent *event);
+
+private:
+    void flushPending();
+
+private:
+    StatusLogModel model;
+    QStringList pending;
+    int flushTimerId;
+};
+
+#endif // STATUSLOG_H
@@ -0,0 +1,316 @@
+/****************************************************************
+ * stocksimulator.cpp
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#include "stocksimulator.h"
+
+#include <cfloat>
+#include <QtConcurrent/QtConcurrentMap>
+#include <qmath.h>
+
+#include "visu3D/Arc3D.h"
+
+// uncut stock, then the deepest cut
+static const QColor stockTopColor(222, 184, 135);
+static const QColor stockBottomColor(40, 60, 160);
+
+QColor StockMap::color(float height) const
+{
+    double t = top > bottom ? (top - height) / (top - bottom) : 0;
+    t = qBound(0.0, t, 1.0);
+    return QColor(stockTopColor.red() + t * (stockBottomColor.red() - stockTopColor.red()),
+                  stockTopColor.green() + t * (stockBottomColor.green() - stockTopColor.green()),
+                  stockTopColor.blue() + t * (stockBottomColor.blue() - stockTopColor.blue()));
+}
+
+QImage StockMap::toImage() const
+{
+    QImage image(qMax(cols, 1), qMax(rows, 1), QImage::Format_RGB32);
+    image.fill(stockTopColor);
+    for (int row = 0; row < rows; row++)
+    {
+        QRgb *line = (QRgb *)image.scanLine(rows - 1 - row);
+        for (int col = 0; col < cols; col++)
+            line[col] = color(at(col, row)).rgb();
+    }
+    return image;
+}
+
+///-----------------------------------------------------------------------------
+class StockTileCutter
+{
+public:
+    typedef void result_type;
+
+    StockTileCutter(StockSimulator *simulator) : sim(simulator) {}
+    void operator()(StockTile& tile) const { sim->cutTile(tile); }
+
+private:
+    StockSimulator *sim;
+};
+
+///-----------------------------------------------------------------------------
+StockSimulator::StockSimulator()
+    : tool(Tools3D::_SHARP_SHORT), mm(true), radius(0), applied(0)
+{
+    setTool(tool, mm);
+}
+
+// calls : 'MainWindow::simulateStock()':1, 'MainWindow::prepareStockPreview()':1
+void StockSimulator::setTool(Tools3D::typeTool type, bool useMm)
+{
+    tool = type;
+    mm = useMm;
+    double unit = mm ? 1.0 : MM_IN_AN_INCH;
+    radius = Tools3D::cutRadius(tool) / unit;
+
+    profile.resize(STOCK_PROFILE_STEPS + 1);
+    for (int n = 0; n < STOCK_PROFILE_STEPS; n++)
+    {
+        double r = radius * qSqrt(n / double(STOCK_PROFILE_STEPS - 1));
+        profile[n] = Tools3D::cutProfile(tool, r * unit) / unit;
+    }
+    profile[STOCK_PROFILE_STEPS] = FLT_MAX;
+}
+
+// Arcs are split within half a cell, moves that stay above the stock
+// are left out.
+void StockSimulator::setPath(const QList<PosItem>& items, int cells)
+{
+    segments.clear();
+    stock = StockMap();
+    applied = 0;
+    if (items.size() < 2)
+        return;
+
+    // top : Z0 when the program cuts below it, else its highest cut
+    double minX = items.first().x, maxX = minX, minY = items.first().y, maxY = minY;
+    double feedMin = 0, feedMax = 0;
+    bool feedFound = false;
+    foreach (const PosItem& item, items)
+    {
+        minX = qMin(minX, item.x); maxX = qMax(maxX, item.x);
+        minY = qMin(minY, item.y); maxY = qMax(maxY, item.y);
+        if (item.g >= 1 && item.g <= 3)
+        {
+            feedMin = feedFound ? qMin(feedMin, item.z) : item.z;
+            feedMax = feedFound ? qMax(feedMax, item.z) : item.z;
+            feedFound = true;
+        }
+    }
+    if (!feedFound)
+        return;
+    float top = feedMin < 0 ? 0 : feedMax;
+    double tol = qMax(maxX - minX, maxY - minY) / qMax(cells, 1) / 2;
+    if (tol <= 0)
+        tol = radius / 4;
+
+    segments.reserve(items.size());
+    QList<QVector3D> points;
+    for (int n = 1; n < items.size(); n++)
+    {
+        const PosItem& from = items.at(n - 1);
+        const PosItem& item = items.at(n);
+        QVector3D pstart(from.x, from.y, from.z), pend(item.x, item.y, item.z);
+
+        points.clear();
+        if (item.g == 2 || item.g == 3)
+        {
+            Arc3D arc(item.plane, item.cw, pstart, pend, QVector3D(item.i, item.j, item.k), 2, item.helix);
+            arc.interpolateAng(tol, points);
+        }
+        if (points.size() < 2)
+        {
+            points.clear();
+            points << pstart << pend;
+        }
+
+        for (int p = 1; p < points.size(); p++)
+        {
+            const QVector3D& a = points.at(p - 1);
+            const QVector3D& b = points.at(p);
+            if (qMin(a.z(), b.z()) >= top)
+                continue;
+
+            StockSegment s;
+            s.x0 = a.x(); s.y0 = a.y(); s.z0 = a.z();
+            s.x1 = b.x(); s.y1 = b.y(); s.z1 = b.z();
+            s.line = item.index;
+            segments.append(s);
+
+            minX = qMin(minX, (double)qMin(s.x0, s.x1)); maxX = qMax(maxX, (double)qMax(s.x0, s.x1));
+            minY = qMin(minY, (double)qMin(s.y0, s.y1)); maxY = qMax(maxY, (double)qMax(s.y0, s.y1));
+        }
+    }
+
+    double width = maxX - minX + 2 * radius;
+    double height = maxY - minY + 2 * radius;
+    stock.cell = qMax(width, height) / qMax(cells, 1);
+    if (stock.cell <= 0)
+        stock.cell = 1;
+    stock.cols = qMax(1, qCeil(width / stock.cell));
+    stock.rows = qMax(1, qCeil(height / stock.cell));
+    stock.origin = QPointF(minX - radius, minY - radius);
+    stock.top = top;
+    reset();
+}
+
+bool StockSimulator::hasPath() const
+{
+    return !stock.isEmpty();
+}
+
+void StockSimulator::reset()
+{
+    stock.z.fill(stock.top, stock.cols * stock.rows);
+    stock.bottom = stock.top;
+    applied = 0;
+}
+
+// calls : 'MainWindow::simulateStock()':1
+void StockSimulator::run()
+{
+    reset();
+    if (stock.isEmpty())
+        return;
+
+    int tileCols = (stock.cols + STOCK_TILE_CELLS - 1) / STOCK_TILE_CELLS;
+    int tileRows = (stock.rows + STOCK_TILE_CELLS - 1) / STOCK_TILE_CELLS;
+    QVector<StockTile> tiles(tileCols * tileRows);
+    for (int ty = 0; ty < tileRows; ty++)
+    {
+        for (int tx = 0; tx < tileCols; tx++)
+        {
+            StockTile& tile = tiles[ty * tileCols + tx];
+            tile.col0 = tx * STOCK_TILE_CELLS;
+            tile.row0 = ty * STOCK_TILE_CELLS;
+            tile.col1 = qMin(stock.cols, tile.col0 + STOCK_TILE_CELLS) - 1;
+            tile.row1 = qMin(stock.rows, tile.row0 + STOCK_TILE_CELLS) - 1;
+        }
+    }
+
+    // each move goes to the tiles under its footprint
+    for (int n = 0; n < segments.size(); n++)
+    {
+        const StockSegment& s = segments.at(n);
+        stock.bottom = qMin(stock.bottom, qMin(s.z0, s.z1));
+        int col0, row0, col1, row1;
+        if (!cellRange(s, col0, row0, col1, row1))
+            continue;
+        for (int ty = row0 / STOCK_TILE_CELLS; ty <= row1 / STOCK_TILE_CELLS; ty++)
+            for (int tx = col0 / STOCK_TILE_CELLS; tx <= col1 / STOCK_TILE_CELLS; tx++)
+                tiles[ty * tileCols + tx].segments.append(n);
+    }
+
+    // tiles don't share cells, no locking
+    QtConcurrent::blockingMap(tiles, StockTileCutter(this));
+    applied = segments.size();
+}
+
+// calls : 'MainWindow::simulateStock()':1
+void StockSimulator::simulate(const QList<PosItem>& items, int cells)
+{
+    setPath(items, cells);
+    run();
+}
+
+// calls : 'MainWindow::advanceStock()':1
+bool StockSimulator::advanceTo(int line)
+{
+    bool any = false;
+    while (applied < segments.size() && segments.at(applied).line <= line)
+    {
+        const StockSegment& s = segments.at(applied++);
+        stock.bottom = qMin(stock.bottom, qMin(s.z0, s.z1));
+        int col0, row0, col1, row1;
+        if (cellRange(s, col0, row0, col1, row1))
+            cut(s, col0, row0, col1, row1);
+        any = true;
+    }
+    return any;
+}
+
+const StockMap& StockSimulator::map() const
+{
+    return stock;
+}
+
+int StockSimulator::segmentCount() const
+{
+    return segments.size();
+}
+
+int StockSimulator::cutCells() const
+{
+    int count = 0;
+    foreach (float z, stock.z)
+        count += z < stock.top;
+    return count;
+}
+
+void StockSimulator::cutTile(StockTile& tile)
+{
+    foreach (int n, tile.segments)
+    {
+        const StockSegment& s = segments.at(n);
+        int col0, row0, col1, row1;
+        if (!cellRange(s, col0, row0, col1, row1))
+            continue;
+        col0 = qMax(col0, tile.col0); col1 = qMin(col1, tile.col1);
+        row0 = qMax(row0, tile.row0); row1 = qMin(row1, tile.row1);
+        if (col0 <= col1 && row0 <= row1)
+            cut(s, col0, row0, col1, row1);
+    }
+    tile.segments.clear();
+}
+
+// cells whose center lies within the cutter radius of the move's box
+bool StockSimulator::cellRange(const StockSegment& s, int& col0, int& row0, int& col1, int& row1) const
+{
+    double ox = stock.origin.x(), oy = stock.origin.y();
+    col0 = qMax(0, qCeil((qMin(s.x0, s.x1) - radius - ox) / stock.cell - 0.5));
+    col1 = qMin(stock.cols - 1, qFloor((qMax(s.x0, s.x1) + radius - ox) / stock.cell - 0.5));
+    row0 = qMax(0, qCeil((qMin(s.y0, s.y1) - radius - oy) / stock.cell - 0.5));
+    row1 = qMin(stock.rows - 1, qFloor((qMax(s.y0, s.y1) + radius - oy) / stock.cell - 0.5));
+    return col0 <= col1 && row0 <= row1;
+}
+
+// Inner loop without branches over a row of cells : closest point of
+// the move, height of the cutting edge from the profile table, minimum.
+void StockSimulator::cut(const StockSegment& s, int col0, int row0, int col1, int row1)
+{
+    const float dx = s.x1 - s.x0, dy = s.y1 - s.y0;
+    const float len2 = dx * dx + dy * dy;
+    const float inv = len2 > 0 ? 1 / len2 : 0;
+    // a plunge reaches its lowest end
+    const float za = len2 > 0 ? s.z0 : qMin(s.z0, s.z1);
+    const float dz = len2 > 0 ? s.z1 - s.z0 : 0;
+    const float scale = (STOCK_PROFILE_STEPS - 1) / (radius * radius);
+    const float cell = stock.cell;
+    const float x0 = stock.origin.x() + (col0 + 0.5) * cell;
+    const float *table = profile.constData();
+    float *z = stock.z.data();
+
+    for (int row = row0; row <= row1; row++)
+    {
+        const float cy = stock.origin.y() + (row + 0.5) * cell;
+        const float ry = cy - s.y0;
+        float *line = z + row * stock.cols;
+        for (int col = col0; col <= col1; col++)
+        {
+            const float rx = x0 + (col - col0) * cell - s.x0;
+            float t = (rx * dx + ry * dy) * inv;
+            t = t < 0 ? 0 : (t > 1 ? 1 : t);
+            const float px = t * dx - rx, py = t * dy - ry;
+            const float k = (px * px + py * py) * scale;
+            const int step = k < STOCK_PROFILE_STEPS ? (int)k : STOCK_PROFILE_STEPS;
+            const float h = za + t * dz + table[step];
+            line[col] = h < line[col] ? h : line[col];
+        }
+    }
+}
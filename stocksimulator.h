@@ -0,0 +1,122 @@
+/****************************************************************
+ * stocksimulator.h
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#ifndef STOCKSIMULATOR_H
+#define STOCKSIMULATOR_H
+
+#include <QColor>
+#include <QImage>
+#include <QList>
+#include <QPointF>
+#include <QVector>
+
+#include "positem.h"
+#include "visu3D/Tools3D.h"
+
+// cells on the longest side of the stock
+#define STOCK_PREVIEW_CELLS     256
+#define STOCK_FULL_CELLS        2000
+// cells on the side of the square tiles cut by one thread
+#define STOCK_TILE_CELLS        128
+// samples of the cutter profile between its axis and its radius
+#define STOCK_PROFILE_STEPS     256
+// refresh of the preview while sending
+#define STOCK_PREVIEW_MSEC      500
+// suffix of the saved heightmap : 'part.nc' -> 'part-stock.png'
+#define STOCK_IMAGE_SUFFIX      "-stock.png"
+
+// Heightmap of the stock : top of the material on each cell, in the
+// unit of the program, row 0 at the lowest Y.
+class StockMap
+{
+public:
+    StockMap() : cols(0), rows(0), cell(1), top(0), bottom(0) {}
+
+    bool isEmpty() const { return z.isEmpty(); }
+    float at(int col, int row) const { return z.at(row * cols + col); }
+    // from the stock top to the deepest cut
+    QColor color(float height) const;
+    // top view, Y up
+    QImage toImage() const;
+
+public:
+    int cols;
+    int rows;
+    QPointF origin;
+    double cell;
+    float top;
+    float bottom;
+    QVector<float> z;
+};
+
+class StockSegment
+{
+public:
+    float x0, y0, z0;
+    float x1, y1, z1;
+    int line;
+};
+
+class StockTile
+{
+public:
+    int col0, row0, col1, row1;
+    QVector<int> segments;
+};
+
+// Z-buffer stock simulation : the cutter is swept along every move of
+// the program and each cell keeps the lowest point reached by its
+// cutting edge. Since cells only keep a minimum, moves can be applied
+// in any order : the full simulation cuts tiles on the thread pool,
+// the preview applies moves as the lines are sent.
+// The cutter position along a move is taken at the point closest to the
+// cell in XY, exact for level moves and plunges.
+class StockSimulator
+{
+public:
+    StockSimulator();
+
+    void setTool(Tools3D::typeTool type, bool mm);
+    // moves of 'items' and a grid of 'cells' on the longest side
+    void setPath(const QList<PosItem>& items, int cells);
+    bool hasPath() const;
+    // uncut stock
+    void reset();
+
+    // whole path, any thread
+    void run();
+    // 'setPath()' then 'run()'
+    void simulate(const QList<PosItem>& items, int cells);
+    // moves of the lines up to 'line' not applied yet, false if none
+    bool advanceTo(int line);
+
+    const StockMap& map() const;
+    int segmentCount() const;
+    // cells lowered by the cutter
+    int cutCells() const;
+
+private:
+    friend class StockTileCutter;
+    void cutTile(StockTile& tile);
+    void cut(const StockSegment& s, int col0, int row0, int col1, int row1);
+    bool cellRange(const StockSegment& s, int& col0, int& row0, int& col1, int& row1) const;
+
+private:
+    Tools3D::typeTool tool;
+    bool mm;
+    float radius;
+    // height above the tip by steps of (r / radius)^2, the last one
+    // beyond the radius
+    QVector<float> profile;
+    QVector<StockSegment> segments;
+    StockMap stock;
+    int applied;
+};
+
+#endif // STOCKSIMULATOR_H
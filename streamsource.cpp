@@ -0,0 +1,325 @@
+/****************************************************************
+ * streamsource.cpp
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#include "streamsource.h"
+
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QObject>
+#include <QRegExp>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool StreamSource::isStream(const QString& path)
+{
+    if (path == STREAM_STDIN)
+        return true;
+#ifdef Q_OS_UNIX
+    struct stat st;
+    return ::stat(QFile::encodeName(path).constData(), &st) == 0 && S_ISFIFO(st.st_mode);
+#else
+    return path.startsWith("\\\\.\\pipe\\");
+#endif
+}
+
+StreamSource::StreamSource(const QString& p, bool f)
+    : path(p), follow(f), worker(NULL), taken(0),
+      opened(false), finished(false), stopping(false)
+#ifdef Q_OS_UNIX
+      , fd(-1)
+#endif
+{
+}
+
+StreamSource::~StreamSource()
+{
+    close();
+}
+
+// calls : 'GCode::sendFileFrom()':1
+bool StreamSource::open()
+{
+    if (worker != NULL)
+        return false;
+    // a followed file may be created by the producer after the start
+    if (path != STREAM_STDIN && !follow && !QFile::exists(path))
+    {
+        failure = QObject::tr("'%1' : no such file").arg(path);
+        return false;
+    }
+
+    lines.clear();
+    taken = 0;
+    opened = false;
+    finished = false;
+    stopping = false;
+    failure.clear();
+
+    worker = new Worker(this);
+    worker->start();
+    return true;
+}
+
+void StreamSource::close()
+{
+    if (worker == NULL)
+        return;
+
+    {
+        QMutexLocker lock(&mutex);
+        stopping = true;
+        changed.wakeAll();
+    }
+#ifdef Q_OS_UNIX
+    // the open of a pipe waits for its producer : a writer opened and
+    // closed at once ends that wait
+    while (!worker->wait(STREAM_POLL_MSEC))
+    {
+        mutex.lock();
+        bool waiting = !opened && path != STREAM_STDIN;
+        mutex.unlock();
+        if (waiting)
+        {
+            int writer = ::open(QFile::encodeName(path).constData(), O_WRONLY | O_NONBLOCK);
+            if (writer >= 0)
+                ::close(writer);
+        }
+    }
+#else
+    // elsewhere a silent producer delays the stop up to its next line
+    worker->wait();
+#endif
+    delete worker;
+    worker = NULL;
+    lines.clear();
+}
+
+StreamSource::Wait StreamSource::nextLine(QString& line, int msec)
+{
+    QMutexLocker lock(&mutex);
+    if (lines.isEmpty() && !finished)
+        changed.wait(&mutex, msec);
+    if (lines.isEmpty())
+        return finished ? End : Timeout;
+
+    QByteArray bytes = lines.dequeue();
+    taken += bytes.size() + 1;
+    // room for the worker
+    changed.wakeAll();
+
+    if (bytes.endsWith('\r'))
+        bytes.chop(1);
+    line = QString::fromLocal8Bit(bytes);
+    return Line;
+}
+
+bool StreamSource::waitForLines(int count, int msec)
+{
+    // the worker never queues more
+    count = qMin(count, STREAM_QUEUE_LINES);
+
+    QMutexLocker lock(&mutex);
+    if (lines.size() < count && !finished)
+        changed.wait(&mutex, msec);
+    return lines.size() >= count || finished;
+}
+
+qint64 StreamSource::bytesTaken() const
+{
+    QMutexLocker lock(&mutex);
+    return taken;
+}
+
+bool StreamSource::failed() const
+{
+    QMutexLocker lock(&mutex);
+    return !failure.isEmpty();
+}
+
+QString StreamSource::errorString() const
+{
+    QMutexLocker lock(&mutex);
+    return failure;
+}
+
+// worker thread
+void StreamSource::produce()
+{
+    QString error;
+    bool ok = openProducer(error);
+    bool ended = false;
+
+    // the last line of the producer may still be incomplete
+    QByteArray pending;
+    QByteArray buffer(STREAM_READ_CHUNK, 0);
+    QElapsedTimer idle;
+    idle.start();
+    while (ok && !ended && !isStopping())
+    {
+        qint64 n = readProducer(buffer.data(), buffer.size(), STREAM_POLL_MSEC);
+        if (n == -2)
+        {
+            error = QObject::tr("'%1' : %2").arg(path).arg(strerror(errno));
+            ok = false;
+            break;
+        }
+        if (n == -1)
+        {
+            if (!follow || idle.elapsed() > STREAM_IDLE_SEC * 1000)
+                break;
+            // the producer did not write the next lines yet
+            QThread::msleep(STREAM_POLL_MSEC);
+            continue;
+        }
+        if (n == 0)
+            continue;
+
+        idle.restart();
+        pending.append(buffer.constData(), (int)n);
+        int start = 0;
+        int eol;
+        while (ok && !ended && (eol = pending.indexOf('\n', start)) != -1)
+        {
+            QByteArray line = pending.mid(start, eol - start);
+            start = eol + 1;
+            ok = push(line);
+            // nothing is sent after the end of a followed program
+            ended = follow && isProgramEnd(line);
+        }
+        pending.remove(0, start);
+    }
+    if (ok && !ended && !pending.isEmpty())
+        ok = push(pending);
+    closeProducer();
+
+    QMutexLocker lock(&mutex);
+    if (!ok && failure.isEmpty() && !stopping)
+        failure = error;
+    finished = true;
+    changed.wakeAll();
+}
+
+bool StreamSource::openProducer(QString& error)
+{
+#ifdef Q_OS_UNIX
+    if (path == STREAM_STDIN)
+        fd = STDIN_FILENO;
+    else
+    {
+        QElapsedTimer wait;
+        wait.start();
+        while (follow && !QFile::exists(path))
+        {
+            if (isStopping())
+                return false;
+            if (wait.elapsed() > STREAM_IDLE_SEC * 1000)
+            {
+                error = QObject::tr("'%1' : no such file").arg(path);
+                return false;
+            }
+            QThread::msleep(STREAM_POLL_MSEC);
+        }
+        // a pipe is opened once its producer opened it, see 'close()'
+        fd = ::open(QFile::encodeName(path).constData(), O_RDONLY);
+        if (fd < 0)
+        {
+            error = QObject::tr("'%1' : %2").arg(path).arg(strerror(errno));
+            return false;
+        }
+    }
+#else
+    bool ok;
+    if (path == STREAM_STDIN)
+        ok = file.open(stdin, QIODevice::ReadOnly | QIODevice::Unbuffered);
+    else
+    {
+        file.setFileName(path);
+        ok = file.open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    }
+    if (!ok)
+    {
+        error = QObject::tr("'%1' : %2").arg(path).arg(file.errorString());
+        return false;
+    }
+#endif
+    QMutexLocker lock(&mutex);
+    opened = true;
+    return true;
+}
+
+qint64 StreamSource::readProducer(char *buffer, qint64 size, int msec)
+{
+#ifdef Q_OS_UNIX
+    struct pollfd p;
+    p.fd = fd;
+    p.events = POLLIN;
+    p.revents = 0;
+    int ready = ::poll(&p, 1, msec);
+    if (ready == 0 || (ready < 0 && errno == EINTR))
+        return 0;
+    if (ready < 0)
+        return -2;
+
+    ssize_t n = ::read(fd, buffer, size);
+    if (n > 0)
+        return n;
+    if (n == 0)
+        return -1;
+    return errno == EINTR || errno == EAGAIN ? 0 : -2;
+#else
+    // one line at a time, blocking on a pipe
+    Q_UNUSED(msec);
+    qint64 n = file.readLine(buffer, size);
+    return n > 0 ? n : -1;
+#endif
+}
+
+void StreamSource::closeProducer()
+{
+#ifdef Q_OS_UNIX
+    if (fd >= 0 && fd != STDIN_FILENO)
+        ::close(fd);
+    fd = -1;
+#else
+    file.close();
+#endif
+}
+
+bool StreamSource::push(const QByteArray& line)
+{
+    QMutexLocker lock(&mutex);
+    while (lines.size() >= STREAM_QUEUE_LINES && !stopping)
+        changed.wait(&mutex);
+    if (stopping)
+        return false;
+    lines.enqueue(line);
+    changed.wakeAll();
+    return true;
+}
+
+bool StreamSource::isStopping() const
+{
+    QMutexLocker lock(&mutex);
+    return stopping;
+}
+
+// M2 or M30, with an optional line number
+bool StreamSource::isProgramEnd(const QByteArray& line)
+{
+    QRegExp end("^\\s*(N\\d+\\s*)?M0*(2|30)(\\D|$)", Qt::CaseInsensitive);
+    return end.indexIn(QString::fromLatin1(line)) == 0;
+}
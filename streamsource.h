@@ -0,0 +1,106 @@
+/****************************************************************
+ * streamsource.h
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#ifndef STREAMSOURCE_H
+#define STREAMSOURCE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QMutex>
+#include <QQueue>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+
+// path of the standard input
+#define STREAM_STDIN                "-"
+// lines the worker keeps ahead of the sender
+#define STREAM_QUEUE_LINES          20000
+// bytes read from the producer at once
+#define STREAM_READ_CHUNK           (64 * 1024)
+// a silent producer, or a followed file at its end, is checked again
+// after this delay
+#define STREAM_POLL_MSEC            200
+// a followed file that did not grow for so long is complete
+#define STREAM_IDLE_SEC             60
+
+// Lines of a program written while it is sent : the standard input, a
+// named pipe, or with 'follow' a file still written by a post-processor,
+// read up to its program end (M2, M30) or until it stops growing for
+// 'STREAM_IDLE_SEC'.
+// A worker thread reads the producer ahead of the sender, at most
+// 'STREAM_QUEUE_LINES' lines : a slow machine stops the reads and a pipe
+// then blocks its producer, a slow producer makes the sender wait.
+class StreamSource
+{
+public:
+    enum Wait { Line, Timeout, End };
+
+    // the standard input or a named pipe, read only once
+    static bool isStream(const QString& path);
+
+    StreamSource(const QString& path, bool follow);
+    ~StreamSource();
+
+    bool open();
+    void close();
+    // the next line, waiting at most 'msec' for the producer
+    Wait nextLine(QString& line, int msec);
+    // true once 'count' lines are queued or the stream ended
+    bool waitForLines(int count, int msec);
+    // bytes of the lines returned by 'nextLine()'
+    qint64 bytesTaken() const;
+    // the producer could not be read up to its end
+    bool failed() const;
+    QString errorString() const;
+
+private:
+    class Worker : public QThread
+    {
+    public:
+        Worker(StreamSource *source) : owner(source) {}
+    protected:
+        void run() { owner->produce(); }
+    private:
+        StreamSource *owner;
+    };
+
+    // worker side
+    void produce();
+    bool openProducer(QString& error);
+    // bytes read, 0 when nothing came for 'msec', -1 at the end of the
+    // producer, -2 on error
+    qint64 readProducer(char *buffer, qint64 size, int msec);
+    void closeProducer();
+    // false when the sender closed the stream
+    bool push(const QByteArray& line);
+    bool isStopping() const;
+    static bool isProgramEnd(const QByteArray& line);
+
+private:
+    QString path;
+    bool follow;
+    Worker *worker;
+    mutable QMutex mutex;
+    QWaitCondition changed;
+    QQueue<QByteArray> lines;
+    qint64 taken;
+    bool opened;
+    bool finished;
+    bool stopping;
+    QString failure;
+    // producer, read by the worker only
+#ifdef Q_OS_UNIX
+    int fd;
+#else
+    QFile file;
+#endif
+};
+
+#endif // STREAMSOURCE_H
@@ -0,0 +1,134 @@
+/****************************************************************
+ * telemetry.cpp
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#include "telemetry.h"
+
+#include <atomic>
+
+TelemetrySnapshot::TelemetrySnapshot()
+    : sequence(0), running(false), visual(false),
+      currLine(0), totalLines(0), progress(0), bytesSent(0),
+      queuedCommands(0), queueRunning(false),
+      positionCount(0), useMm(true), positionValid(false)
+{
+}
+
+Telemetry::Telemetry()
+    : seq(0)
+{
+}
+
+void Telemetry::beginWrite()
+{
+    seq.store(seq.load() + 1);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void Telemetry::endWrite()
+{
+    data.sequence = seq.load() + 1;
+    seq.storeRelease(data.sequence);
+}
+
+// calls : 'GCode::sendFile()':1
+void Telemetry::publishStart(int totalLines, bool visual)
+{
+    beginWrite();
+    data.running = true;
+    data.visual = visual;
+    data.currLine = 0;
+    data.totalLines = totalLines;
+    data.progress = 0;
+    data.bytesSent = 0;
+    endWrite();
+}
+
+// calls : 'GCode::sendFile()':1
+void Telemetry::publishStop()
+{
+    beginWrite();
+    data.running = false;
+    endWrite();
+}
+
+// calls : 'GCode::sendGcodeInternal()':1
+void Telemetry::publishLine(int currLine)
+{
+    if (data.currLine == currLine)
+        return;
+
+    beginWrite();
+    data.currLine = currLine;
+    endWrite();
+}
+
+void Telemetry::publishProgress(int percent)
+{
+    if (data.progress == percent)
+        return;
+
+    beginWrite();
+    data.progress = percent;
+    endWrite();
+}
+
+// calls : 'GCode::sendFileFrom()':1
+void Telemetry::publishBytes(qint64 bytes)
+{
+    if (data.bytesSent == bytes)
+        return;
+
+    beginWrite();
+    data.bytesSent = bytes;
+    endWrite();
+}
+
+void Telemetry::publishQueue(int count, bool running)
+{
+    if (data.queuedCommands == count && data.queueRunning == running)
+        return;
+
+    beginWrite();
+    data.queuedCommands = count;
+    data.queueRunning = running;
+    endWrite();
+}
+
+// calls : 'GCode::parseCoordinates()':1
+void Telemetry::publishPosition(const Coord3D& machine, const Coord3D& work, bool useMm, bool valid)
+{
+    beginWrite();
+    data.positionCount++;
+    data.machineCoord = machine;
+    data.workCoord = work;
+    data.useMm = useMm;
+    data.positionValid = valid;
+    endWrite();
+}
+
+int Telemetry::sequence() const
+{
+    return seq.loadAcquire();
+}
+
+void Telemetry::read(TelemetrySnapshot& snap) const
+{
+    for (;;)
+    {
+        int before = seq.loadAcquire();
+        if (before & 1)
+            continue;   // writer busy, it only copies a few fields
+
+        snap = data;
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (seq.load() == before)
+            return;
+    }
+}
@@ -0,0 +1,82 @@
+/****************************************************************
+ * telemetry.h
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <QAtomicInt>
+
+#include "coord3d.h"
+
+// how often the GUI samples the snapshot (about one display frame)
+#define TELEMETRY_REFRESH_MSEC      16
+
+// log lines coming from the sender are delivered in chunks
+#define LIST_CHUNK_FLUSH_MSEC       50
+#define LIST_CHUNK_MAX_LINES        256
+
+// Plain copy of the sender state, as seen by the GUI
+class TelemetrySnapshot
+{
+public:
+    TelemetrySnapshot();
+
+public:
+    int sequence;
+    // file streaming
+    bool running;
+    bool visual;
+    int currLine;
+    int totalLines;
+    int progress;
+    // of a stream, whose number of lines is unknown ('totalLines' 0)
+    qint64 bytesSent;
+    // planner queue
+    int queuedCommands;
+    bool queueRunning;
+    // position
+    int positionCount;
+    Coord3D machineCoord;
+    Coord3D workCoord;
+    bool useMm;
+    bool positionValid;
+};
+
+// Latest state published by the GCode thread without locking.
+// One writer (the GCode thread), any number of readers: a sequence
+// counter is odd while a write is in progress and readers retry
+// until they get a copy taken between two identical even values.
+class Telemetry
+{
+public:
+    Telemetry();
+
+    // writer side, GCode thread only
+    void publishStart(int totalLines, bool visual);
+    void publishStop();
+    void publishLine(int currLine);
+    void publishProgress(int percent);
+    void publishBytes(qint64 bytes);
+    void publishQueue(int count, bool running);
+    void publishPosition(const Coord3D& machine, const Coord3D& work, bool useMm, bool valid);
+
+    // reader side, any thread
+    int sequence() const;
+    void read(TelemetrySnapshot& snap) const;
+
+private:
+    void beginWrite();
+    void endWrite();
+
+private:
+    QAtomicInt seq;
+    TelemetrySnapshot data;
+};
+
+#endif // TELEMETRY_H
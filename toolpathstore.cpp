@@ -0,0 +1,340 @@
+/****************************************************************
+ * toolpathstore.cpp
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#include "toolpathstore.h"
+
+#include <cfloat>
+#include <qmath.h>
+#include <QDir>
+
+#include "definitions.h"
+
+ToolpathStore::ToolpathStore()
+    : useMm(true), failed(false), total(0), buffered(0)
+{
+    for (int k = 0; k < 3; k++)
+    {
+        lo[k] = FLT_MAX;
+        hi[k] = -FLT_MAX;
+    }
+    resident.setMaxCost(TOOLPATH_DEFAULT_BUDGET_MB * 1024);
+}
+
+// the temporary file is removed with the store
+ToolpathStore::~ToolpathStore()
+{
+}
+
+bool ToolpathStore::create(bool mm)
+{
+    useMm = mm;
+    file.setFileTemplate(QDir::tempPath() + "/GrblController-XXXXXX.paths");
+    failed = !file.open();
+    return !failed;
+}
+
+// calls : 'ProgramAnalyzer::analyze()'
+void ToolpathStore::append(const QVector3D& a, const QVector3D& b, int line, int g)
+{
+    if (failed)
+        return;
+
+    ToolpathSegment s;
+    s.a[0] = a.x(); s.a[1] = a.y(); s.a[2] = a.z();
+    s.b[0] = b.x(); s.b[1] = b.y(); s.b[2] = b.z();
+    s.line = line;
+    s.g = g;
+
+    // the tile of the middle, inches are converted for the tile size
+    double tile = useMm ? TOOLPATH_TILE_MM : TOOLPATH_TILE_MM / MM_IN_AN_INCH;
+    qint64 tx = (qint64)qFloor((s.a[0] + s.b[0]) / 2 / tile);
+    qint64 ty = (qint64)qFloor((s.a[1] + s.b[1]) / 2 / tile);
+    // grown on demand : most tiles of a large table hold a few segments,
+    // a full page reserved for each would not be bounded by 'buffered'
+    qint64 key = (qint64)(((quint64)tx << 32) | (quint32)ty);
+    QVector<ToolpathSegment>& buffer = filling[key];
+    buffer.append(s);
+    buffered += sizeof(ToolpathSegment);
+    total++;
+
+    for (int k = 0; k < 3; k++)
+    {
+        lo[k] = qMin(lo[k], qMin(s.a[k], s.b[k]));
+        hi[k] = qMax(hi[k], qMax(s.a[k], s.b[k]));
+    }
+    if (total % TOOLPATH_CHECKPOINT == 0)
+    {
+        Checkpoint c;
+        c.line = line;
+        c.pos[0] = s.b[0]; c.pos[1] = s.b[1]; c.pos[2] = s.b[2];
+        checkpoints.append(c);
+    }
+
+    if (buffer.size() >= TOOLPATH_PAGE_SEGMENTS)
+    {
+        // 'clear()' keeps the capacity, the tile is released
+        writePage(buffer);
+        filling.remove(key);
+    }
+    else if (buffered >= TOOLPATH_WRITE_BUFFER)
+        writeAll();
+}
+
+void ToolpathStore::writePage(QVector<ToolpathSegment>& buffer)
+{
+    if (buffer.isEmpty())
+        return;
+
+    ToolpathPage page;
+    page.offset = file.pos();
+    page.count = buffer.size();
+    page.firstLine = buffer.first().line;
+    page.lastLine = buffer.last().line;
+    for (int k = 0; k < 3; k++)
+    {
+        page.lo[k] = FLT_MAX;
+        page.hi[k] = -FLT_MAX;
+    }
+    foreach (const ToolpathSegment& s, buffer)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            page.lo[k] = qMin(page.lo[k], qMin(s.a[k], s.b[k]));
+            page.hi[k] = qMax(page.hi[k], qMax(s.a[k], s.b[k]));
+        }
+    }
+
+    qint64 bytes = page.count * (qint64)sizeof(ToolpathSegment);
+    if (file.write((const char *)buffer.constData(), bytes) != bytes)
+        failed = true;
+    pages.append(page);
+
+    buffered -= bytes;
+    buffer.clear();
+}
+
+void ToolpathStore::writeAll()
+{
+    QMutableHashIterator<qint64, QVector<ToolpathSegment> > it(filling);
+    while (it.hasNext())
+    {
+        it.next();
+        writePage(it.value());
+        it.remove();
+    }
+}
+
+bool ToolpathStore::finish()
+{
+    writeAll();
+    filling.squeeze();
+    pages.squeeze();
+    checkpoints.squeeze();
+    if (!failed && !file.flush())
+        failed = true;
+    return !failed;
+}
+
+// calls : 'ProgramAnalyzer::analyze()':1
+void ToolpathStore::moveToThread(QThread *thread)
+{
+    file.moveToThread(thread);
+}
+
+bool ToolpathStore::isEmpty() const
+{
+    return pages.isEmpty();
+}
+
+bool ToolpathStore::mm() const
+{
+    return useMm;
+}
+
+qint64 ToolpathStore::segmentCount() const
+{
+    return total;
+}
+
+qint64 ToolpathStore::fileSize() const
+{
+    return total * (qint64)sizeof(ToolpathSegment);
+}
+
+QVector3D ToolpathStore::boundsMin() const
+{
+    return isEmpty() ? QVector3D() : QVector3D(lo[0], lo[1], lo[2]);
+}
+
+QVector3D ToolpathStore::boundsMax() const
+{
+    return isEmpty() ? QVector3D() : QVector3D(hi[0], hi[1], hi[2]);
+}
+
+int ToolpathStore::pageCount() const
+{
+    return pages.size();
+}
+
+const ToolpathPage& ToolpathStore::page(int n) const
+{
+    return pages.at(n);
+}
+
+QVector<int> ToolpathStore::pagesInBox(const QVector3D& blo, const QVector3D& bhi) const
+{
+    float l[3] = { blo.x(), blo.y(), blo.z() };
+    float h[3] = { bhi.x(), bhi.y(), bhi.z() };
+
+    QVector<int> found;
+    for (int n = 0; n < pages.size(); n++)
+    {
+        const ToolpathPage& p = pages.at(n);
+        bool overlap = true;
+        for (int k = 0; k < 3 && overlap; k++)
+            overlap = p.lo[k] <= h[k] && p.hi[k] >= l[k];
+        if (overlap)
+            found.append(n);
+    }
+    return found;
+}
+
+QVector<int> ToolpathStore::pagesInFrustum(const double coef[6][4]) const
+{
+    QVector<int> found;
+    for (int n = 0; n < pages.size(); n++)
+    {
+        const ToolpathPage& page = pages.at(n);
+        // out when the corner nearest to the inside is out of one plane
+        bool out = false;
+        for (int p = 0; p < 6 && !out; p++)
+        {
+            double dist = -coef[p][3];
+            for (int k = 0; k < 3; k++)
+                dist += coef[p][k] * (coef[p][k] > 0 ? page.lo[k] : page.hi[k]);
+            out = dist > 0;
+        }
+        if (!out)
+            found.append(n);
+    }
+    return found;
+}
+
+QVector<int> ToolpathStore::pagesForLines(int first, int last) const
+{
+    QVector<int> found;
+    for (int n = 0; n < pages.size(); n++)
+    {
+        if (pages.at(n).firstLine <= last && pages.at(n).lastLine >= first)
+            found.append(n);
+    }
+    return found;
+}
+
+const QVector<ToolpathSegment> *ToolpathStore::segments(int n)
+{
+    if (n < 0 || n >= pages.size())
+        return NULL;
+
+    QVector<ToolpathSegment> *cached = resident.object(n);
+    if (cached != NULL)
+        return cached;
+
+    const ToolpathPage& page = pages.at(n);
+    QVector<ToolpathSegment> *loaded = new QVector<ToolpathSegment>(page.count);
+    qint64 bytes = page.count * (qint64)sizeof(ToolpathSegment);
+    if (!file.seek(page.offset) || file.read((char *)loaded->data(), bytes) != bytes)
+    {
+        delete loaded;
+        return NULL;
+    }
+    // the budget always keeps the page being read
+    int cost = qMin((int)(bytes / 1024) + 1, resident.maxCost());
+    resident.insert(n, loaded, cost);
+    return loaded;
+}
+
+// calls : 'Viewer::setPageBudget()'
+void ToolpathStore::setMemoryBudget(int mb)
+{
+    resident.setMaxCost(qMax(1, mb) * 1024);
+}
+
+int ToolpathStore::residentPages() const
+{
+    return resident.count();
+}
+
+// Starts from the last checkpoint before 'line', then only reads the
+// pages written since.
+// calls : 'MainWindow::resumePreamble()':1
+bool ToolpathStore::positionBefore(int line, QVector3D& pos)
+{
+    int from = 0;
+    int low = 0, high = checkpoints.size();
+    while (low < high)
+    {
+        int mid = (low + high) / 2;
+        if (checkpoints.at(mid).line < line)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    bool found = false;
+    if (low > 0)
+    {
+        const Checkpoint& c = checkpoints.at(low - 1);
+        from = c.line;
+        pos = QVector3D(c.pos[0], c.pos[1], c.pos[2]);
+        found = true;
+    }
+    if (line - 1 < from)
+        return found;
+
+    // the moves of the last line before 'line', an arc may cross tiles
+    int best = -1;
+    QVector<ToolpathSegment> moves;
+    foreach (int n, pagesForLines(from, line - 1))
+    {
+        const QVector<ToolpathSegment> *segs = segments(n);
+        if (segs == NULL)
+            continue;
+        foreach (const ToolpathSegment& s, *segs)
+        {
+            if (s.line >= line || s.line < best)
+                continue;
+            if (s.line > best)
+            {
+                best = s.line;
+                moves.clear();
+            }
+            moves.append(s);
+        }
+    }
+    if (moves.isEmpty())
+        return found;
+
+    // the end of the line is the only end that starts no other move
+    int end = moves.size() - 1;
+    for (int i = 0; i < moves.size(); i++)
+    {
+        const float *b = moves.at(i).b;
+        bool starts = false;
+        for (int j = 0; j < moves.size() && !starts; j++)
+        {
+            const float *a = moves.at(j).a;
+            starts = a[0] == b[0] && a[1] == b[1] && a[2] == b[2];
+        }
+        if (!starts)
+            end = i;
+    }
+    const float *b = moves.at(end).b;
+    pos = QVector3D(b[0], b[1], b[2]);
+    return true;
+}
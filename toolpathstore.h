@@ -0,0 +1,121 @@
+/****************************************************************
+ * toolpathstore.h
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#ifndef TOOLPATHSTORE_H
+#define TOOLPATHSTORE_H
+
+#include <QCache>
+#include <QHash>
+#include <QTemporaryFile>
+#include <QThread>
+#include <QVector>
+#include <QVector3D>
+
+// segments in a page of the cache file, 128 KB
+#define TOOLPATH_PAGE_SEGMENTS      4096
+// side of a tile in mm
+#define TOOLPATH_TILE_MM            25.0
+// chord tolerance of the arcs, mm
+#define TOOLPATH_ARC_TOL_MM         0.05
+// partial pages written when the tiles being filled exceed this size
+#define TOOLPATH_WRITE_BUFFER       (32 << 20)
+// one line position kept in memory every that many segments
+#define TOOLPATH_CHECKPOINT         1024
+// programs larger than this are kept out of memory, MB
+#define TOOLPATH_DEFAULT_LIMIT_MB   512
+// pages of the cache file kept in memory, MB
+#define TOOLPATH_DEFAULT_BUDGET_MB  256
+
+class ToolpathSegment
+{
+public:
+    float a[3], b[3];
+    int line;
+    int g;
+};
+
+// a run of segments of one tile, consecutive in the program
+class ToolpathPage
+{
+public:
+    qint64 offset;
+    int count;
+    int firstLine, lastLine;
+    float lo[3], hi[3];
+};
+
+// Out of core storage of the moves of a program too large for memory.
+// Segments are written once, by tile of the XY plane and in program
+// order, to a temporary cache file. Only the page directory stays in
+// memory, pages are read back on demand and the most recently used are
+// cached within a memory budget.
+class ToolpathStore
+{
+public:
+    ToolpathStore();
+    ~ToolpathStore();
+
+    // writer, 'ProgramAnalyzer::analyze()' on a worker thread
+    bool create(bool mm);
+    void append(const QVector3D& a, const QVector3D& b, int line, int g);
+    bool finish();
+    // when written by a worker thread for the GUI
+    void moveToThread(QThread *thread);
+
+    bool isEmpty() const;
+    bool mm() const;
+    qint64 segmentCount() const;
+    qint64 fileSize() const;
+    QVector3D boundsMin() const;
+    QVector3D boundsMax() const;
+
+    int pageCount() const;
+    const ToolpathPage& page(int n) const;
+    QVector<int> pagesInBox(const QVector3D& lo, const QVector3D& hi) const;
+    // planes 'a x + b y + c z - d = 0', normals outward as in
+    // 'qglviewer::Camera::getFrustumPlanesCoefficients()'
+    QVector<int> pagesInFrustum(const double coef[6][4]) const;
+    QVector<int> pagesForLines(int first, int last) const;
+
+    // segments of page 'n', valid until the next call, 0 on read error
+    const QVector<ToolpathSegment> *segments(int n);
+    void setMemoryBudget(int mb);
+    int residentPages() const;
+
+    // end of the last move of a line before 'line', false if none
+    bool positionBefore(int line, QVector3D& pos);
+
+private:
+    Q_DISABLE_COPY(ToolpathStore)
+    void writePage(QVector<ToolpathSegment>& buffer);
+    void writeAll();
+
+private:
+    class Checkpoint
+    {
+    public:
+        int line;
+        float pos[3];
+    };
+
+    QTemporaryFile file;
+    bool useMm;
+    bool failed;
+    qint64 total;
+    float lo[3], hi[3];
+    // tiles being filled, key from the tile coordinates
+    QHash<qint64, QVector<ToolpathSegment> > filling;
+    qint64 buffered;
+    QVector<ToolpathPage> pages;
+    QVector<Checkpoint> checkpoints;
+    // page number -> segments, cost in KB
+    QCache<int, QVector<ToolpathSegment> > resident;
+};
+
+#endif // TOOLPATHSTORE_H
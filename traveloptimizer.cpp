@@ -0,0 +1,615 @@
+/****************************************************************
+ * traveloptimizer.cpp
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#include "traveloptimizer.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegExp>
+#include <QScopedPointer>
+#include <QTextStream>
+#include <QtConcurrent/QtConcurrentMap>
+#include <qmath.h>
+
+#include "compressedfile.h"
+#include "definitions.h"
+#include "gcode.h"
+#include "programanalyzer.h"
+
+// same retract height within this distance
+#define TRAVEL_Z_EPSILON    1e-6
+
+static double distance(const QPointF& a, const QPointF& b)
+{
+    double dx = a.x() - b.x(), dy = a.y() - b.y();
+    return qSqrt(dx * dx + dy * dy);
+}
+
+///-----------------------------------------------------------------------------
+// Buckets of points on a square grid of about two points per cell,
+// searched ring after ring around a query point.
+class TravelGrid
+{
+public:
+    TravelGrid(const QVector<QPointF>& pts)
+        : points(pts)
+    {
+        double minX = 0, minY = 0, maxX = 0, maxY = 0;
+        for (int n = 0; n < points.size(); n++)
+        {
+            const QPointF& p = points.at(n);
+            if (n == 0 || p.x() < minX) minX = p.x();
+            if (n == 0 || p.y() < minY) minY = p.y();
+            if (n == 0 || p.x() > maxX) maxX = p.x();
+            if (n == 0 || p.y() > maxY) maxY = p.y();
+        }
+        origin = QPointF(minX, minY);
+        double w = maxX - minX, h = maxY - minY;
+        int count = qMax(1, points.size());
+        cell = w * h > 0 ? qSqrt(2 * w * h / count) : qMax(w, h) * 2 / count;
+        // a few million cells at most
+        cell = qMax(cell, qMax(w, h) / 2048);
+        if (cell <= 0)
+            cell = 1;
+        cols = (int)(w / cell) + 1;
+        rows = (int)(h / cell) + 1;
+
+        buckets.resize(cols * rows);
+        slot.resize(points.size());
+        for (int n = 0; n < points.size(); n++)
+            insert(n);
+    }
+
+    void remove(int n)
+    {
+        QVector<int>& bucket = buckets[cellOf(points.at(n))];
+        int last = bucket.last();
+        bucket[slot.at(n)] = last;
+        slot[last] = slot.at(n);
+        bucket.removeLast();
+    }
+
+    // nearest point still in the grid, -1 when empty
+    int nearest(const QPointF& q) const
+    {
+        QList<int> found;
+        nearest(q, 1, -1, found);
+        return found.isEmpty() ? -1 : found.first();
+    }
+
+    // the 'count' nearest points but 'self', closest first
+    void nearest(const QPointF& q, int count, int self, QList<int>& found) const
+    {
+        QList<double> dist;
+        found.clear();
+
+        int cx, cy;
+        double outside = locate(q, cx, cy);
+        int maxRing = qMax(cols, rows);
+        for (int r = 0; r <= maxRing; r++)
+        {
+            for (int y = cy - r; y <= cy + r; y++)
+            {
+                if (y < 0 || y >= rows)
+                    continue;
+                // only the border of the ring
+                int step = (y == cy - r || y == cy + r) ? 1 : qMax(1, 2 * r);
+                for (int x = cx - r; x <= cx + r; x += step)
+                {
+                    if (x < 0 || x >= cols)
+                        continue;
+                    foreach (int n, buckets.at(y * cols + x))
+                    {
+                        if (n == self)
+                            continue;
+                        double d = distance(q, points.at(n));
+                        if (found.size() == count && d >= dist.last())
+                            continue;
+                        int at = 0;
+                        while (at < dist.size() && dist.at(at) <= d)
+                            at++;
+                        dist.insert(at, d);
+                        found.insert(at, n);
+                        if (found.size() > count)
+                        {
+                            dist.removeLast();
+                            found.removeLast();
+                        }
+                    }
+                }
+            }
+            // the next ring is at least 'r' cells away from the query cell
+            if (found.size() == count && dist.last() <= r * cell - outside)
+                break;
+        }
+    }
+
+private:
+    void insert(int n)
+    {
+        QVector<int>& bucket = buckets[cellOf(points.at(n))];
+        slot[n] = bucket.size();
+        bucket.append(n);
+    }
+
+    int cellOf(const QPointF& p) const
+    {
+        int cx, cy;
+        locate(p, cx, cy);
+        return cy * cols + cx;
+    }
+
+    // cell of 'p' clamped to the grid, returns how far 'p' lies outside it
+    double locate(const QPointF& p, int& cx, int& cy) const
+    {
+        double fx = (p.x() - origin.x()) / cell;
+        double fy = (p.y() - origin.y()) / cell;
+        cx = qBound(0, (int)qFloor(fx), cols - 1);
+        cy = qBound(0, (int)qFloor(fy), rows - 1);
+        double dx = qMax(0.0, qMax(cx - fx, fx - (cx + 1))) * cell;
+        double dy = qMax(0.0, qMax(cy - fy, fy - (cy + 1))) * cell;
+        return qSqrt(dx * dx + dy * dy);
+    }
+
+private:
+    const QVector<QPointF>& points;
+    QPointF origin;
+    double cell;
+    int cols;
+    int rows;
+    QVector< QVector<int> > buckets;
+    QVector<int> slot;
+};
+
+///-----------------------------------------------------------------------------
+TravelOptimizer::TravelOptimizer()
+    : rateX(0), rateY(0)
+{
+}
+
+// calls : 'MainWindow::optimizeTravel()':1
+void TravelOptimizer::setRapidRates(double x, double y)
+{
+    rateX = x;
+    rateY = y;
+}
+
+const TravelOptimizerStats& TravelOptimizer::stats() const
+{
+    return result;
+}
+
+QString TravelOptimizer::errorString() const
+{
+    return error;
+}
+
+QString TravelOptimizer::optimizedPath(const QString& inPath)
+{
+    // the copy is written uncompressed
+    QFileInfo info(CompressedFile::plainPath(inPath));
+    QString path = info.path() + "/" + info.completeBaseName() + TRAVEL_FILE_SUFFIX;
+    if (!info.suffix().isEmpty())
+        path += "." + info.suffix();
+    return path;
+}
+
+// calls : 'MainWindow::optimizeTravel()':1
+bool TravelOptimizer::optimize(const QString& inPath, const QString& outPath)
+{
+    error.clear();
+    result = TravelOptimizerStats();
+
+    QScopedPointer<QIODevice> inFile(CompressedFile::openRead(inPath, &error));
+    if (inFile.isNull())
+        return false;
+    QTextStream code(inFile.data());
+
+    // modal values of 'ProgramAnalyzer::processGCode()'
+    double x, y, z, i, j, k;
+    x = y = z = i = j = k = 0;
+    int p = 0, g = 0, spindle = 5, plane = NO_PLANE;
+    bool arc = false, cw = false, mm = true, helix = false, absolute = true;
+    double fr, ss, feed = 0, speed = 0;
+
+    QStringList lines;
+    QList<Group> groups;
+    Group group;
+    int groupPlane = plane;
+    bool stable = true, travelling = true, cut = false;
+    bool setX = false, setY = false;
+    double maxCutZ = 0;
+
+    while (!code.atEnd())
+    {
+        QString raw = code.readLine();
+        int n = lines.size();
+        lines.append(raw);
+
+        QString strline = raw;
+        GCode::trimToEnd(strline, '(');
+        GCode::trimToEnd(strline, ';');
+        GCode::trimToEnd(strline, '%');
+        strline = strline.trimmed();
+        if (strline.isEmpty())
+            continue;
+
+        QString formatted = strline.toUpper();
+        formatted.replace(QRegExp("([A-Z])"), " \\1");
+        formatted.replace(QRegExp("\\s+"), " ");
+
+        double beforeZ = z;
+        QPointF before(x, y);
+        p = 0; fr = 0.0; ss = 0.0;
+        ProgramAnalyzer::processGCode(formatted, x, y, z, i, j, k,
+                                      p, arc, cw, mm, g,
+                                      plane, helix, fr, ss,
+                                      absolute, spindle);
+
+        // words allowed in a group : motion, plane, axes, arc centers
+        // and the feed or speed already in force
+        bool hasXY = false, hasZ = false, others = false;
+        foreach (const QString& word, formatted.split(" ", QString::SkipEmptyParts))
+        {
+            QChar letter = word.at(0);
+            if (letter == 'X' || letter == 'Y')
+                hasXY = true;
+            else if (letter == 'Z')
+                hasZ = true;
+            else if (letter == 'N' || letter == 'I' || letter == 'J' || letter == 'K' || letter == 'R')
+                continue;
+            else if (letter == 'G')
+            {
+                double value = word.mid(1).toDouble();
+                if (value > 3 && value != 4 && value != 17 && value != 18 && value != 19
+                        && value != 90 && value != 94)
+                    stable = false;
+                if (value != 0)
+                    others = true;
+            }
+            else if (letter == 'F' || letter == 'S' || letter == 'P')
+                others = true;
+            else
+            {
+                // M, T, anything else
+                stable = false;
+                others = true;
+            }
+        }
+        if (fr > 0 && fr != feed)
+            stable = false;
+        if (ss > 0 && ss != speed)
+            stable = false;
+        if (fr > 0)
+            feed = fr;
+        if (ss > 0)
+            speed = ss;
+        if (!absolute || plane != groupPlane)
+            stable = false;
+
+        bool retract = g == 0 && hasZ && !hasXY && !others && z > beforeZ;
+        bool travel = g == 0 && hasXY && !hasZ && !others;
+
+        if (travelling && !travel)
+        {
+            // the feature starts here, where the travel took the tool
+            travelling = false;
+            group.entry = before;
+        }
+        else if (travelling)
+        {
+            foreach (const QString& word, formatted.split(" ", QString::SkipEmptyParts))
+            {
+                setX |= word.at(0) == 'X';
+                setY |= word.at(0) == 'Y';
+            }
+        }
+        if (g >= 1 && g <= 3)
+        {
+            maxCutZ = cut ? qMax(maxCutZ, qMax(z, beforeZ)) : qMax(z, beforeZ);
+            cut = true;
+        }
+
+        if (!retract)
+            continue;
+
+        group.last = n;
+        group.exit = QPointF(x, y);
+        group.retractZ = z;
+        group.mm = mm;
+        group.placed = setX && setY;
+        group.movable = stable && group.placed && cut && z > maxCutZ;
+        groups.append(group);
+
+        group = Group();
+        group.first = n + 1;
+        groupPlane = plane;
+        stable = true;
+        travelling = true;
+        cut = false;
+        setX = setY = false;
+    }
+    inFile->close();
+
+    // what follows the last retract stays at the end
+    if (group.first < lines.size())
+    {
+        group.last = lines.size() - 1;
+        group.placed = setX && setY;
+        group.movable = false;
+        groups.append(group);
+    }
+
+    // runs of movable groups retracting to the height the previous
+    // group retracted to, travels happen at that height
+    QList<TravelRun> runs;
+    for (int n = 0; n < groups.size(); n++)
+    {
+        const Group& g = groups.at(n);
+        if (g.movable)
+            result.movable++;
+        if (!g.movable || n == 0)
+            continue;
+
+        const Group& previous = groups.at(n - 1);
+        bool sameHeight = qAbs(previous.retractZ - g.retractZ) <= TRAVEL_Z_EPSILON;
+        bool extends = !runs.isEmpty() && runs.last().groups.last() == n - 1 && sameHeight;
+        if (extends)
+        {
+            runs.last().groups.append(n);
+            runs.last().entry.append(g.entry);
+            runs.last().exit.append(g.exit);
+        }
+        else if (sameHeight)
+        {
+            TravelRun run;
+            run.start = previous.exit;
+            run.mm = g.mm;
+            run.groups.append(n);
+            run.entry.append(g.entry);
+            run.exit.append(g.exit);
+            runs.append(run);
+        }
+    }
+    result.groups = groups.size();
+
+    for (int n = runs.size() - 1; n >= 0; n--)
+    {
+        // the block after the run must not start where its last group ends
+        TravelRun& run = runs[n];
+        int after = run.groups.last() + 1;
+        if (after < groups.size() && !groups.at(after).placed)
+        {
+            run.groups.removeLast();
+            run.entry.removeLast();
+            run.exit.removeLast();
+        }
+        if (run.groups.size() < 3)
+            runs.removeAt(n);
+    }
+    result.runs = runs.size();
+
+    // one run per thread
+    QtConcurrent::blockingMap(runs, &TravelOptimizer::solve);
+
+    QVector<int> sequence;
+    sequence.reserve(groups.size());
+    int next = 0;
+    foreach (const TravelRun& run, runs)
+    {
+        while (next < run.groups.first())
+            sequence.append(next++);
+        QVector<int> fileOrder(run.groups.size());
+        for (int n = 0; n < fileOrder.size(); n++)
+            fileOrder[n] = n;
+        account(run, fileOrder, result.distanceIn, result.secondsIn);
+        account(run, run.order, result.distanceOut, result.secondsOut);
+        foreach (int n, run.order)
+            sequence.append(run.groups.at(n));
+        next = run.groups.last() + 1;
+    }
+    while (next < groups.size())
+        sequence.append(next++);
+
+    QFile outFile(outPath);
+    if (!outFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        error = outFile.errorString();
+        return false;
+    }
+    QTextStream out(&outFile);
+    foreach (int n, sequence)
+    {
+        const Group& g = groups.at(n);
+        for (int line = g.first; line <= g.last; line++)
+            out << lines.at(line) << "\n";
+    }
+    out.flush();
+    if (outFile.error() != QFile::NoError)
+    {
+        error = outFile.errorString();
+        return false;
+    }
+    return true;
+}
+
+// Travel of a run in the given order, the time is the longest axis at
+// its rapid rate, acceleration left out.
+void TravelOptimizer::account(const TravelRun& run, const QVector<int>& order,
+                              double& dist, double& seconds) const
+{
+    double unit = run.mm ? 1 : MM_IN_AN_INCH;
+    QPointF at = run.start;
+    foreach (int n, order)
+    {
+        const QPointF& to = run.entry.at(n);
+        dist += distance(at, to);
+        if (rateX > 0 && rateY > 0)
+            seconds += 60 * qMax(qAbs(to.x() - at.x()) * unit / rateX,
+                                 qAbs(to.y() - at.y()) * unit / rateY);
+        at = run.exit.at(n);
+    }
+}
+
+///-----------------------------------------------------------------------------
+// Node 'count' is the fixed start of the open tour.
+static double hop(const TravelRun& run, int from, int to)
+{
+    const QPointF& a = from == run.entry.size() ? run.start : run.exit.at(from);
+    return distance(a, run.entry.at(to));
+}
+
+// Classic 2-opt on the candidate lists, for holes where entering and
+// leaving a feature happen at the same point. The last node has no
+// successor, reversing a tail only changes one edge.
+static void twoOpt(TravelRun& run, const QVector< QList<int> >& neighbours, const QElapsedTimer& clock)
+{
+    int count = run.entry.size();
+    QVector<int> tour(count + 1);
+    QVector<int> pos(count + 1);
+    tour[0] = count;
+    for (int n = 0; n < count; n++)
+        tour[n + 1] = run.order.at(n);
+    for (int n = 0; n <= count; n++)
+        pos[tour.at(n)] = n;
+
+    bool improved = true;
+    while (improved && clock.elapsed() < TRAVEL_SEARCH_MSEC)
+    {
+        improved = false;
+        for (int i = 0; i < count; i++)
+        {
+            int a = tour.at(i);
+            foreach (int c, neighbours.at(a))
+            {
+                int j = pos.at(c);
+                if (j <= i + 1)
+                    continue;
+
+                int b = tour.at(i + 1);
+                double delta = hop(run, a, c) - hop(run, a, b);
+                if (j < count)
+                {
+                    int d = tour.at(j + 1);
+                    delta += hop(run, b, d) - hop(run, c, d);
+                }
+                if (delta >= -1e-9)
+                    continue;
+
+                for (int l = i + 1, r = j; l < r; l++, r--)
+                {
+                    qSwap(tour[l], tour[r]);
+                    pos[tour.at(l)] = l;
+                    pos[tour.at(r)] = r;
+                }
+                improved = true;
+            }
+            if ((i & 1023) == 0 && clock.elapsed() >= TRAVEL_SEARCH_MSEC)
+                break;
+        }
+    }
+
+    for (int n = 0; n < count; n++)
+        run.order[n] = tour.at(n + 1);
+}
+
+// Relocation of single features, engraving features are not reversible
+// so the moves of 2-opt would change the cost inside the segment.
+static void orOpt(TravelRun& run, const QVector< QList<int> >& neighbours, const QElapsedTimer& clock)
+{
+    int count = run.entry.size();
+    QVector<int> tour(count + 1);
+    QVector<int> pos(count + 1);
+    tour[0] = count;
+    for (int n = 0; n < count; n++)
+        tour[n + 1] = run.order.at(n);
+    for (int n = 0; n <= count; n++)
+        pos[tour.at(n)] = n;
+
+    bool improved = true;
+    while (improved && clock.elapsed() < TRAVEL_SEARCH_MSEC)
+    {
+        improved = false;
+        for (int i = 1; i <= count; i++)
+        {
+            int g = tour.at(i);
+            int before = tour.at(i - 1);
+            double gain = hop(run, before, g);
+            if (i < count)
+                gain += hop(run, g, tour.at(i + 1)) - hop(run, before, tour.at(i + 1));
+
+            // candidates are features worth visiting right after 'g'
+            foreach (int c, neighbours.at(g))
+            {
+                int j = pos.at(c);
+                if (j == i + 1)
+                    continue;
+
+                int previous = tour.at(j - 1);
+                double cost = hop(run, previous, g) + hop(run, g, c) - hop(run, previous, c);
+                if (cost >= gain - 1e-9)
+                    continue;
+
+                tour.remove(i);
+                int at = j > i ? j - 1 : j;
+                tour.insert(at, g);
+                for (int n = qMin(i, at); n <= qMax(i, at); n++)
+                    pos[tour.at(n)] = n;
+                improved = true;
+                break;
+            }
+            if ((i & 255) == 0 && clock.elapsed() >= TRAVEL_SEARCH_MSEC)
+                break;
+        }
+    }
+
+    for (int n = 0; n < count; n++)
+        run.order[n] = tour.at(n + 1);
+}
+
+// Nearest neighbour from the start, then the local search until it
+// stops improving or its time is up.
+// calls : 'QtConcurrent::blockingMap()'
+void TravelOptimizer::solve(TravelRun& run)
+{
+    QElapsedTimer clock;
+    clock.start();
+
+    int count = run.entry.size();
+    run.order.clear();
+    run.order.reserve(count);
+    {
+        TravelGrid grid(run.entry);
+        QPointF at = run.start;
+        for (int n = 0; n < count; n++)
+        {
+            int best = grid.nearest(at);
+            grid.remove(best);
+            run.order.append(best);
+            at = run.exit.at(best);
+        }
+    }
+
+    bool symmetric = true;
+    for (int n = 0; n < count && symmetric; n++)
+        symmetric = distance(run.entry.at(n), run.exit.at(n)) <= TRAVEL_Z_EPSILON;
+
+    // candidates : features entered near where each one is left
+    TravelGrid grid(run.entry);
+    QVector< QList<int> > neighbours(count + 1);
+    for (int n = 0; n < count; n++)
+        grid.nearest(run.exit.at(n), TRAVEL_NEIGHBOURS, n, neighbours[n]);
+    grid.nearest(run.start, TRAVEL_NEIGHBOURS, -1, neighbours[count]);
+
+    if (symmetric)
+        twoOpt(run, neighbours, clock);
+    else
+        orOpt(run, neighbours, clock);
+}
@@ -0,0 +1,112 @@
+/****************************************************************
+ * traveloptimizer.h
+ * GrblHoming - zapmaker fork on github
+ *
+ * 19 Oct 2026
+ * GPL License (see LICENSE file)
+ * Software is provided AS-IS
+ ****************************************************************/
+
+#ifndef TRAVELOPTIMIZER_H
+#define TRAVELOPTIMIZER_H
+
+#include <QPointF>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// suffix of the reordered copy : 'part.nc' -> 'part-travel.nc'
+#define TRAVEL_FILE_SUFFIX          "-travel"
+// candidates examined around each feature by the local search
+#define TRAVEL_NEIGHBOURS           8
+// time given to the local search of one run, the tour is valid anytime
+#define TRAVEL_SEARCH_MSEC          3000
+
+class TravelOptimizerStats
+{
+public:
+    TravelOptimizerStats()
+        : groups(0), movable(0), runs(0),
+          distanceIn(0), distanceOut(0), secondsIn(0), secondsOut(0) {}
+
+public:
+    // cut groups found, those free to move, runs reordered
+    int groups;
+    int movable;
+    int runs;
+    // rapid travel in the unit of the program
+    double distanceIn;
+    double distanceOut;
+    // 0 when the rapid rates are unknown
+    double secondsIn;
+    double secondsOut;
+};
+
+// One tour problem : features visited from 'start', each entered at
+// 'entry' and left at 'exit' (the same point for a hole).
+class TravelRun
+{
+public:
+    TravelRun() : mm(true) {}
+
+public:
+    QPointF start;
+    QVector<QPointF> entry;
+    QVector<QPointF> exit;
+    bool mm;
+    // file order of the groups, then the order found
+    QVector<int> groups;
+    QVector<int> order;
+};
+
+// Reorders the cut groups of a program to shorten the rapid moves
+// between them. A group runs from the line after a retract (Z only G0
+// going up) to its next retract and starts with G0 moves setting both
+// X and Y. Groups changing the modal state, the units, the offsets, the
+// tool or the spindle stay in place and split the file in runs, each
+// solved on the thread pool by nearest neighbour then a local search.
+class TravelOptimizer
+{
+public:
+    TravelOptimizer();
+
+    // mm/min from Grbl '$110' and '$111', 0 : unknown
+    void setRapidRates(double x, double y);
+
+    // any thread, one file at a time
+    bool optimize(const QString& inPath, const QString& outPath);
+    const TravelOptimizerStats& stats() const;
+    QString errorString() const;
+
+    static QString optimizedPath(const QString& inPath);
+    // thread pool entry point
+    static void solve(TravelRun& run);
+
+private:
+    class Group
+    {
+    public:
+        Group()
+            : first(0), last(0), placed(false), movable(false), retractZ(0), mm(true) {}
+    public:
+        int first;
+        int last;
+        // starts with travel moves setting X and Y
+        bool placed;
+        bool movable;
+        double retractZ;
+        bool mm;
+        QPointF entry;
+        QPointF exit;
+    };
+
+    void account(const TravelRun& run, const QVector<int>& order, double& distance, double& seconds) const;
+
+private:
+    double rateX;
+    double rateY;
+    TravelOptimizerStats result;
+    QString error;
+};
+
+#endif // TRAVELOPTIMIZER_H
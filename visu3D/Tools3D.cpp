@@ -66,6 +66,33 @@ void Tools3D::setUnit(bool mm1)
 	mm = mm1;
 }
 
+Tools3D::typeTool Tools3D::tool() const
+{
+	return type;
+}
+
+/// the shapes of 'gdraw3D()'
+double Tools3D::cutRadius(typeTool t)
+{
+	double R = TOOL3D_DIAMETER_MM/2.0;
+	if (t == _SHARP_SHORT)
+		return R/2.0;
+	if (t == _MINI)
+		return R/3.0;
+	return R;
+}
+
+double Tools3D::cutProfile(typeTool t, double r)
+{
+	double R = cutRadius(t);
+	if (t == _RIGHT)
+		return 0;
+	if (t == _HEMI || t == _MINI)
+		return R - qSqrt(qMax(0.0, R*R - r*r));
+	// cones of height 3 D for a radius D/2, the short one half of it
+	return r*3*TOOL3D_DIAMETER_MM/(TOOL3D_DIAMETER_MM/2.0);
+}
+
 //
 void Tools3D::gdraw3D() const
 {
@@ -73,8 +100,8 @@ void Tools3D::gdraw3D() const
 	float Y = start.y();
 	float Z = start.z();
 	/// mm
-	float D = 3.0;
-	float L = 10.0;
+	float D = TOOL3D_DIAMETER_MM;
+	float L = TOOL3D_LENGTH_MM;
 	if (!mm) {
 		D /= MM_IN_AN_INCH;
 		L /= MM_IN_AN_INCH;
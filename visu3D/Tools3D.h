@@ -14,6 +14,10 @@
 #include <QGLViewer/qglviewer.h>
 #include <stdint.h>	// uint8_t ...
 
+// size of the drawn tools, mm
+#define TOOL3D_DIAMETER_MM	3.0
+#define TOOL3D_LENGTH_MM	10.0
+
 class Tools3D
 {
 	public:
@@ -36,6 +40,12 @@ class Tools3D
 		void setPos(double x, double y, double z);
 		void setTool(typeTool);
 		void setUnit(bool mm);
+		typeTool tool() const;
+
+		// cutting radius of a tool, mm
+		static double cutRadius(typeTool);
+		// height of the cutting edge above the tip at 'r' from the axis, mm
+		static double cutProfile(typeTool, double r);
 
 	private:
 
@@ -21,12 +21,20 @@ Viewer::Viewer(QWidget *parent1)
 	radius(MAX_X), tol(TOL_MM_STEP), // mm
 	mm(true),
 	plane(PLANE_XY_G17),
-	withtool(true), withbbox(true), withg0(true), created(false), first(true),
+	withtool(true), withbbox(true), withg0(true), withreference(true), withstock(false), created(false), first(true),
 	vmax(MAX_X),   // mm
 	vecBanned(MAX_X, MAX_Y, MAX_Z), phome(MIN_X, MIN_Y, MAX_Z),
-	pvcenter(25, 25, 50 )   /// oups ?
+	pvcenter(25, 25, 50 ),   /// oups ?
+	segmentIndex(0), pageBudget(TOOLPATH_DEFAULT_BUDGET_MB), sceneLine(0),
+	pendingLine(-1), toolDirty(false), scheduler(0),
+	timelineDirty(true), rapidrate(MOTION_RAPID_DEFAULT),
+	simtime(0), simorigin(0), simend(0), speed(1), simfactor(1), lastprogress(0)
 {
 	restoreStateFromFile();
+	// animator, the dial may set the speed before 'init()'
+	lineclock.start();
+	frameTimer = new QTimer(this);
+	connect(frameTimer, SIGNAL(timeout()), this, SLOT(simFrame()));
 }
 
 void Viewer::init()
@@ -44,22 +52,13 @@ void Viewer::init()
 	///
 	visu = false;
 	pause = true;
-	firstauto = true;
 	runcode = false;
-	npoint = -1;
 	linecodeText = linecodeTextmax = 0;
-	posPath = 0;
+	posReqKind = 0;
 	pmin = QVector3D( MIN_X, MIN_Y, MIN_Z);
 	pmin = QVector3D( MAX_X, MAX_Y, MAX_Z);
 	pcurr = pprev = phome;
 
-	// timer animator
-	repeatVisu = new QTimer(this);
-	//setPeriod(250);
-	connect(repeatVisu, SIGNAL(timeout()), this, SLOT(setVisualAuto()));
-	// timer for points
-	repeatPoint = new QTimer(this);
-	connect(repeatPoint, SIGNAL(timeout()), this, SLOT(drawItem()));
 	//itemrec = true;
 }
 
@@ -78,6 +77,8 @@ void Viewer::setItems(QList<PosItem> itemsRcvd)
 		vecBanned /= MM_IN_AN_INCH;
 	}
     // create all
+	pendingLine = -1;
+	timelineDirty = true;
 	gcreateScene();
 	gcreateBbox();
 	/// z + 10 mm
@@ -88,6 +89,10 @@ void Viewer::setItems(QList<PosItem> itemsRcvd)
 	Tool.setUnit(mm);
 	Tool.setPos(pcurr);
 	gcreateTool();
+	// animator from the beginning
+	stopClock();
+	simtime = 0;
+	emit setSimTime(clockText(0) + " / " + clockText(timeline.duration()));
     //
     setTextIsEnabled(true);
     first = true;
@@ -97,21 +102,41 @@ void Viewer::setItems(QList<PosItem> itemsRcvd)
 /// main routine
 void Viewer::draw()
 {
+	// live positions since the last frame : the lists are built once,
+	// the scene only when the line in red changed
+	if (pendingLine >= 0) {
+		if (pendingLine != sceneLine && created)
+			gcreateScene(pendingLine);
+		pendingLine = -1;
+	}
+	if (toolDirty) {
+		gcreateTool();
+		toolDirty = false;
+	}
 	if (itemrec)  {
         // Scene
 		glCallList(_LSCENE);
+		if (store)  {
+			drawStore();
+		}
         // Bounding box
         if (withbbox)  {
 			glCallList(_LBBOX);
         }
+        // original path
+        if (withreference && !referenceItems.isEmpty())  {
+			glCallList(_LREFERENCE);
+        }
+        // simulated stock
+        if (withstock && !stockMap.isEmpty())  {
+			glCallList(_LSTOCK);
+        }
         // dimensions text bounding box
         drawDimBbox();
         // Tool
         if (withtool) {
 			glCallList(_LTOOL);
         }
-		// define max and min
-		setSceneBoundingBox (pvmin, pvmax);
 		if (first) {
 			set3DView();
 			first = false;
@@ -119,13 +144,134 @@ void Viewer::draw()
 	}
 }
 
+void Viewer::setSegmentIndex(const SegmentIndex *index)
+{
+	segmentIndex = index;
+}
+
+/// called by 'MainWindow::preProcessFile(...)' before 'setItems()'
+void Viewer::setToolpathStore(QSharedPointer<ToolpathStore> toolpaths)
+{
+	store = toolpaths;
+	if (!store)
+		return;
+
+	store->setMemoryBudget(pageBudget);
+	mm = store->mm();
+	pmin = store->boundsMin();
+	pmax = store->boundsMax();
+	pvmin = qglviewer::Vec (pmin.x(), pmin.y(), pmin.z());
+	pvmax = qglviewer::Vec (pmax.x(), pmax.y(), pmax.z());
+	pvcenter = (pvmax - pvmin )/2.0;
+	setBoundingBox();
+	created = true;
+}
+
+// calls : 'MainWindow::MainWindow()':1
+void Viewer::setFrameScheduler(FrameScheduler *frames)
+{
+	scheduler = frames;
+}
+
+// several positions per frame are drawn once
+void Viewer::schedule()
+{
+	if (scheduler)
+		scheduler->invalidate(this);
+	else
+		update();
+}
+
+// calls : 'MainWindow::updateSettingsFromOptionDlg()':1
+void Viewer::setPageBudget(int mb)
+{
+	pageBudget = mb;
+	if (store)
+		store->setMemoryBudget(mb);
+}
+
+// Pages of the store in the view and around, while they fit in the
+// memory budget, the others only by their bounding box. Drawn with no
+// display list, nothing of the program stays in the GPU.
+void Viewer::drawStore()
+{
+	double coef[6][4];
+	camera()->getFrustumPlanesCoefficients(coef);
+	double margin = STORE_NEARBY_RATIO*sceneRadius();
+	for (int p = 0; p < 6; p++)
+		coef[p][3] += margin;
+
+	glDisable(GL_LIGHTING);
+	glLineWidth(1);
+	int budgetKB = pageBudget*1024;
+	QVector<int> boxes;
+	glBegin(GL_LINES);
+	foreach (int n, store->pagesInFrustum(coef)) {
+		int pageKB = store->page(n).count*sizeof(ToolpathSegment)/1024 + 1;
+		const QVector<ToolpathSegment> *segs = budgetKB >= pageKB ? store->segments(n) : 0;
+		if (!segs) {
+			boxes.append(n);
+			continue;
+		}
+		budgetKB -= pageKB;
+		foreach (const ToolpathSegment& s, *segs) {
+			if (s.line == sceneLine)
+				color = Qt::red;
+			else
+			if (s.g == 0) {
+				if (!withg0)
+					continue;
+				color = Qt::magenta;
+			}
+			else
+				color = Qt::darkBlue;
+			glColor4f(color.redF(), color.greenF(), color.blueF(), color.alphaF());
+			glVertex3fv(s.a);
+			glVertex3fv(s.b);
+		}
+	}
+	glEnd();
+
+	foreach (int n, boxes) {
+		const ToolpathPage& page = store->page(n);
+		Box3D box(QVector3D(page.lo[0], page.lo[1], page.lo[2]),
+				  QVector3D(page.hi[0], page.hi[1], page.hi[2]), mm, Qt::gray);
+		box.gdraw3D();
+	}
+}
+
+// the ray under the pixel against 'segmentIndex', no OpenGL selection
+// pass over the whole scene
+void Viewer::select(const QPoint& point)
+{
+	if (!segmentIndex || !itemrec)
+		return;
+
+	qglviewer::Vec orig, dir;
+	camera()->convertClickToLine(point, orig, dir);
+	double radius = PICK_RADIUS_PIXELS*camera()->pixelGLRatio(sceneCenter());
+	int nl = segmentIndex->pickRay(QVector3D(orig.x, orig.y, orig.z),
+								   QVector3D(dir.x, dir.y, dir.z), radius);
+	/// to 'MainWindow::pickLine(int)'
+	if (nl > 0)
+		emit linePicked(nl);
+}
+
 void Viewer::drawDimBbox()
 {
 	glDisable(GL_LIGHTING);
 	color= Qt::blue;
 	glColor4f(color.redF(), color.greenF(), color.blueF(), color.alphaF());
+	drawText(10, height()-10, dimText[0]);
+	drawText(10, height()-25, dimText[1]);
+}
+
+// bounds of the camera and their text, when the scene changes and not
+// at each frame
+void Viewer::setBoundingBox()
+{
+	setSceneBoundingBox(pvmin, pvmax);
 	QString unit;
-	QVector3D bpmin(pmin), bpmax(pmax);
 	uint8_t n;
 	if (mm) {
 		unit = " mm"; n = 3;
@@ -133,21 +279,22 @@ void Viewer::drawDimBbox()
 	else  {
 		unit = " in"; n = 4;
 	}
-	drawText(10, height()-10 , "BoxMin : " + QString().setNum(bpmin.x(), 'f', n) + "/"
-							   + QString().setNum(bpmin.y(), 'f', n) + "/"
-							   + QString().setNum(bpmin.z(), 'f', n)  + unit
-			);
-	drawText(10, height()-25, "BoxMax : " + QString().setNum(bpmax.x(), 'f', n) + "/"
-							   + QString().setNum(bpmax.y(), 'f', n) + "/"
-							   + QString().setNum(bpmax.z(), 'f', n) + unit
-			);
+	dimText[0] = "BoxMin : " + QString().setNum(pmin.x(), 'f', n) + "/"
+						   + QString().setNum(pmin.y(), 'f', n) + "/"
+						   + QString().setNum(pmin.z(), 'f', n) + unit;
+	dimText[1] = "BoxMax : " + QString().setNum(pmax.x(), 'f', n) + "/"
+						   + QString().setNum(pmax.y(), 'f', n) + "/"
+						   + QString().setNum(pmax.z(), 'f', n) + unit;
 }
 
 void Viewer::gcreateScene(int nl)
 {
+	sceneLine = nl;
 	glNewList(_LSCENE, GL_COMPILE) ;
 		Scene(nl);
 	glEndList();
+	if (created)
+		setBoundingBox();
 }
 
 void Viewer::gcreateBbox()
@@ -159,6 +306,64 @@ void Viewer::gcreateBbox()
 	glEndList();
 }
 
+// feed moves of 'referenceItems' in one color, rapids left out
+void Viewer::gcreateReference()
+{
+	glNewList(_LREFERENCE, GL_COMPILE) ;
+	if (!referenceItems.isEmpty()) {
+		QVector3D plast(referenceItems.at(0).x, referenceItems.at(0).y, referenceItems.at(0).z);
+		QList<QVector3D> points;
+		foreach (PosItem item, referenceItems) {
+			QVector3D pend(item.x, item.y, item.z);
+			if (item.g == 1) {
+				Line3D line(plast, pend);
+				line.setColor(QColor(255, 140, 0));
+				line.setLineWidth(3);
+				line.gdraw3D();
+			}
+			else
+			if (item.g == 2 || item.g == 3) {
+				Arc3D arc(item.plane, item.cw, plast, pend, QVector3D(item.i, item.j, item.k), 2, item.helix);
+				points.clear();
+				arc.interpolateAng(tol, points);
+				arc.setColor(QColor(255, 140, 0));
+				arc.setLineWidth(3);
+				arc.gdraw3D();
+			}
+			plast = pend;
+		}
+	}
+	glEndList();
+}
+
+// top of the stock as triangle strips, one row of cells after the
+// other, at most 'STOCK_DRAW_CELLS' on a side
+void Viewer::gcreateStock()
+{
+	glNewList(_LSTOCK, GL_COMPILE) ;
+	if (!stockMap.isEmpty()) {
+		int step = qMax(1, qMax(stockMap.cols, stockMap.rows)/STOCK_DRAW_CELLS);
+		double ox = stockMap.origin.x() + stockMap.cell/2.0;
+		double oy = stockMap.origin.y() + stockMap.cell/2.0;
+		glPushAttrib(GL_LIGHTING_BIT);
+		glDisable(GL_LIGHTING);
+		for (int row = 0; row + step < stockMap.rows; row += step) {
+			glBegin(GL_TRIANGLE_STRIP);
+			for (int col = 0; col < stockMap.cols; col += step) {
+				for (int r = row; r <= row + step; r += step) {
+					float z = stockMap.at(col, r);
+					QColor c = stockMap.color(z);
+					glColor3f(c.redF(), c.greenF(), c.blueF());
+					glVertex3f(ox + col*stockMap.cell, oy + r*stockMap.cell, z);
+				}
+			}
+			glEnd();
+		}
+		glPopAttrib();
+	}
+	glEndList();
+}
+
 void Viewer::gcreateTool()
 {
 	glNewList(_LTOOL, GL_COMPILE) ;
@@ -172,6 +377,7 @@ void Viewer::setTolerance(double t)
 {
 	if (t != tol)  {
 		tol = t;
+		timelineDirty = true;
 		if (created) {
 			gcreateScene();
 			update();
@@ -179,16 +385,10 @@ void Viewer::setTolerance(double t)
 	}
 }
 
-// slot called by 'MainWindow::::setSpeedRateToLine(QList<double>)'
-void Viewer::setFeedRateToLine(QList<double> stl)
-{
-	feedRateToLine = stl ;
-}
-
-// slot called by 'MainWindow::::setSpeedSpindleToLine(QList<double>)'
-void Viewer::setSpeedSpindleToLine(QList<double> stl)
+// slot called by 'MainWindow::setModalTimeline(ModalTimeline)'
+void Viewer::setModalTimeline(ModalTimeline timeline)
 {
-	speedSpindleToLine = stl ;
+	modal = timeline ;
 }
 
 // called for Gcode line valid
@@ -205,12 +405,14 @@ void Viewer::Scene(int nlColor){
 	Arc3D arc;
 	Line3D line;
     QVector3D pend, poffset;
-	/// no path interpolated
-	posPath = 0;
-	pathDrawing.clear();
-	pointToLine.clear();
-	feedRateByLineValid.clear();
-	segToLineValid.clear();
+	/// the line in red only changes the display list : the timeline read
+	/// by the animator and the segments are kept
+	bool timed = timelineDirty;
+	if (timed) {
+		/// no path interpolated
+		timeline.setStart(plast);
+		segToLineValid.clear();
+	}
 	// feedrate
 	feedrate = prevfeedrate = 0.0; // SPEED_DEFAUL ?
 	// speed spindle
@@ -231,9 +433,6 @@ void Viewer::Scene(int nlColor){
 		//1- spindle speed
 			if (item.speedspindle > 0 ) {
 				speedspindle = item.speedspindle;
-				/// QMap<int index, float feedrate>
-				speedSpindleByLineValid.insert(item.index, speedspindle);
-//diag(" item.index %d -> speedspindle %0.2f", item.index, speedspindle);
 			}
 			else
 			if (item.speedspindle == 0) {
@@ -245,9 +444,6 @@ void Viewer::Scene(int nlColor){
 		//2- feedrate
 			if (item.feedrate > 0) {
 				feedrate = item.feedrate;
-				/// QMap<int index, float feedrate>
-				feedRateByLineValid.insert(item.index, feedrate);
-//diag(" item.index %d -> feedtate %0.2f", item.index, feedrate);
 			}
 			else
 			if (item.feedrate == 0) {
@@ -338,26 +534,23 @@ void Viewer::Scene(int nlColor){
 			//if (motion)
 			pathItem.append(pend);
 			plast = pend;
-			/// fill list points
-			foreach(QVector3D p, pathItem) 	{
-				/// QList<int line>
-				pointToLine.append(item.index);
-				/// QList<QVector3D Point>
-				pathDrawing.append(p);
+			/// fill timeline, G0 and moves without feed rate at the rapid rate
+			if (timed) {
+				double rate = feedrate;
+				if (item.g == 0 || rate <= 0)
+					rate = mm ? rapidrate : rapidrate/MM_IN_AN_INCH;
+				foreach(QVector3D p, pathItem) 	{
+					timeline.append(p, item.index, rate);
+				}
 			}
 		}
 //diag(" item.index %d -> seg = %d", item.index, seg);
-		/// QMap<int index, float feedrate>
-		feedRateByLineValid.insert(item.index, feedrate);
-		/// QMap<int index, float speedspindle>
-		speedSpindleByLineValid.insert(item.index, speedspindle);
-		/// QMap<int index, int seg>
-		segToLineValid.insert(item.index, seg);
+		/// QHash<int index, int seg>, feedrate and speed are in 'modal'
+		if (seg && timed)
+			segToLineValid.insert(item.index, seg);
 		prevfeedrate = feedrate ;
 		prevspeedspindle = speedspindle;
     }
-    /// last number point [0..npointmax]
-	npointmax = pathDrawing.size()-1;
 	/// for bounding box
     pvmin = qglviewer::Vec (pmin.x(), pmin.y(), pmin.z());
     pvmax = qglviewer::Vec (pmax.x(), pmax.y(), pmax.z());
@@ -365,6 +558,7 @@ void Viewer::Scene(int nlColor){
 
     /// created scene
     created = true;
+    timelineDirty = false;
 /*
 int u = 0;
 foreach (int seg , segToLineValid)
@@ -389,6 +583,7 @@ QString Viewer::helpString() const
 
   text += tr("<br>Displays the <b>Path</b> GCode using 'OpenGL'.") ;
   text += tr("<br><br><i>Move the camera using the mouse.</i>");
+  text += tr("<br><i>Shift + click on the path selects its line.</i>");
 
   text += "</center><br>";
   return text;
@@ -479,15 +674,10 @@ void Viewer::setLivePoint(QVector3D xyz, bool /*useMm*/, int nl)   /// + bool mm
 //diag("===========> setLivePoint::pcurr = %0.2f/%0.2f/%0.2f", pcurr.x(), pcurr.y(), pcurr.z() );
 		//Tool.setUnit(useMm);
 		Tool.setPos(pcurr);
-		gcreateTool();
-		/// scene
-		if (nl) {
-			gcreateScene(nl);
-		}
-		else   {
-			gcreateScene() ;
-		}
-		update();
+		/// tool and scene at the next frame
+		toolDirty = true;
+		pendingLine = nl;
+		schedule();
 	}
 	// display colored line to 'visuGcode'
 	emit setActiveLineVisuGcode(nl, true);
@@ -508,7 +698,7 @@ double Viewer::getFeedRate(int nl)
 	if (!mm)
 		s /= MM_IN_AN_INCH;
 	if (nl >= 0 && nl <= linecodeTextmax )  {
-		s = feedRateToLine.value(nl);
+		s = modal.at(nl).feedrate;
 	}
 	return s;
 }
@@ -518,7 +708,7 @@ double Viewer::getSpeedSpindle(int nl)
 {
 	double s(0);
 	if (nl >= 0 && nl <= linecodeTextmax )  {
-		s = speedSpindleToLine.value(nl);
+		s = modal.at(nl).speedspindle;
 	}
 
 	return s;
@@ -530,142 +720,124 @@ void Viewer::setNumLine(QString strline)
 {
 	int nl = strline.toUInt();
 	if (nl != linecodeText) {
-		feedrate = getFeedRate(nl);
-		emit setFeedRateGcode(feedrate);
-		speedspindle = getSpeedSpindle(nl);
-		emit setSpeedSpindleGcode(speedspindle);
-		linecodeText = nl;
-		if (!runcode) {
-			if (repeatPoint->isActive())  {
-				repeatPoint->stop();
-			}
-			ptemp = getLastPoint(nl) ;
-			if (ptemp != vecBanned)  {
-				setLivePoint(ptemp, mm, nl);	// item colored in red
-			}
-			else  {
-				setLivePoint(pcurr, mm);		// item colored normally
-			}
-			emit setSegments(getSeg(linecodeText));
+		/// execute Gcode : the moves of the line at machining speed
+		if (runcode) {
+			simtime = timeline.startOfLine(nl);
+			showLine(nl);
+			playTo(timeline.endOfLine(nl), 1);
 		}
-		/// execute Gcode
 		else {
-//diag("\n");
-			if (pointToLine.contains(nl)) {
-				// stop timer
-				if (repeatPoint->isActive())
-					repeatPoint->stop();
-				npmax = pointToLine.count(nl) ;
-//diag("nl : %d -> npmax = %d", nl, npmax);
-				nfirstpoint = pointToLine.indexOf(nl);
-				pointsItem  = pathDrawing.mid( nfirstpoint, npmax);
-				np = 0;
-//diag("nl %d -> speed %0.2f", nl, feedrate);
-				/// first item point
-				ptemp = pointsItem.value(np);
-				QVector3D pc;
-				float length;
-				int msec;
-			// line
-				if (npmax == 1) {
-					pc = pcurr;
-					// total length mm
-					length =  (ptemp - pc).length();
-					// mm/S
-					feedrate /= 60;
-					// total duration
-					msec = 1000*(length /feedrate);
-//diag("line->nl %d -> length : %5.2f / feedrate %5.2f -> msec %d", nl, length, feedrate, msec);
-					/// time mini for one segment = 200 mS
-					float tmini = 200.0;
-					npmax = msec/tmini;
-//diag("==>npmax = %d", npmax);
-					if (npmax > 1)  {
-						/// remplir poinstItem  ; firstp = pcur + dp, lastp = ptemp
-						pointsItem.clear();
-						QVector3D dp = (ptemp - pc)/npmax;
-						for (int u = 1; u <= npmax; u++) {
-							ptemp = pc + u*dp ;
-							pointsItem.append(ptemp);
-//diag("==> line->ptemp = %0.2f/%0.2f/%0.2f", ptemp.x(), ptemp.y(), ptemp.z() );
-						}
-						// !! coefficient !!
-						msec = tmini/5.0;
-					}
-					else
-						npmax = 1;
-
-					emit setSegments(npmax);
-					/// repeat all msec
-					repeatPoint->start(msec);
-				}
-			// arc
-				else {
-					pc = ptemp;
-					ptemp = pointsItem.value(np+1);
-//diag("===> pc = %0.2f/%0.2f/%0.2f", pc.x(), pc.y(), pc.z() );
-//diag("===> ptemp = %0.2f/%0.2f/%0.2f", ptemp.x(), ptemp.y(), ptemp.z() );
-					/// a segment length mm
-					length =  (ptemp - pc).length();
-					/// mm/S
-					feedrate /= 60;
-					msec = 1000*(length /feedrate);
-					/// coefficient !!!
-					msec *= 1.5;
-					//int msec = timeItem(npmax, speed);
-//diag("arc->nl %d -> length : %5.2f / feedrate %5.2f -> msec %d", nl, length, feedrate msec);
-					emit setSegments(npmax);
-					/// repeat all msec
-					repeatPoint->start(msec);
-				}
-			}
+			seekLine(nl);
 		}
 	}
 }
 
-void Viewer::drawItem()
+// the tool at the end of the moves of 'nl', found by a binary search
+void Viewer::seekLine(int nl)
 {
-	if (!runcode && repeatPoint->isActive() )  {
-			repeatPoint->stop();
+	simtime = timeline.endOfLine(nl);
+	if (frameTimer->isActive()) {
+		simorigin = simtime;
+		clock.start();
 	}
-	else
-	if  (np < npmax) {
-		pp = pointsItem.value(np);
-		setLivePoint(pp, mm, linecodeText);
-//diag("---> pp = %0.2f/%0.2f/%0.2f", pp.x(), pp.y(), pp.z() );
-		np++ ;
-		if (np >= npmax) {
-			repeatPoint->stop();
-		}
+	showLine(nl);
+	showTime();
+}
+
+// calls : 'ui->sliderSimTime::valueChanged(int)'
+void Viewer::seekProgress(int value)
+{
+	if (!visu || runcode || value == lastprogress)
+		return;
+
+	simtime = timeline.duration()*value/SIM_PROGRESS_STEPS;
+	if (frameTimer->isActive()) {
+		simorigin = simtime;
+		clock.start();
 	}
+	showTime(true);
 }
-/// TODO ...
-float Viewer::timeItem(int np, float speed)
+
+// the clock runs from 'simtime' to 'tend', 'factor' times faster than
+// the machine
+void Viewer::playTo(double tend, int factor)
 {
-	/// path length between two points
-	float length =  np*(pcurr -pprev).length();
-	// steps per mm  -> 1 step = 0.01 mm
-	//int stepsPerMm = 100;
-	//int steps = length * stepsPerMm;
-	// 1200 mm per mn ->  20 mm per second -> 0.02 mm per mS
-	float msec = length /speed;
+	simend = tend;
+	simfactor = factor;
+	simorigin = simtime;
+	clock.start();
+	if (!frameTimer->isActive())
+		frameTimer->start(SIM_FRAME_MSEC);
+	showTime();
+}
 
-	return msec;
+void Viewer::stopClock()
+{
+	frameTimer->stop();
 }
 
-// get last point from line number
-QVector3D Viewer::getLastPoint(int nl)
+// called by 'frameTimer' every 'SIM_FRAME_MSEC' : the position follows
+// the elapsed time, a late frame does not slow down the animation
+void Viewer::simFrame()
 {
-	/// verify nl
-	if (pointToLine.contains(nl)) {
-		npoint = pointToLine.lastIndexOf(nl);
-		ptemp = pathDrawing.at(npoint);
+	simtime = simorigin + clock.elapsed()*simfactor/1000.0;
+	if (simtime < simend) {
+		showTime();
+		return;
 	}
-	else  {
-		ptemp = vecBanned;
+	simtime = simend;
+	stopClock();
+	showTime(true);
+	/// run visu -> pause visu
+	if (visu && !runcode && simend >= timeline.duration())
+		emit setPauseVisual(true);
+}
+
+// the tool interpolated at 'simtime', the line displays follow at most
+// every 'SIM_LINE_MSEC' unless 'force'
+void Viewer::showTime(bool force)
+{
+	pprev = pcurr;
+	pcurr = timeline.positionAt(simtime);
+	Tool.setPos(pcurr);
+	toolDirty = true;
+	/// while sending, the line is the one acknowledged by Grbl
+	if (!runcode) {
+		int nl = timeline.lineAt(simtime);
+		if (nl != linecodeText && (force || lineclock.elapsed() >= SIM_LINE_MSEC))
+			showLine(nl);
 	}
+	double total = timeline.duration();
+	lastprogress = total > 0 ? qRound(SIM_PROGRESS_STEPS*simtime/total) : 0;
+	emit setSimProgress(lastprogress);
+	emit setSimTime(clockText(simtime) + " / " + clockText(total));
+	// display xyz
+	if (visu || posReqKind == POS_SYNC)
+		emit updateLCD(pcurr);
+	schedule();
+}
+
+// the line colored in red in the scene and in 'visuGcode'
+void Viewer::showLine(int nl)
+{
+	linecodeText = nl;
+	lineclock.start();
+	emit setFeedRateGcode(getFeedRate(nl)) ;
+	emit setSpeedSpindleGcode(getSpeedSpindle(nl)) ;
+	emit setLineNum(QString::number(nl)) ;
+	emit setSegments(getSeg(nl));
+	pendingLine = nl;
+	schedule();
+	emit setActiveLineVisuGcode(nl, true);
+}
 
-	return ptemp;
+// h:mm:ss
+QString Viewer::clockText(double sec)
+{
+	int s = qRound(sec);
+	return QString("%1:%2:%3").arg(s/3600)
+							  .arg((s/60)%60, 2, 10, QChar('0'))
+							  .arg(s%60, 2, 10, QChar('0'));
 }
 
 // called by 'MainWindow::toVisual(valid)'
@@ -674,10 +846,11 @@ void Viewer::setVisual(bool valid)
 {
 	visu = valid;
 	if (visu && !linecodeText) {
-		npoint = -1 ;
-		linecodeText = 1;
-		ptemp = getLastPoint(linecodeText);
-		setLivePoint(ptemp, mm, linecodeText) ;
+		seekLine(1);
+	}
+	else
+	if (!visu && !runcode) {
+		stopClock();
 	}
 }
 
@@ -686,96 +859,36 @@ void Viewer::setPause(bool valid)
 {
 	pause = valid;
 //diag("Viewer::setPause(%s)", valid==true ?"true":"false" );
-	if (visu) {
+	if (visu && !runcode) {
 		if (pause) {
-			repeatVisu->stop();
+			stopClock();
 		}
 		else {
-			repeatVisu->start(250);
+			/// the end was reached : again from the beginning
+			if (simtime >= timeline.duration())
+				simtime = 0;
+			playTo(timeline.duration(), speed);
 		}
 	}
 }
 // works with line number
 void Viewer::setPrev()
 {
-	if (visu && pause) {
-		if (linecodeText > 1) {
-			linecodeText--;
-		/// read  one vector
-			ptemp = getLastPoint(linecodeText) ;
-			emit setFeedRateGcode(getFeedRate(linecodeText)) ;
-			emit setSpeedSpindleGcode(getSpeedSpindle(linecodeText)) ;
-			emit setLineNum(QString::number(linecodeText));
-			emit setSegments(getSeg(linecodeText));
-			setLivePoint(ptemp, mm, linecodeText);
-		}
-		else
-		if (repeatVisu->isActive())  {
-			repeatVisu->stop();
-			first = true;
-		}
+	if (visu && pause && linecodeText > 1) {
+		seekLine(linecodeText - 1);
 	}
 }
 // works with line number
 void Viewer::setNext()
 {
-	if (visu && pause) {
-		if (linecodeText < linecodeTextmax) {
-			linecodeText++;
-			/// read  one vector
-			ptemp = getLastPoint(linecodeText) ;
-			emit setFeedRateGcode(getFeedRate(linecodeText)) ;
-			emit setSpeedSpindleGcode(getSpeedSpindle(linecodeText)) ;
-			emit setLineNum(QString::number(linecodeText)) ;
-			emit setSegments(getSeg(linecodeText));
-			setLivePoint(ptemp, mm, linecodeText);
-		}
-		else
-		if (repeatVisu->isActive())  {
-			repeatVisu->stop();
-			first = true;
-		}
+	if (visu && pause && linecodeText < linecodeTextmax) {
+		seekLine(linecodeText + 1);
 	}
 }
 
 uint32_t Viewer::getSeg(int nl)
 {
-	uint32_t seg(0);
-	if (segToLineValid.contains(nl) )
-		seg= segToLineValid.value(nl);
-
-	return seg;
-}
-
-// called by Timer 'Viewer::repeat' all '250'  mS
-// works with point number and line number
-void Viewer::setVisualAuto()
-{
-	if (visu && !pause) {
-		if (firstauto) {
-			npoint = -1;
-			firstauto = false;
-		}
-		if (npoint < npointmax) {
-			npoint++;
-			/// read  one vector
-			ptemp = pathDrawing.at(npoint) ;
-			linecodeText = pointToLine.at(npoint);
-			emit setFeedRateGcode(getFeedRate(linecodeText)) ;
-			emit setSpeedSpindleGcode(getSpeedSpindle(linecodeText)) ;
-			emit setLineNum(QString::number(linecodeText)) ;
-			emit setSegments(getSeg(linecodeText));
-			setLivePoint(ptemp, mm, linecodeText);
-		}
-		else
-		if (repeatVisu->isActive()) {
-			repeatVisu->stop();
-			first = true;
-			firstauto = true;
-			/// run visu -> pause visu
-			emit setPauseVisual(true);
-		}
-	}
+	return segToLineValid.value(nl, 0);
 }
 
 // called by 'MainWindow::begin()' : emit runCode(true);
@@ -785,16 +898,36 @@ void Viewer::runCode(bool run, int posreqkind)
 //diag("runCode : %s", run==true ? "true" : "false");
 	runcode = run;
 	posReqKind = posreqkind ;
-	if (runcode && repeatVisu->isActive()) {
-		repeatVisu->stop();
-		firstauto = true;
+	stopClock();
+}
+
+// calls : 'ui->dialSpeedAnim::valueChanged(int)'
+// the simulated time runs 'factor' times faster than the machine
+void Viewer::setSpeed(int factor)
+{
+	if (factor < 1)
+		return;
+	speed = factor;
+	/// the clock goes on from the present time
+	if (frameTimer->isActive() && !runcode) {
+		simtime = simorigin + clock.elapsed()*simfactor/1000.0;
+		simorigin = simtime;
+		simfactor = speed;
+		clock.start();
 	}
 }
 
-void Viewer::setPeriod(int p)
+// calls : 'MainWindow::setRapidRates()', mm per mn of the slowest axis
+void Viewer::setRapidRate(double rate)
 {
-	if (p > 100 && p <= 1000)
-		repeatVisu->setInterval(p) ;
+	if (rate > 0 && rate != rapidrate) {
+		rapidrate = rate;
+		timelineDirty = true;
+		if (created) {
+			gcreateScene(linecodeText);
+			update();
+		}
+	}
 }
 
 void Viewer::noTool()
@@ -849,6 +982,43 @@ void Viewer::setBbox(bool with)
 	update();
 }
 
+// slot called by 'MainWindow::setReferenceItems(QList<PosItem>)',
+// an empty list removes the comparison
+void Viewer::setReferenceItems(QList<PosItem> itemsRcvd)
+{
+	referenceItems = itemsRcvd;
+	gcreateReference();
+	update();
+}
+
+// slot called by 'ui->actionShowOriginal::toggled(bool)'
+void Viewer::setReference(bool with)
+{
+	withreference = with;
+	update();
+}
+
+// slot called by 'MainWindow::setStockMap(StockMap)'
+void Viewer::setStockMap(StockMap map)
+{
+	stockMap = map;
+	gcreateStock();
+	update();
+}
+
+// slot called by 'ui->actionShowStock::toggled(bool)'
+void Viewer::setStock(bool with)
+{
+	withstock = with;
+	update();
+}
+
+// the cutter simulated by 'StockSimulator'
+Tools3D::typeTool Viewer::toolType() const
+{
+	return Tool.tool();
+}
+
 void Viewer::setG0(bool with)
 {
 	withg0 = with;
@@ -868,15 +1038,10 @@ void Viewer::setLiveRelPoint(QVector3D dxyz, int nl)   /// + bool mm  , bool isL
 		pcurr += dxyz;
 //diag("==============> setLiveRelPoint::pcurr = %0.2f/%0.2f/%0.2f", pcurr.x(), pcurr.y(), pcurr.z() );
 		Tool.setPos(pcurr);
-		gcreateTool();
-		/// scene
-		if (nl) {
-			gcreateScene(nl);
-		}
-		else   {
-			gcreateScene() ;
-		}
-		update();
+		/// tool and scene at the next frame
+		toolDirty = true;
+		pendingLine = nl;
+		schedule();
 	}
 	// display colored line to 'visuGcode'
 	emit setActiveLineVisuGcode(nl, true);
@@ -12,23 +12,53 @@
 #include <QGLViewer/qglviewer.h>
 /// T4
 #include <QtOpenGL>
+#include <QElapsedTimer>
 #include <stdint.h>
 #include "Tools3D.h"
 
 #include "positem.h"
+#include "modaltimeline.h"
+#include "stocksimulator.h"
+#include "motiontimeline.h"
+#include "segmentindex.h"
+#include "toolpathstore.h"
+#include "framescheduler.h"
+
+// cells drawn on the longest side of the stock
+#define STOCK_DRAW_CELLS	300
+// animator : tool moved every frame, scene and line displays refreshed
+// at most every 'SIM_LINE_MSEC'
+#define SIM_FRAME_MSEC		33
+#define SIM_LINE_MSEC		150
+// positions of 'setSimProgress(int)' over the whole program
+#define SIM_PROGRESS_STEPS	1000
+// distance in pixels of a click to the picked segment
+#define PICK_RADIUS_PIXELS	5
+// pages of a 'ToolpathStore' read around the view, part of the scene radius
+#define STORE_NEARBY_RATIO	0.1
 
 class Viewer : public QGLViewer
 {
 	Q_OBJECT
 public :
-	enum glist {_LSCENE=1000, _LBBOX, _LTOOL};
+	enum glist {_LSCENE=1000, _LBBOX, _LTOOL, _LREFERENCE, _LSTOCK};
 
 	Viewer(QWidget *parent);
 	virtual void init();
+	// the index must stay valid until the next call, 0 to detach
+	void setSegmentIndex(const SegmentIndex *index);
+	// program too large for 'setItems()', 0 to detach
+	void setToolpathStore(QSharedPointer<ToolpathStore> store);
+	// MB of pages of the store kept in memory
+	void setPageBudget(int mb);
+	// live positions are drawn at its frames, 0 for at once
+	void setFrameScheduler(FrameScheduler *frames);
 
 protected :
 
 	virtual void draw();
+	// Shift + left click
+	virtual void select(const QPoint& point);
 
 	double getFeedRate(int nl);
 	double getSpeedSpindle(int nl);
@@ -42,6 +72,10 @@ signals:
 	void setFeedRateGcode(double);
 	void setSpeedSpindleGcode(double);
 	void setSegments(int);
+	void setSimTime(QString);
+	void setSimProgress(int);
+	// the user clicked a segment of 'line'
+	void linePicked(int line);
 
 public Q_SLOTS:
 
@@ -57,6 +91,11 @@ public Q_SLOTS:
 	void Help3D();
 
     void setItems(QList<PosItem>);
+	void setReferenceItems(QList<PosItem>);
+	void setReference(bool=true);
+	void setStockMap(StockMap);
+	void setStock(bool=true);
+	Tools3D::typeTool toolType() const;
 
 /// T4
     void setLivePoint(QVector3D xyz, bool useMm=true, int nl=0);
@@ -70,15 +109,12 @@ public Q_SLOTS:
 	void setPause(bool);
 	void setPrev() ;
 	void setNext() ;
-	void setVisualAuto();
 	void setNumLine(QString);
 	void setTotalNumLine(QString);
-	void setFeedRateToLine(QList<double>);
-	void setSpeedSpindleToLine(QList<double>);
+	void setModalTimeline(ModalTimeline);
 	void runCode(bool, int) ;
-
-	void  drawItem() ;
-	float  timeItem(int nl, float f) ;
+	void seekProgress(int);
+	void setRapidRate(double);
 	///
 	void noTool() ;
 	void miniTool();
@@ -87,9 +123,12 @@ public Q_SLOTS:
 	void sharpTool();
 	void shortTool();
 
-	void setPeriod(int);
+	void setSpeed(int);
 	void setTolerance(double);
 
+private Q_SLOTS:
+	void simFrame();
+
 private:
 
 /// fonctions
@@ -98,14 +137,25 @@ private:
 	void gcreateScene(int=0);
 	void gcreateTool() ;
 	void gcreateBbox() ;
+	void gcreateReference() ;
+	void gcreateStock() ;
 	// objets draw
 	void Scene(int nlColor=0);
+	void drawStore();
 	/// bounding box
 	void drawDimBbox();
+	void setBoundingBox();
 	void MinMax(QVector3D);
+	/// repaint
+	void schedule();
 
-	QVector3D getLastPoint(int) ;
-	void getPoints(int nl) ;
+	/// animator
+	void seekLine(int nl);
+	void playTo(double tend, int factor);
+	void stopClock();
+	void showTime(bool force=false);
+	void showLine(int nl);
+	static QString clockText(double sec);
 
 /// attributs
 	QWidget * parent;
@@ -114,44 +164,65 @@ private:
     double tol;
     bool mm;
     uint8_t plane;
-	bool itemrec, withtool, withbbox, withg0, created, first;
+	bool itemrec, withtool, withbbox, withg0, withreference, withstock, created, first;
 
     // scene size max
     uint16_t vmax ;
     // vectors
     QVector3D  vecBanned, phome;
-    QVector3D pmax, pmin, pcurr, pprev, ptemp, pp;
+    QVector3D pmax, pmin, pcurr, pprev;
 	qglviewer::Vec pvmax, pvmin, pvcenter;
 	Tools3D Tool;
 	// positions
 	PosItem livePoint;
     QList<PosItem> items;
+	// path before 'PathOptimizer', drawn under the items to compare
+	QList<PosItem> referenceItems;
+	// heightmap of 'StockSimulator'
+	StockMap stockMap;
+	// segments of the items for picking, from 'MainWindow'
+	const SegmentIndex *segmentIndex;
+	// pages of an out of core program, drawn each frame in place of the scene
+	QSharedPointer<ToolpathStore> store;
+	int pageBudget;
+	// line in red of the scene
+	int sceneLine;
+	// display lists asked since the last frame, rebuilt by 'draw()'
+	int pendingLine;
+	bool toolDirty;
+	FrameScheduler *scheduler;
+	// text of 'drawDimBbox()', set with the bounding box
+	QString dimText[2];
 
 	int linecodeText, linecodeTextmax;
 
     // paths
-    QList<QVector3D> pathItem, pointsItem;
-    QList<QVector3D> pathDrawing;
-    QList<int>	pointToLine;
-    QList<double> feedRateToLine;
-    QList<double> speedSpindleToLine;
-    QMap<int, int> segToLineValid;
-    QMap<int, float> feedRateByLineValid;
-    QMap<int, float> speedSpindleByLineValid;
-
-	/// line -> pathDrawing
-	int posPath ;
+    QList<QVector3D> pathItem;
+    // interpolated points with their machining time, built again by
+    // 'Scene()' only for a new program, tolerance or rapid rate
+    MotionTimeline timeline;
+    bool timelineDirty;
+    // mm per mn, from 'MainWindow::setRapidRates()'
+    double rapidrate;
+    // modal values by line, from 'MainWindow::preProcessFile()'
+    ModalTimeline modal;
+    // only motion lines have segments
+    QHash<int, int> segToLineValid;
+
 	// motor steps
 	QList<QVector3D> stepsItem;
 	QList<QVector3D> stepsComplete;
 
 	QColor color;
 
-	// animator
-	bool visu, pause, runcode, firstauto;
-	int npoint, npointmax, np, npmax,nfirstpoint, nlastpoint ;
-	QTimer * repeatVisu;
-	QTimer * repeatPoint;
+	// animator : simulated time 'simtime' seconds runs 'simfactor' times
+	// faster than 'clock' from 'simorigin' up to 'simend', 'speed' of the dial
+	bool visu, pause, runcode;
+	double simtime, simorigin, simend;
+	int speed, simfactor;
+	QElapsedTimer clock, lineclock;
+	QTimer * frameTimer;
+	int lastprogress;
     // from PosItem
 	float feedrate, prevfeedrate ;  // mm per mn
 	float speedspindle, prevspeedspindle; 	// turn per minute